@@ -24,17 +24,93 @@
 #include <stdio.h>
 #include "SpikeDetector.h"
 
+#if JUCE_INTEL
+#  include <xmmintrin.h>
+#  define SPIKEDETECTOR_USE_SSE 1
+#endif
+
+
+namespace
+{
+    /** Index of the first sample in [start, end) below level, or end if there is none */
+    int findFirstBelow (const float* data, int start, int end, float level)
+    {
+        int i = start;
+
+#if SPIKEDETECTOR_USE_SSE
+        // skip 16 samples at a time while none of them is below, which is most of the time
+        const __m128 l = _mm_set1_ps (level);
+
+        for (; i + 16 <= end; i += 16)
+        {
+            const __m128 below = _mm_or_ps (_mm_or_ps (_mm_cmplt_ps (_mm_loadu_ps (data + i), l),
+                                                       _mm_cmplt_ps (_mm_loadu_ps (data + i + 4), l)),
+                                            _mm_or_ps (_mm_cmplt_ps (_mm_loadu_ps (data + i + 8), l),
+                                                       _mm_cmplt_ps (_mm_loadu_ps (data + i + 12), l)));
+            if (_mm_movemask_ps (below) != 0)
+                break;
+        }
+#endif
+
+        for (; i < end; ++i)
+        {
+            if (data[i] < level)
+                return i;
+        }
+
+        return end;
+    }
+
+    /** The level a sample x is compared to, so that x < level exactly when -x > threshold */
+    float getCrossingLevel (double threshold)
+    {
+        float level = float (-threshold);
+
+        if (double (level) < -threshold)
+            level = std::nextafter (level, std::numeric_limits<float>::infinity());
+
+        return level;
+    }
+
+    /** Samples of each block used for the noise estimate */
+    const int noiseWindowSize = 64;
+
+    /** Time constant of the smoothing of the noise estimates, in seconds */
+    const double noiseTimeConstant = 2.0;
+
+    /** median(|x|) / 0.6745 of up to noiseWindowSize samples spread over the block. This estimates
+        the standard deviation of the noise, and spikes barely change it */
+    float estimateNoise (const float* data, int numSamples)
+    {
+        float window[noiseWindowSize];
+        const int step = jmax (1, numSamples / noiseWindowSize);
+
+        int n = 0;
+        for (int i = 0; i < numSamples && n < noiseWindowSize; i += step)
+            window[n++] = std::abs (data[i]);
+
+        std::nth_element (window, window + n / 2, window + n);
+
+        return window[n / 2] / 0.6745f;
+    }
+}
+
 
 SpikeDetector::SpikeDetector()
     : GenericProcessor      ("Spike Detector")
     , overflowBuffer        (2, 100)
-    , dataBuffer            (nullptr),
-      overflowBufferSize    (100)
+    , overflowBufferSize    (100)
+    , adaptiveThresholds    (false)
+    , noiseMultiplier       (4.0f)
     , currentElectrode      (-1)
     , uniqueID              (0)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
+    // the ranges count electrodes, which are scanned independently. With up to four channels
+    // each, four electrodes are about as much work as the default range of 16 channels
+    setChannelParallelProcessing (true, 4);
+
     //// the standard form:
     electrodeTypes.add ("single electrode");
     electrodeTypes.add ("stereotrode");
@@ -164,6 +240,8 @@ bool SpikeDetector::addElectrode (int nChans, int electrodeID)
     newElectrode->thresholds.malloc (nChans);
     newElectrode->isActive.malloc (nChans);
     newElectrode->channels.malloc (nChans);
+    newElectrode->nextCrossing.malloc (nChans);
+    newElectrode->noiseLevels.malloc (nChans);
     newElectrode->isMonitored = false;
 
     for (int i = 0; i < nChans; ++i)
@@ -215,6 +293,9 @@ StringArray SpikeDetector::getElectrodeNames() const
 void SpikeDetector::resetElectrode (SimpleElectrode* e)
 {
     e->lastBufferIndex = 0;
+
+    for (int i = 0; i < e->numChannels; ++i)
+        *(e->noiseLevels + i) = -1.0f;
 }
 
 
@@ -321,6 +402,41 @@ double SpikeDetector::getChannelThreshold(int electrodeNum, int channelNum) cons
 }
 
 
+void SpikeDetector::setAdaptiveThresholds (bool enabled)
+{
+    adaptiveThresholds = enabled;
+}
+
+
+bool SpikeDetector::hasAdaptiveThresholds() const
+{
+    return adaptiveThresholds;
+}
+
+
+void SpikeDetector::setNoiseMultiplier (float multiplier)
+{
+    noiseMultiplier = multiplier;
+}
+
+
+float SpikeDetector::getNoiseMultiplier() const
+{
+    return noiseMultiplier;
+}
+
+
+double SpikeDetector::getDetectionThreshold (const SimpleElectrode* electrode, int channelNum) const
+{
+    const float noiseLevel = *(electrode->noiseLevels + channelNum);
+
+    if (adaptiveThresholds && noiseLevel >= 0)
+        return noiseMultiplier * noiseLevel;
+
+    return *(electrode->thresholds + channelNum);
+}
+
+
 void SpikeDetector::setParameter (int parameterIndex, float newValue)
 {
     //editor->updateParameterButtons(parameterIndex);
@@ -363,204 +479,215 @@ bool SpikeDetector::disable()
 }
 
 
-void SpikeDetector::addWaveformToSpikeObject (SpikeEvent::SpikeBuffer& s,
-                                              int& peakIndex,
-                                              int& electrodeNumber,
-                                              int& currentChannel)
+void SpikeDetector::process (AudioSampleBuffer& buffer)
 {
-    int spikeLength = electrodes[electrodeNumber]->prePeakSamples
-                      + electrodes[electrodeNumber]->postPeakSamples;
+    prepareScanBuffer (buffer);
+
+    while (spikeStagings.size() < electrodes.size())
+        spikeStagings.add (new SpikeStaging());
 
+    processChannelsInParallel (buffer, electrodes.size());
 
-    const int chan = *(electrodes[electrodeNumber]->channels + currentChannel);
+    addStagedSpikes (spikeStagings);
 
-    if (isChannelActive (electrodeNumber, currentChannel))
+    for (int i = 0; i < electrodes.size(); ++i)
     {
-		
-        for (int sample = 0; sample < spikeLength; ++sample)
+        SimpleElectrode* electrode = electrodes[i];
+        const int nSamples = getNumSamples (*electrode->channels);
+
+        if (nSamples > overflowBufferSize)
         {
-            s.set(currentChannel,sample, getNextSample (*(electrodes[electrodeNumber]->channels+currentChannel)));
-            ++sampleIndex;
+            for (int j = 0; j < electrode->numChannels; ++j)
+            {
+                overflowBuffer.copyFrom (*electrode->channels+j,
+                                         0,
+                                         buffer,
+                                         *electrode->channels + j,
+                                         nSamples-overflowBufferSize,
+                                         overflowBufferSize);
+            }
 
-            //std::cout << currentIndex << std::endl;
+            useOverflowBuffer.set (i, true);
         }
-    }
-    else
-    {
-        for (int sample = 0; sample < spikeLength; ++sample)
+        else
         {
-            // insert a blank spike if the
-			s.set(currentChannel, sample, 0);
-            ++sampleIndex;
-            //std::cout << currentIndex << std::endl;
+            useOverflowBuffer.set (i, false);
         }
     }
+}
 
-    sampleIndex -= spikeLength; // reset sample index
+
+void SpikeDetector::processChannelRange (AudioSampleBuffer& buffer, int startElectrode, int numElectrodes)
+{
+    for (int i = startElectrode; i < startElectrode + numElectrodes; ++i)
+        detectSpikes (i);
 }
 
 
-void SpikeDetector::process (AudioSampleBuffer& buffer)
+void SpikeDetector::prepareScanBuffer (const AudioSampleBuffer& buffer)
 {
-    // cycle through electrodes
-    SimpleElectrode* electrode;
-    dataBuffer = &buffer;
+    // a spike found near the end of the scanned range can reach past the block, where there are zeros
+    int padding = 0;
+
+    for (int i = 0; i < electrodes.size(); ++i)
+        padding = jmax (padding, electrodes[i]->prePeakSamples + 2 * electrodes[i]->postPeakSamples);
 
-    //std::cout << dataBuffer.getMagnitude(0,nSamples) << std::endl;
+    const int length = overflowBufferSize + buffer.getNumSamples() + padding;
+
+    if (scanBuffer.getNumChannels() < buffer.getNumChannels() || scanBuffer.getNumSamples() < length)
+        scanBuffer.setSize (buffer.getNumChannels(), length, false, false, true);
 
     for (int i = 0; i < electrodes.size(); ++i)
     {
-        //  std::cout << "ELECTRODE " << i << std::endl;
+        const SimpleElectrode* electrode = electrodes[i];
 
-        electrode = electrodes[i];
+        for (int j = 0; j < electrode->numChannels; ++j)
+        {
+            const int chan = *(electrode->channels + j);
+            const int nSamples = getNumSamples (chan);
 
-        // refresh buffer index for this electrode
-        sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
-        // increment at start of getNextSample()
+            scanBuffer.copyFrom (chan, 0, overflowBuffer, chan, 0, overflowBufferSize);
+            scanBuffer.copyFrom (chan, overflowBufferSize, buffer, chan, 0, nSamples);
+            scanBuffer.clear (chan, overflowBufferSize + nSamples, scanBuffer.getNumSamples() - overflowBufferSize - nSamples);
+        }
+    }
+}
 
-        const int nSamples = getNumSamples (*electrode->channels);
 
-        // cycle through samples
-        while (samplesAvailable (nSamples))
-        {
-            ++sampleIndex;
+const float* SpikeDetector::getScanPointer (int chan) const
+{
+    return scanBuffer.getReadPointer (chan, overflowBufferSize);
+}
 
-            // cycle through channels
-            for (int chan = 0; chan < electrode->numChannels; ++chan)
-            {
-                // std::cout << "  channel " << chan << std::endl;
-                if (*(electrode->isActive + chan))
-                {
-                    int currentChannel = *(electrode->channels + chan);
 
-                    if (-getNextSample (currentChannel) > *(electrode->thresholds + chan)) // trigger spike
-                    {
-                        //std::cout << "Spike detected on electrode " << i << std::endl;
-                        // find the peak
-                        int peakIndex = sampleIndex;
-
-                        while (-getCurrentSample(currentChannel) < -getNextSample(currentChannel)
-                               && sampleIndex < peakIndex + electrode->postPeakSamples)
-                        {
-                            ++sampleIndex;
-                        }
-
-                        peakIndex = sampleIndex;
-                        sampleIndex -= (electrode->prePeakSamples + 1);
-
-						const SpikeChannel* spikeChan = getSpikeChannel(i);
-						SpikeEvent::SpikeBuffer spikeData(spikeChan);
-						Array<float> thresholds;
-						for (int channel = 0; channel < electrode->numChannels; ++channel)
-						{
-							addWaveformToSpikeObject(spikeData,
-								peakIndex,
-								i,
-								channel);
-							thresholds.add((int)*(electrode->thresholds + channel));
-						}
-						int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
-						SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, timestamp, thresholds, spikeData, 0);
-
-                        // package spikes;
-                        
-						addSpike(spikeChan, newSpike, peakIndex);
-
-
-                        // advance the sample index
-                        sampleIndex = peakIndex + electrode->postPeakSamples;
-
-                        // quit spike "for" loop
-                        break;
-
-                    // end spike trigger
-                    }
+void SpikeDetector::detectSpikes (int electrodeIndex)
+{
+    SimpleElectrode* electrode = electrodes[electrodeIndex];
 
-                // end if channel is active
-                }
+    const int nSamples = getNumSamples (*electrode->channels);
+    const int spikeLength = electrode->prePeakSamples + electrode->postPeakSamples;
 
-            // end cycle through channels on electrode
-            }
+    // the samples too close to the end of the block are tested in the next one
+    const int lastSample = nSamples - overflowBufferSize / 2 + 1;
 
-        // end cycle through samples
-        }
+    // index of the last sample tested. The first waveforms reach back into the overflow tail
+    int sampleIndex = jmax (electrode->lastBufferIndex, electrode->prePeakSamples + 2 - overflowBufferSize) - 1;
 
-        electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
+    if (adaptiveThresholds)
+        updateNoiseLevels (electrode, nSamples);
 
-        if (nSamples > overflowBufferSize)
+    for (int chan = 0; chan < electrode->numChannels; ++chan)
+        *(electrode->nextCrossing + chan) = sampleIndex;
+
+    while (sampleIndex < lastSample)
+    {
+        // the channels are only scanned again past the crossings found before
+        int crossing = lastSample + 1;
+        int triggerChannel = -1;
+
+        for (int chan = 0; chan < electrode->numChannels; ++chan)
         {
-            for (int j = 0; j < electrode->numChannels; ++j)
+            if (! *(electrode->isActive + chan))
+                continue;
+
+            int& next = *(electrode->nextCrossing + chan);
+
+            if (next <= sampleIndex)
+                next = findFirstBelow (getScanPointer (*(electrode->channels + chan)),
+                                       sampleIndex + 1,
+                                       lastSample + 1,
+                                       getCrossingLevel (getDetectionThreshold (electrode, chan)));
+
+            // on a tie, the first channel triggers
+            if (next < crossing)
             {
-                overflowBuffer.copyFrom (*electrode->channels+j,
-                                         0,
-                                         buffer,
-                                         *electrode->channels + j,
-                                         nSamples-overflowBufferSize,
-                                         overflowBufferSize);
+                crossing = next;
+                triggerChannel = chan;
             }
+        }
 
-            useOverflowBuffer.set (i, true);
+        if (triggerChannel < 0)
+        {
+            sampleIndex = lastSample;
+            break;
         }
-        else
+
+        // the peak is the last sample before the signal rises again, and peakIndex the one after it
+        const float* data = getScanPointer (*(electrode->channels + triggerChannel));
+        sampleIndex = crossing;
+
+        while (data[sampleIndex] < data[sampleIndex - 1]
+               && sampleIndex < crossing + electrode->postPeakSamples)
         {
-            useOverflowBuffer.set (i, false);
+            ++sampleIndex;
         }
 
-    // end cycle through electrodes
-    }
-}
+        const int peakIndex = sampleIndex;
+        const int waveformStart = peakIndex - electrode->prePeakSamples - 1;
 
+        const SpikeChannel* spikeChan = getSpikeChannel (electrodeIndex);
+        SpikeEvent::SpikeBuffer spikeData (spikeChan);
+        Array<float> thresholds;
 
-float SpikeDetector::getNextSample (int& chan)
-{
-    if (sampleIndex < 0)
-    {
-        const int ind = overflowBufferSize + sampleIndex;
+        for (int channel = 0; channel < electrode->numChannels; ++channel)
+        {
+            if (*(electrode->isActive + channel))
+            {
+                spikeData.set (channel, getScanPointer (*(electrode->channels + channel)) + waveformStart, spikeLength);
+            }
+            else
+            {
+                // insert a blank spike
+                for (int sample = 0; sample < spikeLength; ++sample)
+                    spikeData.set (channel, sample, 0);
+            }
 
-        if (ind < overflowBuffer.getNumSamples())
-            return *overflowBuffer.getWritePointer (chan, ind);
-        else
-            return 0;
+            thresholds.add ((int) getDetectionThreshold (electrode, channel));
+        }
 
-    }
-    else
-    {
-        if (sampleIndex < getNumSamples(chan))
-            return *dataBuffer->getWritePointer (chan, sampleIndex);
-        else
-            return 0;
-    }
-}
+        int64 timestamp = getTimestamp (electrode->channels[0]) + peakIndex;
+        SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent (spikeChan, timestamp, thresholds, spikeData, 0);
 
+        spikeStagings[electrodeIndex]->add (spikeChan, newSpike.release(), peakIndex);
 
-float SpikeDetector::getCurrentSample (int& chan)
-{
-    if (sampleIndex < 1)
-    {
-        return *overflowBuffer.getWritePointer (chan, overflowBufferSize + sampleIndex - 1);
-    }
-    else
-    {
-        return *dataBuffer->getWritePointer (chan, sampleIndex - 1);
+        // skip the rest of the spike
+        sampleIndex = peakIndex + electrode->postPeakSamples;
     }
+
+    electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
 }
 
 
-bool SpikeDetector::samplesAvailable (int nSamples)
+void SpikeDetector::updateNoiseLevels (SimpleElectrode* electrode, int nSamples)
 {
-    if (sampleIndex > nSamples - overflowBufferSize/2)
-    {
-        return false;
-    }
-    else
+    if (nSamples <= 0)
+        return;
+
+    const double blockDuration = nSamples / getDataChannel (*electrode->channels)->getSampleRate();
+    const float smoothing = float (1.0 - std::exp (-blockDuration / noiseTimeConstant));
+
+    for (int chan = 0; chan < electrode->numChannels; ++chan)
     {
-        return true;
+        if (! *(electrode->isActive + chan))
+            continue;
+
+        const float estimate = estimateNoise (getScanPointer (*(electrode->channels + chan)), nSamples);
+        float& noiseLevel = *(electrode->noiseLevels + chan);
+
+        if (noiseLevel < 0)
+            noiseLevel = estimate;
+        else
+            noiseLevel += smoothing * (estimate - noiseLevel);
     }
 }
 
 
 void SpikeDetector::saveCustomParametersToXml (XmlElement* parentElement)
 {
+    XmlElement* thresholdNode = parentElement->createNewChildElement ("THRESHOLDS");
+    thresholdNode->setAttribute ("adaptive",         adaptiveThresholds);
+    thresholdNode->setAttribute ("noiseMultiplier",  noiseMultiplier);
+
     for (int i = 0; i < electrodes.size(); ++i)
     {
         XmlElement* electrodeNode = parentElement->createNewChildElement ("ELECTRODE");
@@ -593,7 +720,12 @@ void SpikeDetector::loadCustomParametersFromXml()
 
         forEachXmlChildElement (*parametersAsXml, xmlNode)
         {
-            if (xmlNode->hasTagName ("ELECTRODE"))
+            if (xmlNode->hasTagName ("THRESHOLDS"))
+            {
+                setAdaptiveThresholds (xmlNode->getBoolAttribute ("adaptive", false));
+                setNoiseMultiplier ((float) xmlNode->getDoubleAttribute ("noiseMultiplier", 4.0));
+            }
+            else if (xmlNode->hasTagName ("ELECTRODE"))
             {
                 ++electrodeIndex;
 
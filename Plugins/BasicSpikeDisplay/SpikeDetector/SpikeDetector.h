@@ -44,12 +44,28 @@ struct SimpleElectrode
     HeapBlock<int> channels;
     HeapBlock<double> thresholds;
     HeapBlock<bool> isActive;
+
+    /** First threshold crossing of each channel at or after the last scanned sample, used during detection */
+    HeapBlock<int> nextCrossing;
+
+    /** Running noise estimate of each channel for adaptive thresholds, negative until the first block */
+    HeapBlock<float> noiseLevels;
 };
 
 
 /**
     Detects spikes in a continuous signal and outputs events containing the spike data.
 
+    Each block, the channels of the electrodes are copied after the tail of the previous
+    block into a contiguous scan buffer. The channels are then scanned for threshold
+    crossings several samples at a time, and peaks and waveforms are only read around
+    the crossings.
+
+    With adaptive thresholds, the threshold of each channel is a multiple of its noise
+    level instead of the value set for it. The noise level is median(|x|) / 0.6745 of a
+    few samples spread over each block, smoothed over the blocks, so it follows slow
+    changes of the noise without keeping any history.
+
     @see GenericProcessor, SpikeDetectorEditor
 */
 class SpikeDetector : public GenericProcessor
@@ -61,6 +77,9 @@ public:
     /** Processes an incoming continuous buffer and places new spikes into the event buffer. */
     void process (AudioSampleBuffer& buffer) override;
 
+    /** Detects the spikes of a range of electrodes, called from process() on the channel processing threads */
+    void processChannelRange (AudioSampleBuffer& buffer, int startElectrode, int numElectrodes) override;
+
     /** Used to alter parameters of data acquisition. */
     void setParameter (int parameterIndex, float newValue) override;
 
@@ -143,27 +162,47 @@ public:
 
     double getChannelThreshold (int electrodeNum, int channelNum) const;
 
+    /** When enabled, the threshold of each channel is the noise multiplier times its
+        noise level, and the thresholds set per channel are not used. */
+    void setAdaptiveThresholds (bool enabled);
+    bool hasAdaptiveThresholds() const;
+
+    void setNoiseMultiplier (float multiplier);
+    float getNoiseMultiplier() const;
+
 
 private:
 
     float getDefaultThreshold() const;
 
-    float getNextSample (int& chan);
-    float getCurrentSample (int& chan);
-    bool samplesAvailable (int nSamples);
+    /** Copies the overflow tail, the block and zero padding of the electrode channels to scanBuffer */
+    void prepareScanBuffer (const AudioSampleBuffer& buffer);
+
+    /** Sample 0 of the current block of a channel in scanBuffer. Indexes down to
+        -overflowBufferSize are the end of the previous block */
+    const float* getScanPointer (int chan) const;
+
+    /** Finds the spikes of an electrode in the current block and stages them in spikeStagings */
+    void detectSpikes (int electrodeIndex);
 
-      void addWaveformToSpikeObject (SpikeEvent::SpikeBuffer& s,
-                                   int& peakIndex,
-                                   int& electrodeNumber,
-                                   int& currentChannel);
+    /** Updates the noise levels of an electrode from the current block */
+    void updateNoiseLevels (SimpleElectrode* electrode, int nSamples);
+
+    /** The threshold detection uses for a channel, which depends on the threshold mode */
+    double getDetectionThreshold (const SimpleElectrode* electrode, int channelNum) const;
 
     void resetElectrode (SimpleElectrode*);
 
-    /** Pointer to a continuous buffer. */
-    AudioSampleBuffer* dataBuffer;
+    /** Each channel as one array of overflowBufferSize + block + padding samples */
+    AudioSampleBuffer scanBuffer;
+
+    /** The spikes of each electrode in the current block, merged into the event buffer by process() */
+    OwnedArray<SpikeStaging> spikeStagings;
 
     int overflowBufferSize;
-    int sampleIndex;
+
+    bool adaptiveThresholds;
+    float noiseMultiplier;
 
     Array<int> electrodeCounter;
 
@@ -37,7 +37,7 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     Typeface::Ptr typeface = new CustomTypeface(mis);
     font = Font(typeface);
 
-    desiredWidth = 300;
+    desiredWidth = 340;
 
     electrodeTypes = new ComboBox("Electrode Types");
 
@@ -119,6 +119,28 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     thresholdLabel->setColour(Label::textColourId, Colours::grey);
     addAndMakeVisible(thresholdLabel);
 
+    adaptiveThresholdButton = new UtilityButton("AUTO", Font("Default", 10, Font::plain));
+    adaptiveThresholdButton->addListener(this);
+    adaptiveThresholdButton->setBounds(285,40,45,18);
+    adaptiveThresholdButton->setClickingTogglesState(true);
+    adaptiveThresholdButton->setTooltip("When this button is on, the threshold of each channel follows its noise level");
+    addAndMakeVisible(adaptiveThresholdButton);
+
+    noiseMultiplierLabel = new Label("Noise multiplier label", "x noise");
+    noiseMultiplierLabel->setFont(font);
+    noiseMultiplierLabel->setBounds(282, 62, 55, 15);
+    noiseMultiplierLabel->setColour(Label::textColourId, Colours::grey);
+    addAndMakeVisible(noiseMultiplierLabel);
+
+    noiseMultiplierValue = new Label("Noise multiplier", String(processor->getNoiseMultiplier()));
+    noiseMultiplierValue->setEditable(true);
+    noiseMultiplierValue->addListener(this);
+    noiseMultiplierValue->setBounds(285,78,45,18);
+    noiseMultiplierValue->setColour(Label::textColourId, Colours::white);
+    noiseMultiplierValue->setColour(Label::backgroundColourId, Colours::grey);
+    noiseMultiplierValue->setTooltip("Adaptive threshold, as a multiple of the noise standard deviation");
+    addAndMakeVisible(noiseMultiplierValue);
+
     // create a custom channel selector
     //deleteAndZero(channelSelector);
 
@@ -218,7 +240,14 @@ void SpikeDetectorEditor::buttonEvent(Button* button)
 
     int num = numElectrodes->getText().getIntValue();
 
-    if (button == upButton)
+    if (button == adaptiveThresholdButton)
+    {
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+        processor->setAdaptiveThresholds(button->getToggleState());
+
+        return;
+    }
+    else if (button == upButton)
     {
         numElectrodes->setText(String(++num), sendNotification);
 
@@ -471,6 +500,20 @@ void SpikeDetectorEditor::removeElectrode(int index)
 
 void SpikeDetectorEditor::labelTextChanged(Label* label)
 {
+    if (label == noiseMultiplierValue)
+    {
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+        float multiplier = label->getText().getFloatValue();
+
+        if (multiplier > 0)
+            processor->setNoiseMultiplier(multiplier);
+        else
+            CoreServices::sendStatusMessage("Value out of range.");
+
+        label->setText(String(processor->getNoiseMultiplier()), dontSendNotification);
+        return;
+    }
+
     if (label->getText().equalsIgnoreCase("1") && isPlural)
     {
         for (int n = 1; n < electrodeTypes->getNumItems()+1; n++)
@@ -543,6 +586,10 @@ void SpikeDetectorEditor::comboBoxChanged(ComboBox* comboBox)
 
 void SpikeDetectorEditor::checkSettings()
 {
+    SpikeDetector* processor = (SpikeDetector*) getProcessor();
+    adaptiveThresholdButton->setToggleState(processor->hasAdaptiveThresholds(), dontSendNotification);
+    noiseMultiplierValue->setText(String(processor->getNoiseMultiplier()), dontSendNotification);
+
     electrodeList->setSelectedId(0);
     drawElectrodeButtons(0);
 
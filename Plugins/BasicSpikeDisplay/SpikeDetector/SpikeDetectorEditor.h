@@ -39,7 +39,9 @@ class UtilityButton;
   Allows the user to add single electrodes, stereotrodes, or tetrodes.
 
   Parameters of individual channels, such as channel mapping, threshold,
-  and enabled state, can be edited.
+  and enabled state, can be edited. The AUTO button switches to thresholds
+  that follow the noise of each channel, at the multiple of the noise
+  level set below it.
 
   @see SpikeDetector
 
@@ -80,6 +82,10 @@ private:
 
     ThresholdSlider* thresholdSlider;
 
+    UtilityButton* adaptiveThresholdButton;
+    Label* noiseMultiplierLabel;
+    Label* noiseMultiplierValue;
+
     OwnedArray<ElectrodeButton> electrodeButtons;
     Array<ElectrodeEditorButton*> electrodeEditorButtons;
 
@@ -51,6 +51,7 @@ public:
     IEcubeDigitalInputStreamingPtr pStrmD;
     HeapBlock<float, true> interleaving_buffer;
     HeapBlock<uint64_t, true> event_buffer;
+    HeapBlock<int64, true> timestamp_buffer;
     HeapBlock<uint32_t, true> bit_conversion_tables;
     bool buf_timestamp_locked;
     unsigned long buf_timestamp;
@@ -230,6 +231,9 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                 sourceBuffers.set(0,new DataBuffer(pDevInt->n_channel_objects, 10000));
                 // Create the interleaving buffer based on the number of channels
                 pDevInt->interleaving_buffer.malloc(sizeof(float)* 1500 * pDevInt->n_channel_objects);
+                // Per-sample timestamps and (empty) event words, so whole packets can be sent at once
+                pDevInt->timestamp_buffer.malloc(1500);
+                pDevInt->event_buffer.calloc(1500);
             }
             else if (selmod == "Panel Analog Input")
             {
@@ -259,6 +263,9 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                 sourceBuffers.set(0,new DataBuffer(32, 10000));
                 // The interleaving buffer is there just for short->float conversion
                 pDevInt->interleaving_buffer.malloc(sizeof(float)* 1500);
+                // Per-sample timestamps and (empty) event words, so whole packets can be sent at once
+                pDevInt->timestamp_buffer.malloc(1500);
+                pDevInt->event_buffer.calloc(1500);
             }
             else if (selmod == "Panel Digital Input")
             {
@@ -288,6 +295,7 @@ EcubeThread::EcubeThread(SourceNode* sn) : DataThread(sn), numberingScheme(1), a
                 pDevInt->interleaving_buffer.malloc(sizeof(float)* 1500 * 64);
                 // Create the analog of interleaving buffer in packed format (int64)
                 pDevInt->event_buffer.malloc(sizeof(uint64_t)* 1500);
+                pDevInt->timestamp_buffer.malloc(1500);
                 pDevInt->bit_conversion_tables.malloc(sizeof(uint32_t)* 0x600);
                 build_bit_conversion_tables(pDevInt->bit_conversion_tables);
             }
@@ -477,9 +485,10 @@ bool EcubeThread::updateBuffer()
                             int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube 80MHz timestamp into a 25kHz timestamp
                             for (unsigned long j = 0; j < pDevInt->int_buf_size; j++)
                             {
-								sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j*nchan, &cts, &ttlEventWords.getReference(0), 1);
+                                pDevInt->timestamp_buffer[j] = cts;
                                 cts++;
                             }
+                            sourceBuffers[0]->addInterleavedBlock(pDevInt->interleaving_buffer, pDevInt->timestamp_buffer, pDevInt->event_buffer, pDevInt->int_buf_size);
                             // Update the 64-bit timestamp, take account of its wrap-around
                             unsigned tsdif = bts - pDevInt->buf_timestamp;
                             pDevInt->buf_timestamp64 += tsdif;
@@ -527,9 +536,10 @@ bool EcubeThread::updateBuffer()
                     int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube's 80MHz timestamps into number of samples on the Panel Analog input (orig sample rate 1144)
                     for (unsigned long j = 0; j < datasam; j++)
                     {
-						sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j * 32, &cts, &ttlEventWords.getReference(0), 1);
+                        pDevInt->timestamp_buffer[j] = cts;
                         cts++;
                     }
+                    sourceBuffers[0]->addInterleavedBlock(pDevInt->interleaving_buffer, pDevInt->timestamp_buffer, pDevInt->event_buffer, datasam);
                 }
                 else // Digital data
                 {
@@ -545,9 +555,10 @@ bool EcubeThread::updateBuffer()
                             int64 cts = pDevInt->buf_timestamp64 / pDevInt->sampletime_80mhz; // Convert eCube 80MHz timestamp into a 25kHz timestamp
                             for (unsigned long j = 0; j < pDevInt->int_buf_size; j++)
                             {
-                                sourceBuffers[0]->addToBuffer(pDevInt->interleaving_buffer + j*64, &cts, pDevInt->event_buffer+j, 1);
+                                pDevInt->timestamp_buffer[j] = cts;
                                 cts++;
                             }
+                            sourceBuffers[0]->addInterleavedBlock(pDevInt->interleaving_buffer, pDevInt->timestamp_buffer, pDevInt->event_buffer, pDevInt->int_buf_size);
                             // Update the 64-bit timestamp, take account of its wrap-around
                             pDevInt->buf_timestamp64 += tsdif;
                         }
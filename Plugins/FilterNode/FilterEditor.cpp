@@ -82,6 +82,14 @@ FilterEditor::FilterEditor(GenericProcessor* parentNode, bool useDefaultParamete
     applyFilterOnChan->setTooltip("When this button is off, selected channels will not be filtered");
     addAndMakeVisible(applyFilterOnChan);
 
+    groupedFilteringButton = new UtilityButton("SIMD",Font("Default", 10, Font::plain));
+    groupedFilteringButton->addListener(this);
+    groupedFilteringButton->setBounds(90,45,40,18);
+    groupedFilteringButton->setClickingTogglesState(true);
+    groupedFilteringButton->setToggleState(true, dontSendNotification);
+    groupedFilteringButton->setTooltip("When this button is on, channels with the same settings are filtered several at a time");
+    addAndMakeVisible(groupedFilteringButton);
+
 }
 
 FilterEditor::~FilterEditor()
@@ -186,6 +194,11 @@ void FilterEditor::buttonEvent(Button* button)
         fn->setApplyOnADC(applyFilterOnADC->getToggleState());
 
     }
+    else if (button == groupedFilteringButton)
+    {
+        FilterNode* fn = (FilterNode*) getProcessor();
+        fn->setGroupedFiltering(groupedFilteringButton->getToggleState());
+    }
     else if (button == applyFilterOnChan)
     {
         FilterNode* fn = (FilterNode*) getProcessor();
@@ -215,6 +228,7 @@ void FilterEditor::saveCustomParameters(XmlElement* xml)
     textLabelValues->setAttribute("HighCut",lastHighCutString);
     textLabelValues->setAttribute("LowCut",lastLowCutString);
     textLabelValues->setAttribute("ApplyToADC",	applyFilterOnADC->getToggleState());
+    textLabelValues->setAttribute("GroupedFiltering", groupedFilteringButton->getToggleState());
 }
 
 void FilterEditor::loadCustomParameters(XmlElement* xml)
@@ -229,6 +243,7 @@ void FilterEditor::loadCustomParameters(XmlElement* xml)
             resetToSavedText();
 
             applyFilterOnADC->setToggleState(xmlNode->getBoolAttribute("ApplyToADC",false), sendNotification);
+            groupedFilteringButton->setToggleState(xmlNode->getBoolAttribute("GroupedFiltering",true), sendNotification);
         }
     }
 
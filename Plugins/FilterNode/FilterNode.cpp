@@ -27,11 +27,18 @@
 
 FilterNode::FilterNode()
     : GenericProcessor  ("Bandpass Filter")
+    , pendingSetup      (nullptr)
+    , retiredSetup      (nullptr)
+    , acquisitionActive (false)
+    , groupedFiltering  (true)
     , defaultLowCut     (300.0f)
     , defaultHighCut    (6000.0f)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
+    // every channel has its own filter, so channels can be filtered in parallel
+    setChannelParallelProcessing (true);
+
     // // Deprecated "parameters" class // //
     // Array<var> lowCutValues;
     // lowCutValues.add(1.0f);
@@ -54,6 +61,8 @@ FilterNode::FilterNode()
 
 FilterNode::~FilterNode()
 {
+    cancelPendingUpdate();
+    collectSetups (true);
 }
 
 
@@ -183,6 +192,9 @@ void FilterNode::updateSettings()
     }
 
     setApplyOnADC (applyOnADC);
+
+    cancelPendingUpdate();
+    updateFilterBanks();
 }
 
 
@@ -204,19 +216,191 @@ bool FilterNode::getBypassStatusForChannel (int chan) const
 }
 
 
-void FilterNode::setFilterParameters (double lowCut, double highCut, int chan)
+Dsp::Params FilterNode::getFilterParameters (double lowCut, double highCut, int chan) const
 {
-    if (dataChannelArray.size() - 1 < chan)
-        return;
-
     Dsp::Params params;
     params[0] = dataChannelArray[chan]->getSampleRate(); // sample rate
     params[1] = 2;                          // order
     params[2] = (highCut + lowCut) / 2;     // center frequency
     params[3] = highCut - lowCut;           // bandwidth
 
+    return params;
+}
+
+
+void FilterNode::setFilterParameters (double lowCut, double highCut, int chan)
+{
+    if (dataChannelArray.size() - 1 < chan)
+        return;
+
     if (filters.size() > chan)
-        filters[chan]->setParams (params);
+        filters[chan]->setParams (getFilterParameters (lowCut, highCut, chan));
+
+    // editors change many channels at once, so the banks are regrouped afterwards
+    triggerAsyncUpdate();
+}
+
+
+bool FilterNode::haveSameFilter (int chan1, int chan2) const
+{
+    const DataChannel* first  = dataChannelArray[chan1];
+    const DataChannel* second = dataChannelArray[chan2];
+
+    // channels of a bank must also have the same number of samples in every block
+    return lowCuts[chan1]  == lowCuts[chan2]
+        && highCuts[chan1] == highCuts[chan2]
+        && first->getSampleRate()       == second->getSampleRate()
+        && first->getSourceNodeID()     == second->getSourceNodeID()
+        && first->getSubProcessorIdx()  == second->getSubProcessorIdx();
+}
+
+
+void FilterNode::updateFilterBanks()
+{
+    FilterBankSetup* setup = new FilterBankSetup();
+    setup->grouped = groupedFiltering;
+
+    OwnedArray<FilterBank>& newBanks = setup->banks;
+    const int numChannels = jmin (filters.size(), dataChannelArray.size());
+
+    for (int n = 0; n < numChannels; ++n)
+    {
+        if (! shouldFilterChannel[n])
+            continue;
+
+        FilterBank* bank = nullptr;
+
+        for (int b = newBanks.size(); --b >= 0;)
+        {
+            if (newBanks[b]->channels.size() < FilterBank::State::numLanes
+                && haveSameFilter (n, newBanks[b]->channels.getFirst()))
+            {
+                bank = newBanks[b];
+                break;
+            }
+        }
+
+        if (bank == nullptr)
+        {
+            bank = newBanks.add (new FilterBank());
+            bank->design.setParams (getFilterParameters (lowCuts[n], highCuts[n], n));
+        }
+
+        bank->channels.add (n);
+    }
+
+    setup->channelLanes.insertMultiple (0, -1, numChannels);
+
+    for (int b = 0; b < newBanks.size(); ++b)
+    {
+        const Array<int>& channels = newBanks[b]->channels;
+        for (int l = 0; l < channels.size(); ++l)
+            setup->channelLanes.set (channels[l], b * FilterBank::State::numLanes + l);
+    }
+
+    collectSetups (true);
+
+    // during acquisition, process() swaps it in at the start of its next block
+    if (acquisitionActive)
+    {
+        pendingSetup.set (setup);
+    }
+    else
+    {
+        takeOverFilterState (*setup);
+        activeSetup = setup;
+    }
+}
+
+
+void FilterNode::takeOverFilterState (FilterBankSetup& next)
+{
+    if (activeSetup == nullptr)
+        return;
+
+    // the per-channel filters don't expose their state, so switching modes restarts the filters
+    if (next.grouped != activeSetup->grouped)
+    {
+        if (! next.grouped)
+        {
+            for (int n = 0; n < filters.size(); ++n)
+                filters[n]->reset();
+        }
+
+        return;
+    }
+
+    // carry the state of each channel over, so regrouping doesn't disturb the signal
+    double laneState[FilterBank::State::laneStateSize];
+
+    for (int b = 0; b < next.banks.size(); ++b)
+    {
+        const Array<int>& channels = next.banks[b]->channels;
+        for (int l = 0; l < channels.size(); ++l)
+        {
+            const int channel = channels[l];
+            const int previous = (channel < activeSetup->channelLanes.size()) ? activeSetup->channelLanes.getUnchecked (channel) : -1;
+            if (previous < 0)
+                continue;
+
+            activeSetup->banks[previous / FilterBank::State::numLanes]->state.getLaneState (previous % FilterBank::State::numLanes, laneState);
+            next.banks[b]->state.setLaneState (l, laneState);
+        }
+    }
+}
+
+
+void FilterNode::collectSetups (bool includingPending)
+{
+    delete retiredSetup.exchange (nullptr);
+
+    if (includingPending)
+        delete pendingSetup.exchange (nullptr);
+}
+
+
+bool FilterNode::enable()
+{
+    acquisitionActive = true;
+
+    return isEnabled;
+}
+
+
+bool FilterNode::disable()
+{
+    // process() isn't called anymore, so a setup it didn't pick up can be used directly
+    acquisitionActive = false;
+
+    FilterBankSetup* setup = pendingSetup.exchange (nullptr);
+    if (setup != nullptr)
+    {
+        takeOverFilterState (*setup);
+        activeSetup = setup;
+    }
+
+    collectSetups (false);
+
+    return true;
+}
+
+
+void FilterNode::handleAsyncUpdate()
+{
+    updateFilterBanks();
+}
+
+
+void FilterNode::setGroupedFiltering (bool enabled)
+{
+    groupedFiltering = enabled;
+    updateFilterBanks();
+}
+
+
+bool FilterNode::isGroupedFiltering() const
+{
+    return groupedFiltering;
 }
 
 
@@ -253,13 +437,56 @@ void FilterNode::setParameter (int parameterIndex, float newValue)
         {
             shouldFilterChannel.set (currentChannel, true);
         }
+
+        triggerAsyncUpdate();
     }
 }
 
 
 void FilterNode::process (AudioSampleBuffer& buffer)
 {
-    for (int n = 0; n < getNumOutputs(); ++n)
+    // a new setup is only taken once the message thread has deleted the one replaced before,
+    // so nothing is ever deleted here
+    if (retiredSetup.get() == nullptr)
+    {
+        FilterBankSetup* setup = pendingSetup.exchange (nullptr);
+        if (setup != nullptr)
+        {
+            takeOverFilterState (*setup);
+            retiredSetup.set (activeSetup.release());
+            activeSetup = setup;
+        }
+    }
+
+    if (activeSetup == nullptr)
+        return;
+
+    // in grouped mode the ranges are ranges of banks
+    processChannelsInParallel (buffer, activeSetup->grouped ? activeSetup->banks.size() : getNumOutputs());
+}
+
+
+void FilterNode::processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels)
+{
+    if (activeSetup->grouped)
+    {
+        float* channelPointers[FilterBank::State::numLanes];
+
+        for (int b = startChannel; b < startChannel + numChannels; ++b)
+        {
+            FilterBank* bank = activeSetup->banks.getUnchecked (b);
+            const Array<int>& channels = bank->channels;
+
+            for (int l = 0; l < channels.size(); ++l)
+                channelPointers[l] = buffer.getWritePointer (channels.getUnchecked (l));
+
+            bank->state.process (bank->design, getNumSamples (channels.getUnchecked (0)), channelPointers, channels.size());
+        }
+
+        return;
+    }
+
+    for (int n = startChannel; n < startChannel + numChannels; ++n)
     {
         if (shouldFilterChannel[n])
         {
@@ -32,9 +32,18 @@
 
     The user can select the low- and high-frequency cutoffs.
 
+    In grouped mode, the channels that share a source and cutoffs are filtered
+    in banks of Dsp::InterleavedCascadeState, several channels per instruction,
+    instead of one filter per channel. The output is the same, except that
+    switching modes during acquisition restarts the filters from a zero state,
+    since the two modes don't share it.
+
+    Banks regrouped during acquisition are handed to process() without locking.
+
     @see GenericProcessor, FilterEditor
 */
 class FilterNode : public GenericProcessor
+                 , private AsyncUpdater
 {
 public:
     FilterNode();
@@ -46,6 +55,9 @@ public:
 
     void process (AudioSampleBuffer& buffer) override;
 
+    /** Filters a range of channels, called from process() on the channel processing threads */
+    void processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels) override;
+
     void setParameter (int parameterIndex, float newValue) override;
 
     void updateSettings() override;
@@ -60,9 +72,50 @@ public:
 
     void setApplyOnADC (bool state);
 
+    bool enable() override;
+    bool disable() override;
+
+    void setGroupedFiltering (bool enabled);
+    bool isGroupedFiltering() const;
+
 
 private:
+    /** Up to numLanes channels with identical filters, run in the lanes of one state */
+    struct FilterBank
+    {
+        typedef Dsp::InterleavedCascadeState<2> State;
+
+        Dsp::Butterworth::Design::BandPass<2> design;
+        State state;
+        Array<int> channels;
+    };
+
+    /** The banks of all filtered channels, and the mode they are used in */
+    struct FilterBankSetup
+    {
+        OwnedArray<FilterBank> banks;
+
+        /** Bank times numLanes plus lane of each channel, -1 for the channels not filtered */
+        Array<int> channelLanes;
+
+        bool grouped;
+    };
+
     void setFilterParameters (double, double, int);
+    Dsp::Params getFilterParameters (double lowCut, double highCut, int chan) const;
+
+    bool haveSameFilter (int chan1, int chan2) const;
+
+    /** Regroups the filtered channels into banks, keeping the state of each channel */
+    void updateFilterBanks();
+    void handleAsyncUpdate() override;
+
+    /** Carries the state of each channel over from the setup in use to the next one. Called by
+        process() when it picks up a setup, or on the message thread while acquisition is stopped */
+    void takeOverFilterState (FilterBankSetup& next);
+
+    /** Deletes setups process() is done with, and any one it hasn't picked up yet */
+    void collectSetups (bool includingPending);
 
     Array<double> lowCuts;
     Array<double> highCuts;
@@ -70,6 +123,16 @@ private:
     OwnedArray<Dsp::Filter> filters;
     Array<bool> shouldFilterChannel;
 
+    /** Used by process(). Only replaced from the message thread while acquisition is stopped */
+    ScopedPointer<FilterBankSetup> activeSetup;
+
+    /** A new setup for process() to pick up, and the one it replaced, to be deleted on the message thread */
+    Atomic<FilterBankSetup*> pendingSetup;
+    Atomic<FilterBankSetup*> retiredSetup;
+
+    bool acquisitionActive;
+    bool groupedFiltering;
+
     bool applyOnADC;
 
     double defaultLowCut;
@@ -0,0 +1,189 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FirFilterEditor.h"
+#include "FirFilterNode.h"
+
+
+FirFilterEditor::FirFilterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors=true)
+    : GenericEditor(parentNode, useDefaultParameterEditors)
+
+{
+    desiredWidth = 180;
+
+    lowCutLabel = new Label("low cut label", "Low cut:");
+    lowCutLabel->setBounds(10,25,80,20);
+    lowCutLabel->setFont(Font("Small Text", 12, Font::plain));
+    lowCutLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(lowCutLabel);
+
+    highCutLabel = new Label("high cut label", "High cut:");
+    highCutLabel->setBounds(10,65,80,20);
+    highCutLabel->setFont(Font("Small Text", 12, Font::plain));
+    highCutLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(highCutLabel);
+
+    tapsLabel = new Label("taps label", "Taps:");
+    tapsLabel->setBounds(90,25,80,20);
+    tapsLabel->setFont(Font("Small Text", 12, Font::plain));
+    tapsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(tapsLabel);
+
+    fftLabel = new Label("fft label", "FFT size:");
+    fftLabel->setBounds(90,65,80,20);
+    fftLabel->setFont(Font("Small Text", 12, Font::plain));
+    fftLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(fftLabel);
+
+    lowCutValue = createValueLabel("low cut value", 15, 42, "Set the low cut, in Hz. 0 makes a low pass filter");
+    highCutValue = createValueLabel("high cut value", 15, 82, "Set the high cut, in Hz");
+    tapsValue = createValueLabel("taps value", 95, 42, "Set the length of the filter. More taps give a sharper filter and a longer delay");
+
+    fftSizeSelector = new ComboBox("fft size");
+    fftSizeSelector->setBounds(95,82,70,18);
+    for (int order = 8; order <= 16; order++)
+        fftSizeSelector->addItem(String(1 << order), order);
+    fftSizeSelector->addListener(this);
+    fftSizeSelector->setTooltip("Larger FFTs filter long filters with less processing, but add latency");
+    addAndMakeVisible(fftSizeSelector);
+
+    delayLabel = new Label("delay label", "");
+    delayLabel->setBounds(10,105,160,15);
+    delayLabel->setFont(Font("Small Text", 11, Font::plain));
+    delayLabel->setColour(Label::textColourId, Colours::darkgrey);
+    delayLabel->setTooltip("Delay of the filtered data, removed from the timestamps passed downstream");
+    addAndMakeVisible(delayLabel);
+
+    updateFromProcessor();
+}
+
+FirFilterEditor::~FirFilterEditor()
+{
+
+}
+
+Label* FirFilterEditor::createValueLabel(const String& name, int x, int y, const String& tooltip)
+{
+    Label* label = new Label(name, "");
+    label->setBounds(x,y,60,18);
+    label->setFont(Font("Default", 15, Font::plain));
+    label->setColour(Label::textColourId, Colours::white);
+    label->setColour(Label::backgroundColourId, Colours::grey);
+    label->setEditable(true);
+    label->addListener(this);
+    label->setTooltip(tooltip);
+    addAndMakeVisible(label);
+    return label;
+}
+
+void FirFilterEditor::updateFromProcessor()
+{
+    FirFilterNode* fn = (FirFilterNode*) getProcessor();
+
+    lowCutValue->setText(String(fn->getLowCut()), dontSendNotification);
+    highCutValue->setText(String(fn->getHighCut()), dontSendNotification);
+    tapsValue->setText(String(fn->getNumTaps()), dontSendNotification);
+    fftSizeSelector->setSelectedId(fn->getFftOrder(), dontSendNotification);
+
+    delayLabel->setText("Delay: " + String(fn->getGroupDelay()) + " samples, "
+                        + String(fn->getGroupDelayMs(), 1) + " ms", dontSendNotification);
+}
+
+void FirFilterEditor::updateSettings()
+{
+    // the delay in milliseconds depends on the sample rate of the input
+    updateFromProcessor();
+}
+
+void FirFilterEditor::labelTextChanged(Label* label)
+{
+    FirFilterNode* fn = (FirFilterNode*) getProcessor();
+
+    double requestedValue = label->getText().getDoubleValue();
+
+    if (label == lowCutValue)
+    {
+        if (requestedValue < 0 || requestedValue >= fn->getHighCut())
+            CoreServices::sendStatusMessage("Value out of range.");
+        else
+            fn->setParameter(FirFilterNode::LOW_CUT, requestedValue);
+    }
+    else if (label == highCutValue)
+    {
+        if (requestedValue <= fn->getLowCut())
+            CoreServices::sendStatusMessage("Value out of range.");
+        else
+            fn->setParameter(FirFilterNode::HIGH_CUT, requestedValue);
+    }
+    else if (label == tapsValue)
+    {
+        fn->setParameter(FirFilterNode::NUM_TAPS, requestedValue);
+    }
+
+    updateFromProcessor();
+}
+
+void FirFilterEditor::comboBoxChanged(ComboBox* comboBox)
+{
+    if (comboBox == fftSizeSelector)
+    {
+        FirFilterNode* fn = (FirFilterNode*) getProcessor();
+        fn->setParameter(FirFilterNode::FFT_ORDER, fftSizeSelector->getSelectedId());
+
+        updateFromProcessor();
+    }
+}
+
+
+void FirFilterEditor::saveCustomParameters(XmlElement* xml)
+{
+    FirFilterNode* fn = (FirFilterNode*) getProcessor();
+
+    xml->setAttribute("Type", "FirFilterEditor");
+
+    XmlElement* values = xml->createNewChildElement("VALUES");
+    values->setAttribute("LowCut", fn->getLowCut());
+    values->setAttribute("HighCut", fn->getHighCut());
+    values->setAttribute("Taps", fn->getNumTaps());
+    values->setAttribute("FftOrder", fn->getFftOrder());
+}
+
+void FirFilterEditor::loadCustomParameters(XmlElement* xml)
+{
+    FirFilterNode* fn = (FirFilterNode*) getProcessor();
+
+    forEachXmlChildElement(*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName("VALUES"))
+        {
+            // clear the low cut first, so any saved band is accepted whatever the current one
+            fn->setParameter(FirFilterNode::LOW_CUT, 0);
+            fn->setParameter(FirFilterNode::HIGH_CUT, xmlNode->getDoubleAttribute("HighCut", fn->getHighCut()));
+            fn->setParameter(FirFilterNode::LOW_CUT, xmlNode->getDoubleAttribute("LowCut", fn->getLowCut()));
+            fn->setParameter(FirFilterNode::NUM_TAPS, xmlNode->getIntAttribute("Taps", fn->getNumTaps()));
+            fn->setParameter(FirFilterNode::FFT_ORDER, xmlNode->getIntAttribute("FftOrder", fn->getFftOrder()));
+        }
+    }
+
+    updateFromProcessor();
+}
@@ -0,0 +1,81 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __FIRFILTEREDITOR_H_INCLUDED__
+#define __FIRFILTEREDITOR_H_INCLUDED__
+
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the FirFilterNode processor.
+
+  Sets the cutoffs, the number of taps and the FFT size of the filter, and
+  shows the resulting delay.
+
+  @see FirFilterNode
+
+*/
+
+class FirFilterEditor : public GenericEditor,
+    public Label::Listener,
+    public ComboBox::Listener
+{
+public:
+    FirFilterEditor(GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~FirFilterEditor();
+
+    void labelTextChanged(Label* label);
+    void comboBoxChanged(ComboBox* comboBox);
+
+    void saveCustomParameters(XmlElement* xml);
+    void loadCustomParameters(XmlElement* xml);
+
+    void updateSettings();
+
+private:
+    /** Shows the settings of the processor, which may have adjusted the requested ones */
+    void updateFromProcessor();
+
+    Label* createValueLabel(const String& name, int x, int y, const String& tooltip);
+
+    ScopedPointer<Label> lowCutLabel;
+    ScopedPointer<Label> highCutLabel;
+    ScopedPointer<Label> tapsLabel;
+    ScopedPointer<Label> fftLabel;
+
+    ScopedPointer<Label> lowCutValue;
+    ScopedPointer<Label> highCutValue;
+    ScopedPointer<Label> tapsValue;
+    ScopedPointer<ComboBox> fftSizeSelector;
+
+    ScopedPointer<Label> delayLabel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FirFilterEditor);
+
+};
+
+
+
+#endif  // __FIRFILTEREDITOR_H_INCLUDED__
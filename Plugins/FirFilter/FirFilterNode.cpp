@@ -0,0 +1,409 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FirFilterNode.h"
+#include "FirFilterEditor.h"
+
+
+FirFilterNode::FirFilterNode()
+    : GenericProcessor  ("FIR Filter")
+    , pendingSetup      (nullptr)
+    , retiredSetup      (nullptr)
+    , acquisitionActive (false)
+    , outputDelay       (0)
+    , lowCut            (300.0)
+    , highCut           (6000.0)
+    , numTaps           (255)
+    , fftOrder          (10)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+
+    // every pair of channels has its own buffers, and a pair costs two FFTs per partition
+    setChannelParallelProcessing (true, 4);
+}
+
+
+FirFilterNode::~FirFilterNode()
+{
+    collectSetups (true);
+}
+
+
+AudioProcessorEditor* FirFilterNode::createEditor()
+{
+    editor = new FirFilterEditor (this, true);
+
+    return editor;
+}
+
+
+void FirFilterNode::updateSettings()
+{
+    createFilteredChannels();
+
+    FilterSetup* setup = createSetup();
+    if (setup == nullptr)
+        CoreServices::sendStatusMessage ("FIR Filter: can't set up the filter, channels are passed unfiltered");
+
+    installSetup (setup);
+}
+
+
+bool FirFilterNode::enable()
+{
+    acquisitionActive = true;
+    outputDelay = 0;
+
+    if (activeSetup != nullptr)
+    {
+        for (int p = 0; p < activeSetup->channelPairs.size(); ++p)
+            activeSetup->channelPairs[p]->state.reset();
+
+        outputDelay = activeSetup->groupDelay;
+    }
+
+    samplesToWithhold.clearQuick();
+    samplesToWithhold.insertMultiple (0, outputDelay, inputSources.size());
+
+    return true;
+}
+
+
+bool FirFilterNode::disable()
+{
+    // process() isn't called anymore, so a setup it didn't pick up can be used directly
+    acquisitionActive = false;
+
+    FilterSetup* setup = pendingSetup.exchange (nullptr);
+    if (setup != nullptr)
+        activeSetup = setup;
+
+    collectSetups (false);
+
+    return true;
+}
+
+
+int FirFilterNode::getNumSubProcessors() const
+{
+    return jmax (1, inputSources.size());
+}
+
+
+float FirFilterNode::getSampleRate (int subProcessorIdx) const
+{
+    if (isPositiveAndBelow (subProcessorIdx, inputSampleRates.size()))
+        return inputSampleRates[subProcessorIdx];
+
+    return getDefaultSampleRate();
+}
+
+
+bool FirFilterNode::isGeneratesTimestamps() const
+{
+    return true;
+}
+
+
+double FirFilterNode::getLowCut() const
+{
+    return lowCut;
+}
+
+
+double FirFilterNode::getHighCut() const
+{
+    return highCut;
+}
+
+
+int FirFilterNode::getNumTaps() const
+{
+    return numTaps;
+}
+
+
+int FirFilterNode::getFftOrder() const
+{
+    return fftOrder;
+}
+
+
+int FirFilterNode::getGroupDelay() const
+{
+    // the delay in samples only depends on the taps and the FFT size, not on the sample rate
+    const int fftSize = 1 << fftOrder;
+    return (fftSize - numTaps + 1) + (numTaps - 1) / 2;
+}
+
+
+double FirFilterNode::getGroupDelayMs() const
+{
+    const float sampleRate = (dataChannelArray.size() > 0) ? dataChannelArray[0]->getSampleRate()
+                                                           : getDefaultSampleRate();
+
+    return 1000.0 * getGroupDelay() / sampleRate;
+}
+
+
+void FirFilterNode::createFilteredChannels()
+{
+    inputSources.clearQuick();
+    inputSampleRates.clearQuick();
+
+    // the subprocessors must be known before creating channels, which read their count
+    Array<int> channelSubProcessors;
+
+    for (int n = 0; n < dataChannelArray.size(); ++n)
+    {
+        const DataChannel* input = dataChannelArray[n];
+        const uint32 sourceId = getProcessorFullId (input->getSourceNodeID(), input->getSubProcessorIdx());
+
+        int subProcessor = inputSources.indexOf (sourceId);
+        if (subProcessor < 0)
+        {
+            inputSources.add (sourceId);
+            inputSampleRates.add (input->getSampleRate());
+            subProcessor = inputSources.size() - 1;
+        }
+
+        channelSubProcessors.add (subProcessor);
+    }
+
+    OwnedArray<DataChannel> inputChannels;
+    inputChannels.swapWith (dataChannelArray);
+
+    for (int n = 0; n < inputChannels.size(); ++n)
+    {
+        const DataChannel* input = inputChannels[n];
+
+        DataChannel* chan = new DataChannel (input->getChannelType(), input->getSampleRate(), this, channelSubProcessors[n]);
+        chan->setName (input->getName());
+        chan->setDescription (input->getDescription());
+        chan->setIdentifier (input->getIdentifier());
+        chan->setBitVolts (input->getBitVolts());
+        chan->setDataUnits (input->getDataUnits());
+        chan->setEnable (input->isEnabled());
+        chan->setRecordState (input->getRecordState());
+        chan->setMonitored (input->isMonitored());
+        chan->addToHistoricString (input->getHistoricString());
+
+        for (int m = 0; m < input->getMetaDataCount(); ++m)
+            chan->addMetaData (*input->getMetaDataDescriptor (m), *input->getMetaDataValue (m));
+
+        dataChannelArray.add (chan);
+    }
+}
+
+
+FirFilterNode::FilterSetup* FirFilterNode::createSetup() const
+{
+    ScopedPointer<FilterSetup> setup = new FilterSetup();
+    setup->groupDelay = getGroupDelay();
+    Array<float> sampleRates;
+
+    HeapBlock<float> taps (numTaps);
+
+    for (int n = 0; n < dataChannelArray.size(); ++n)
+    {
+        const DataChannel* chan = dataChannelArray[n];
+
+        int convolver = sampleRates.indexOf (chan->getSampleRate());
+        if (convolver < 0)
+        {
+            Dsp::designFirBandPass (taps, numTaps, chan->getSampleRate(), lowCut, highCut);
+
+            if (! setup->convolvers.add (new Dsp::OverlapSaveConvolver())->setup (taps, numTaps, fftOrder))
+                return nullptr;
+
+            sampleRates.add (chan->getSampleRate());
+            convolver = sampleRates.size() - 1;
+        }
+
+        // the two channels of a pair must have the same number of samples in every block
+        ChannelPair* pair = setup->channelPairs.getLast();
+        if (pair != nullptr
+            && pair->second < 0
+            && pair->convolver == convolver
+            && dataChannelArray[pair->first]->getSubProcessorIdx() == chan->getSubProcessorIdx())
+        {
+            pair->second = n;
+        }
+        else
+        {
+            pair = setup->channelPairs.add (new ChannelPair());
+            pair->first = n;
+            pair->second = -1;
+            pair->convolver = convolver;
+            pair->inputSource = inputSources[chan->getSubProcessorIdx()];
+            setup->convolvers[convolver]->prepare (pair->state);
+        }
+    }
+
+    return setup.release();
+}
+
+
+void FirFilterNode::installSetup (FilterSetup* setup)
+{
+    collectSetups (true);
+
+    // during acquisition, process() swaps it in at the start of its next block
+    if (acquisitionActive)
+        pendingSetup.set (setup);
+    else
+        activeSetup = setup;
+}
+
+
+void FirFilterNode::collectSetups (bool includingPending)
+{
+    delete retiredSetup.exchange (nullptr);
+
+    if (includingPending)
+        delete pendingSetup.exchange (nullptr);
+}
+
+
+void FirFilterNode::setParameter (int parameterIndex, float newValue)
+{
+    const double previousLowCut = lowCut;
+    const double previousHighCut = highCut;
+    const int previousNumTaps = numTaps;
+    const int previousFftOrder = fftOrder;
+
+    if (parameterIndex == LOW_CUT)
+    {
+        if (newValue < 0.0f || newValue >= highCut)
+            return;
+
+        lowCut = newValue;
+    }
+    else if (parameterIndex == HIGH_CUT)
+    {
+        if (newValue <= lowCut)
+            return;
+
+        highCut = newValue;
+    }
+    else if (parameterIndex == NUM_TAPS)
+    {
+        // the filter is symmetric around its centre tap
+        numTaps = jlimit (3, 16383, int (newValue)) | 1;
+    }
+    else if (parameterIndex == FFT_ORDER)
+    {
+        fftOrder = jlimit (8, 16, int (newValue));
+    }
+    else
+    {
+        return;
+    }
+
+    // the FFT must be longer than the filter
+    while ((1 << fftOrder) <= numTaps)
+        ++fftOrder;
+
+    FilterSetup* setup = createSetup();
+    if (setup == nullptr)
+    {
+        lowCut = previousLowCut;
+        highCut = previousHighCut;
+        numTaps = previousNumTaps;
+        fftOrder = previousFftOrder;
+
+        CoreServices::sendStatusMessage ("FIR Filter: can't set up the filter, keeping the previous settings");
+        return;
+    }
+
+    installSetup (setup);
+}
+
+
+void FirFilterNode::process (AudioSampleBuffer& buffer)
+{
+    // a new setup is only taken once the message thread has deleted the one replaced before,
+    // so nothing is ever deleted here
+    if (retiredSetup.get() == nullptr)
+    {
+        FilterSetup* setup = pendingSetup.exchange (nullptr);
+        if (setup != nullptr)
+        {
+            retiredSetup.set (activeSetup.release());
+            activeSetup = setup;
+
+            // the new filters start from silence. Withholding the difference in delay makes the
+            // output continue after the last sample sent, or leave a gap if the delay got shorter
+            for (int sub = 0; sub < samplesToWithhold.size(); ++sub)
+                samplesToWithhold.set (sub, jmax (0, samplesToWithhold[sub] + setup->groupDelay - outputDelay));
+
+            outputDelay = setup->groupDelay;
+        }
+    }
+
+    if (activeSetup != nullptr)
+        processChannelsInParallel (buffer, activeSetup->channelPairs.size());
+
+    for (int sub = 0; sub < inputSources.size(); ++sub)
+    {
+        const juce::uint64 timestamp = getSourceTimestamp (inputSources[sub]);
+        const int numSamples = getNumSourceSamples (inputSources[sub]);
+        const int withheld = jmin (samplesToWithhold[sub], numSamples);
+
+        if (withheld > 0)
+        {
+            samplesToWithhold.set (sub, samplesToWithhold[sub] - withheld);
+
+            for (int n = 0; n < dataChannelArray.size(); ++n)
+            {
+                if (dataChannelArray[n]->getSubProcessorIdx() == sub)
+                {
+                    float* samples = buffer.getWritePointer (n);
+                    memmove (samples, samples + withheld, sizeof (float) * (numSamples - withheld));
+                }
+            }
+        }
+
+        // output sample i of the block is centred on input sample timestamp + i - outputDelay,
+        // which is never before the first input sample once the withheld ones are dropped
+        const juce::uint64 firstSample = timestamp + withheld;
+        setTimestampAndSamples (firstSample > juce::uint64 (outputDelay) ? firstSample - outputDelay : 0,
+                                numSamples - withheld,
+                                sub);
+    }
+}
+
+
+void FirFilterNode::processChannelRange (AudioSampleBuffer& buffer, int startPair, int numPairs)
+{
+    for (int p = startPair; p < startPair + numPairs; ++p)
+    {
+        ChannelPair* pair = activeSetup->channelPairs.getUnchecked (p);
+
+        float* channelB = (pair->second >= 0) ? buffer.getWritePointer (pair->second) : nullptr;
+
+        activeSetup->convolvers.getUnchecked (pair->convolver)->process (pair->state,
+                                                                         getNumSourceSamples (pair->inputSource),
+                                                                         buffer.getWritePointer (pair->first),
+                                                                         channelB);
+    }
+}
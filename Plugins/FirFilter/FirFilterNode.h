@@ -0,0 +1,160 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __FIRFILTERNODE_H_INCLUDED__
+#define __FIRFILTERNODE_H_INCLUDED__
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+
+
+/**
+    Band pass filters all channels with a linear phase FIR filter, using
+    Dsp::OverlapSaveConvolver.
+
+    Unlike the Butterworth filter of FilterNode, every frequency is delayed by
+    the same amount, so the waveforms keep their shape. That delay, the
+    partition latency plus half the filter length, is compensated in the
+    timestamps: the filtered channels are given this processor as their source,
+    with a subprocessor for each source of the input channels. The first delay
+    samples after acquisition starts are withheld, and the blocks of those
+    subprocessors carry the input timestamps minus the delay, so they go on
+    increasing. The filtered samples so have the timestamps of the input
+    samples they are centred on, as with a zero phase filter, while the input
+    sources and the events passed on keep theirs.
+
+    More taps give a sharper filter. A larger FFT makes long filters cheaper
+    per sample, at the cost of more latency. Channels are filtered two per
+    transform, and the pairs in parallel.
+
+    Settings changed during acquisition are designed on the message thread and
+    handed to process() without locking.
+
+    @see GenericProcessor, FirFilterEditor
+*/
+class FirFilterNode : public GenericProcessor
+{
+public:
+    enum Parameter
+    {
+        LOW_CUT = 0,
+        HIGH_CUT,
+        NUM_TAPS,
+        FFT_ORDER
+    };
+
+    FirFilterNode();
+    ~FirFilterNode();
+
+    AudioProcessorEditor* createEditor() override;
+
+    bool hasEditor() const override { return true; }
+
+    bool enable() override;
+    bool disable() override;
+
+    /** The filtered channels of each input source form a subprocessor */
+    int getNumSubProcessors() const override;
+    float getSampleRate (int subProcessorIdx = 0) const override;
+    bool isGeneratesTimestamps() const override;
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    /** Filters a range of channel pairs, called from process() on the channel processing threads */
+    void processChannelRange (AudioSampleBuffer& buffer, int startPair, int numPairs) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    double getLowCut() const;
+    double getHighCut() const;
+    int getNumTaps() const;
+    int getFftOrder() const;
+
+    /** Delay of the output, in samples, which is compensated in the block timestamps */
+    int getGroupDelay() const;
+
+    /** Same, in milliseconds at the sample rate of the first channel */
+    double getGroupDelayMs() const;
+
+
+private:
+    /** Two channels of the same source, or a single one, filtered in one transform */
+    struct ChannelPair
+    {
+        int first;
+        int second;
+        int convolver;
+        uint32 inputSource;
+        Dsp::OverlapSaveConvolver::State state;
+    };
+
+    /** The filters for every sample rate and the channel pairs using them */
+    struct FilterSetup
+    {
+        OwnedArray<Dsp::OverlapSaveConvolver> convolvers;
+        OwnedArray<ChannelPair> channelPairs;
+        int groupDelay;
+    };
+
+    /** Makes the filtered channels sourced by this processor, one subprocessor per input source */
+    void createFilteredChannels();
+
+    /** Designs the filter for every sample rate and pairs the channels, with a reset filter state.
+        Returns nullptr if the filter can't be set up */
+    FilterSetup* createSetup() const;
+
+    /** Makes the setup used by process(), right away or, during acquisition, from its next block */
+    void installSetup (FilterSetup* setup);
+
+    /** Deletes setups process() is done with, and any one it hasn't picked up yet */
+    void collectSetups (bool includingPending);
+
+    /** Used by process(). Only replaced from the message thread while acquisition is stopped */
+    ScopedPointer<FilterSetup> activeSetup;
+
+    /** A new setup for process() to pick up, and the one it replaced, to be deleted on the message thread */
+    Atomic<FilterSetup*> pendingSetup;
+    Atomic<FilterSetup*> retiredSetup;
+
+    bool acquisitionActive;
+
+    /** Full ids of the input sources, and their sample rates, by subprocessor */
+    Array<uint32> inputSources;
+    Array<float> inputSampleRates;
+
+    /** Output samples of each subprocessor still to drop before the delayed signal begins */
+    Array<int> samplesToWithhold;
+
+    /** Group delay of the active setup, or 0 while nothing is filtered */
+    int outputDelay;
+
+    double lowCut;
+    double highCut;
+    int numTaps;
+    int fftOrder;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FirFilterNode);
+};
+
+#endif  // __FIRFILTERNODE_H_INCLUDED__
@@ -1443,6 +1443,13 @@ bool RHD2000Thread::startAcquisition()
 
     std::cout << "Expecting " << getNumChannels() << " channels." << std::endl;
 
+	int samplesPerFrame = Rhd2000DataBlockUsb3::getSamplesPerDataBlock();
+	frameChannels = getNumChannels();
+	// extra room for a full sample, in case the last one overruns the expected channel count
+	frameSamples.malloc(samplesPerFrame * frameChannels + MAX_NUM_CHANNELS);
+	frameTimestamps.malloc(samplesPerFrame);
+	frameEventWords.malloc(samplesPerFrame);
+
     //memset(filter_states,0,256*sizeof(double));
 
     int ledArray[8] = {1, 1, 0, 0, 0, 0, 0, 0};
@@ -1558,9 +1565,11 @@ bool RHD2000Thread::updateBuffer()
 	int nSamps = Rhd2000DataBlockUsb3::getSamplesPerDataBlock();
 
 	//evalBoard->printFIFOmetrics();
-	for (int samp = 0; samp < nSamps; samp++)
+	int samp;
+	for (samp = 0; samp < nSamps; samp++)
 	{
 		int channel = -1;
+		float* thisSample = frameSamples + samp * frameChannels;
 
 		if (!Rhd2000DataBlockUsb3::checkUsbHeader(bufferPtr, index))
 		{
@@ -1570,7 +1579,7 @@ bool RHD2000Thread::updateBuffer()
 		}
 
 		index += 8;
-		timestamps.set(0, Rhd2000DataBlockUsb3::convertUsbTimeStamp(bufferPtr, index));
+		frameTimestamps[samp] = Rhd2000DataBlockUsb3::convertUsbTimeStamp(bufferPtr, index);
 		index += 4;
 		auxIndex = index;
 		//skip the aux channels
@@ -1636,10 +1645,10 @@ bool RHD2000Thread::updateBuffer()
 		{
 			index += 16;
 		}
-		ttlEventWords.set(0, *(uint16*)(bufferPtr + index));
+		frameEventWords[samp] = *(uint16*)(bufferPtr + index);
 		index += 4;
-		sourceBuffers[0]->addToBuffer(thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
 	}
+	sourceBuffers[0]->addInterleavedBlock(frameSamples, frameTimestamps, frameEventWords, samp);
 
 
 
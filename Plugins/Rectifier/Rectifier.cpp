@@ -31,6 +31,9 @@ Rectifier::Rectifier()
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
+    // rectifying is cheap, so only large channel counts are worth splitting
+    setChannelParallelProcessing (true, 64);
+
     // It would be nice to have the option to do -abs for negative events (e.g. sharp waves)
     //parameters.add(Parameter("Sign", -1.0, 1.0, 1.0, -1.0));
 }
@@ -55,9 +58,13 @@ void Rectifier::setParameter (int parameterIndex, float newValue)
 
 void Rectifier::process (AudioSampleBuffer& buffer)
 {
-    const int nChannels = buffer.getNumChannels();
+    processChannelsInParallel (buffer, buffer.getNumChannels());
+}
 
-    for (int ch = 0; ch < nChannels ; ++ch)
+
+void Rectifier::processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels)
+{
+    for (int ch = startChannel; ch < startChannel + numChannels; ++ch)
     {
         const int nSamples = buffer.getNumSamples();
         float* bufPtr = buffer.getWritePointer (ch);
@@ -56,6 +56,9 @@ public:
      */
     void process (AudioSampleBuffer& buffer) override;
 
+    /** Rectifies a range of channels, called from process() on the channel processing threads */
+    void processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels) override;
+
     /** Any variables used by the "process" function _must_ be modified only through
      this method while data acquisition is active. If they are modified in any
      other way, the application will crash.  */
@@ -1426,6 +1426,13 @@ bool RHD2000Thread::startAcquisition()
 
     std::cout << "Expecting " << getNumChannels() << " channels." << std::endl;
 
+    int samplesPerFrame = Rhd2000DataBlock::getSamplesPerDataBlock(evalBoard->isUSB3());
+    frameChannels = getNumChannels();
+    // extra room for a full sample, in case the last one overruns the expected channel count
+    frameSamples.malloc(samplesPerFrame * frameChannels + MAX_NUM_CHANNELS);
+    frameTimestamps.malloc(samplesPerFrame);
+    frameEventWords.malloc(samplesPerFrame);
+
     //memset(filter_states,0,256*sizeof(double));
 
     int ledArray[8] = {1, 1, 0, 0, 0, 0, 0, 0};
@@ -1535,9 +1542,11 @@ bool RHD2000Thread::updateBuffer()
         int nSamps = Rhd2000DataBlock::getSamplesPerDataBlock(evalBoard->isUSB3());
 
         //evalBoard->printFIFOmetrics();
-        for (int samp = 0; samp < nSamps; samp++)
+        int samp;
+        for (samp = 0; samp < nSamps; samp++)
         {
             int channel = -1;
+            float* thisSample = frameSamples + samp * frameChannels;
 
             if (!Rhd2000DataBlock::checkUsbHeader(bufferPtr, index))
             {
@@ -1546,7 +1555,7 @@ bool RHD2000Thread::updateBuffer()
             }
 
             index += 8; // magic number header width (bytes)
-            timestamps.set(0, Rhd2000DataBlock::convertUsbTimeStamp(bufferPtr, index));
+            frameTimestamps[samp] = Rhd2000DataBlock::convertUsbTimeStamp(bufferPtr, index);
             index += 4; // timestamp width
             auxIndex = index; // aux chans start at this offset
             // skip aux channels for now
@@ -1614,10 +1623,10 @@ bool RHD2000Thread::updateBuffer()
             {
                 index += 16; // skip ADC chans (8 * 2 bytes)
             }
-            ttlEventWords.set(0, *(uint16*)(bufferPtr + index));
+            frameEventWords[samp] = *(uint16*)(bufferPtr + index);
             index += 4;
-            sourceBuffers[0]->addToBuffer(thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
         }
+        sourceBuffers[0]->addInterleavedBlock(frameSamples, frameTimestamps, frameEventWords, samp);
 
     }
 
@@ -171,7 +171,11 @@ namespace RhythmNode
 		int numChannels;
 		bool deviceFound;
 
-		float thisSample[MAX_NUM_CHANNELS];
+		// a whole USB frame is assembled here, so it can be sent to the DataBuffer with a single call
+		HeapBlock<float> frameSamples;
+		HeapBlock<int64> frameTimestamps;
+		HeapBlock<uint64> frameEventWords;
+		int frameChannels;
 		// aux inputs are only sampled every 4th sample, so use this to buffer the samples so they can be handles just like the regular neural channels later
 		float auxBuffer[MAX_NUM_CHANNELS];
 		float auxSamples[MAX_NUM_DATA_STREAMS_USB3][3];
@@ -36,6 +36,10 @@ SpikeSorter::SpikeSorter()
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
+    // the ranges count electrodes, which are sorted independently. Sorting projects and
+    // classifies every spike besides scanning the channels, so two electrodes fill a range
+    setChannelParallelProcessing(true, 2);
+
     uniqueID = 0; // for electrode count
     uniqueSpikeID = 0;
     juce::Time timer;
@@ -711,21 +715,23 @@ Electrode* SpikeSorter::getActiveElectrode()
 void SpikeSorter::addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
                                            int& peakIndex,
                                            int& electrodeNumber,
-                                           int& currentChannel)
+                                           int& currentChannel,
+                                           int sampleIndex)
 {
-    mut.enter();
 	int spikeLength = electrodes[electrodeNumber]->prePeakSamples
 		+ electrodes[electrodeNumber]->postPeakSamples;
 
 	const int chan = *(electrodes[electrodeNumber]->channels + currentChannel);
 
 
-	if (isChannelActive(electrodeNumber, currentChannel))
+	// not isChannelActive(), which takes mut, as this runs on the channel processing threads
+	// while process() holds it
+	if (*(electrodes[electrodeNumber]->isActive + currentChannel))
 	{
 
 		for (int sample = 0; sample < spikeLength; ++sample)
 		{
-			s.set(currentChannel, sample, getNextSample(*(electrodes[electrodeNumber]->channels + currentChannel)));
+			s.set(currentChannel, sample, getNextSample(*(electrodes[electrodeNumber]->channels + currentChannel), sampleIndex));
 			++sampleIndex;
 
 			//std::cout << currentIndex << std::endl;
@@ -737,14 +743,10 @@ void SpikeSorter::addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
 		{
 			// insert a blank spike if the
 			s.set(currentChannel, sample, 0);
-			++sampleIndex;
 			//std::cout << currentIndex << std::endl;
 		}
 	}
 
-	sampleIndex -= spikeLength; // reset sample index
-    mut.exit();
-
 }
 
 void SpikeSorter::startRecording()
@@ -854,188 +856,207 @@ void SpikeSorter::process(AudioSampleBuffer& buffer)
 
     //printf("Entering Spike Detector::process\n");
     mut.enter();
-    uint16_t samplingFrequencyHz = getSampleRate();//buffer.getSamplingFrequency();
-    // cycle through electrodes
-    Electrode* electrode;
     dataBuffer = &buffer;
-	const SpikeChannel* spikeChan;
 
     //channelBuffers->update(buffer, hardware_timestamp,software_timestamp, nSamples);
 
+    while (spikeStagings.size() < electrodes.size())
+        spikeStagings.add(new SpikeStaging());
+
+    // the electrodes are sorted on the channel processing threads, which must not take mut
+    processChannelsInParallel(buffer, electrodes.size());
+
+    addStagedSpikes(spikeStagings);
+
+    // cycle through electrodes
     for (int i = 0; i < electrodes.size(); i++)
     {
+        Electrode* electrode = electrodes[i];
+        int nSamples = getNumSamples(*electrode->channels);
 
-        //  std::cout << "ELECTRODE " << i << std::endl;
+        if (nSamples > overflowBufferSize)
+        {
+
+            for (int j = 0; j < electrode->numChannels; j++)
+            {
+                //std::cout << "Processing " << *electrode->channels+i << std::endl;
 
-        electrode = electrodes[i];
-		spikeChan = spikeChannelArray[i];
+                overflowBuffer.copyFrom(*(electrode->channels+j), 0,
+                                        buffer, *(electrode->channels+j),
+                                        nSamples-overflowBufferSize,
+                                        overflowBufferSize);
 
-        // refresh buffer index for this electrode
-        sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
-        // increment at start of getNextSample()
+            }
 
-        int nSamples = getNumSamples(*electrode->channels); // get the number of samples for this buffer
+            useOverflowBuffer.set(i, true);
 
-        // cycle through samples
-        while (samplesAvailable(nSamples))
+        }
+        else
         {
+            useOverflowBuffer.set(i, false);
+        }
 
-            sampleIndex++;
+    } // end cycle through electrodes
 
-            // cycle through channels
-            for (int chan = 0; chan < electrode->numChannels; chan++)
-            {
 
-                // std::cout << "  channel " << chan << std::endl;
+    mut.exit();
+    //printf("Exitting Spike Detector::process\n");
+}
 
-                if (*(electrode->isActive+chan))
-                {
-                    //float v = getNextSample(currentChannel);
+void SpikeSorter::processChannelRange(AudioSampleBuffer& buffer, int startElectrode, int numElectrodes)
+{
+    for (int i = startElectrode; i < startElectrode + numElectrodes; i++)
+    {
 
-                    int currentChannel = electrode->channels[chan];
-                    float currentValue = getNextSample(currentChannel);
-                    electrode->runningStats[chan].Push(currentValue);
+        //  std::cout << "ELECTRODE " << i << std::endl;
 
-                    bool bSpikeDetectedPositive  = electrode->thresholds[chan] > 0 &&
-                                                   (currentValue > electrode->thresholds[chan]); // rising edge
-                    bool bSpikeDetectedNegative = electrode->thresholds[chan] < 0 &&
-                                                  (currentValue < electrode->thresholds[chan]); // falling edge
+        detectSpikes(i);
+    }
+}
 
-                    if (bSpikeDetectedPositive || bSpikeDetectedNegative)
-                    {
+void SpikeSorter::detectSpikes(int i)
+{
+    Electrode* electrode = electrodes[i];
 
-                        //std::cout << "Spike detected on electrode " << i << std::endl;
-                        // find the peak
-                        int peakIndex = sampleIndex;
+    // refresh buffer index for this electrode
+    int sampleIndex = electrode->lastBufferIndex - 1; // subtract 1 to account for
+    // increment at start of getNextSample()
 
-                        //if (sampleIndex == 0 && i == 0)
-                        //    std::cout << getCurrentSample(currentChannel) << std::endl;
+    int nSamples = getNumSamples(*electrode->channels); // get the number of samples for this buffer
 
-                        if (bSpikeDetectedPositive)
-                        {
-                            // find localmaxima
-                            while (getCurrentSample(currentChannel) < getNextSample(currentChannel) &&
-                                   sampleIndex < peakIndex + electrode->postPeakSamples)
-                            {
-                                sampleIndex++;
-                            }
-                        }
-                        else
-                        {
-                            // find local minimum
+    // cycle through samples
+    while (samplesAvailable(nSamples, sampleIndex))
+    {
 
-                            while (getCurrentSample(currentChannel) > getNextSample(currentChannel) &&
-                                   sampleIndex < peakIndex + electrode->postPeakSamples)
-                            {
-                                sampleIndex++;
-                            }
-                        }
+        sampleIndex++;
 
-                        peakIndex = sampleIndex;
-                        sampleIndex -= (electrode->prePeakSamples+1);
-
-						const SpikeChannel* spikeChan = getSpikeChannel(i);
-						SpikeEvent::SpikeBuffer spikeData(spikeChan);
-						Array<float> thresholds;
-						for (int channel = 0; channel < electrode->numChannels; ++channel)
-						{
-							addWaveformToSpikeObject(spikeData,
-								peakIndex,
-								i,
-								channel);
-							thresholds.add((int)*(electrode->thresholds + channel));
-						}
-						int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
-
-						SorterSpikePtr sorterSpike = new SorterSpikeContainer(spikeChan, spikeData, timestamp);
-
-                        /*
-                        bool perfectMatch = true;
-                        for (int k=0;k<40;k++) {
-                        	perfectMatch = perfectMatch & (prevSpike.data[k] == newSpike.data[k]);
-                        }
-                        if (perfectMatch)
-                        {
-                        	int x;
-                        	x++;
-                        }
-                        */
+        // cycle through channels
+        for (int chan = 0; chan < electrode->numChannels; chan++)
+        {
 
-                        //for (int xxx = 0; xxx < 1000; xxx++) // overload with spikes for testing purposes
-						electrode->spikeSort->projectOnPrincipalComponents(sorterSpike);
+            // std::cout << "  channel " << chan << std::endl;
 
-                        // Add spike to drawing buffer....
-						electrode->spikeSort->sortSpike(sorterSpike, PCAbeforeBoxes);
+            if (*(electrode->isActive+chan))
+            {
+                //float v = getNextSample(currentChannel);
 
+                int currentChannel = electrode->channels[chan];
+                float currentValue = getNextSample(currentChannel, sampleIndex);
+                electrode->runningStats[chan].Push(currentValue);
 
-                        // transfer buffered spikes to spike plot
-                        if (electrode->spikePlot != nullptr)
-                        {
-                            if (electrode->spikeSort->isPCAfinished())
-                            {
-                                electrode->spikeSort->resetJobStatus();
-                                float p1min,p2min, p1max,  p2max;
-                                electrode->spikeSort->getPCArange(p1min,p2min, p1max,  p2max);
-                                electrode->spikePlot->setPCARange(p1min,p2min, p1max,  p2max);
-                            }
+                bool bSpikeDetectedPositive  = electrode->thresholds[chan] > 0 &&
+                                               (currentValue > electrode->thresholds[chan]); // rising edge
+                bool bSpikeDetectedNegative = electrode->thresholds[chan] < 0 &&
+                                              (currentValue < electrode->thresholds[chan]); // falling edge
 
+                if (bSpikeDetectedPositive || bSpikeDetectedNegative)
+                {
 
-							electrode->spikePlot->processSpikeObject(sorterSpike);
-                        }
+                    //std::cout << "Spike detected on electrode " << i << std::endl;
+                    // find the peak
+                    int peakIndex = sampleIndex;
 
-						MetaDataValueArray md;
-						md.add(new MetaDataValue(MetaDataDescriptor::UINT8, 3, sorterSpike->color));
-						SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, timestamp, thresholds, spikeData, sorterSpike->sortedId, md);
+                    //if (sampleIndex == 0 && i == 0)
+                    //    std::cout << getCurrentSample(currentChannel) << std::endl;
 
-                        addSpike(spikeChan, newSpike, peakIndex);
-                        //prevSpike = newSpike;
-                        // advance the sample index
-                        sampleIndex = peakIndex + electrode->postPeakSamples;
+                    if (bSpikeDetectedPositive)
+                    {
+                        // find localmaxima
+                        while (getCurrentSample(currentChannel, sampleIndex) < getNextSample(currentChannel, sampleIndex) &&
+                               sampleIndex < peakIndex + electrode->postPeakSamples)
+                        {
+                            sampleIndex++;
+                        }
+                    }
+                    else
+                    {
+                        // find local minimum
 
-                        break; // quit spike "for" loop
-                    } // end spike trigger
+                        while (getCurrentSample(currentChannel, sampleIndex) > getNextSample(currentChannel, sampleIndex) &&
+                               sampleIndex < peakIndex + electrode->postPeakSamples)
+                        {
+                            sampleIndex++;
+                        }
+                    }
 
-                } // end if channel is active
-            } // end cycle through channels on electrode
+                    peakIndex = sampleIndex;
+                    sampleIndex -= (electrode->prePeakSamples+1);
+
+					const SpikeChannel* spikeChan = getSpikeChannel(i);
+					SpikeEvent::SpikeBuffer spikeData(spikeChan);
+					Array<float> thresholds;
+					for (int channel = 0; channel < electrode->numChannels; ++channel)
+					{
+						addWaveformToSpikeObject(spikeData,
+							peakIndex,
+							i,
+							channel,
+							sampleIndex);
+						thresholds.add((int)*(electrode->thresholds + channel));
+					}
+					int64 timestamp = getTimestamp(electrode->channels[0]) + peakIndex;
+
+					SorterSpikePtr sorterSpike = new SorterSpikeContainer(spikeChan, spikeData, timestamp);
+
+                    /*
+                    bool perfectMatch = true;
+                    for (int k=0;k<40;k++) {
+                    	perfectMatch = perfectMatch & (prevSpike.data[k] == newSpike.data[k]);
+                    }
+                    if (perfectMatch)
+                    {
+                    	int x;
+                    	x++;
+                    }
+                    */
 
+                    //for (int xxx = 0; xxx < 1000; xxx++) // overload with spikes for testing purposes
+					electrode->spikeSort->projectOnPrincipalComponents(sorterSpike);
 
-        } // end cycle through samples
+                    // Add spike to drawing buffer....
+					electrode->spikeSort->sortSpike(sorterSpike, PCAbeforeBoxes);
 
-        //float vv = getNextSample(currentChannel);
-        electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
 
-        //jassert(electrode->lastBufferIndex < 0);
+                    // transfer buffered spikes to spike plot
+                    if (electrode->spikePlot != nullptr)
+                    {
+                        if (electrode->spikeSort->isPCAfinished())
+                        {
+                            electrode->spikeSort->resetJobStatus();
+                            float p1min,p2min, p1max,  p2max;
+                            electrode->spikeSort->getPCArange(p1min,p2min, p1max,  p2max);
+                            electrode->spikePlot->setPCARange(p1min,p2min, p1max,  p2max);
+                        }
 
-        if (nSamples > overflowBufferSize)
-        {
 
-            for (int j = 0; j < electrode->numChannels; j++)
-            {
-                //std::cout << "Processing " << *electrode->channels+i << std::endl;
+						electrode->spikePlot->processSpikeObject(sorterSpike);
+                    }
 
-                overflowBuffer.copyFrom(*(electrode->channels+j), 0,
-                                        buffer, *(electrode->channels+j),
-                                        nSamples-overflowBufferSize,
-                                        overflowBufferSize);
+					MetaDataValueArray md;
+					md.add(new MetaDataValue(MetaDataDescriptor::UINT8, 3, sorterSpike->color));
+					SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent(spikeChan, timestamp, thresholds, spikeData, sorterSpike->sortedId, md);
 
-            }
+                    spikeStagings[i]->add(spikeChan, newSpike.release(), peakIndex);
+                    //prevSpike = newSpike;
+                    // advance the sample index
+                    sampleIndex = peakIndex + electrode->postPeakSamples;
 
-            useOverflowBuffer.set(i, true);
+                    break; // quit spike "for" loop
+                } // end spike trigger
 
-        }
-        else
-        {
-            useOverflowBuffer.set(i, false);
-        }
+            } // end if channel is active
+        } // end cycle through channels on electrode
 
-    } // end cycle through electrodes
 
+    } // end cycle through samples
 
-    mut.exit();
-    //printf("Exitting Spike Detector::process\n");
+    //float vv = getNextSample(currentChannel);
+    electrode->lastBufferIndex = sampleIndex - nSamples; // should be negative
+
+    //jassert(electrode->lastBufferIndex < 0);
 }
 
-float SpikeSorter::getNextSample(int& chan)
+float SpikeSorter::getNextSample(int& chan, int sampleIndex)
 {
 
 
@@ -1070,7 +1091,7 @@ float SpikeSorter::getNextSample(int& chan)
 
 }
 
-float SpikeSorter::getCurrentSample(int& chan)
+float SpikeSorter::getCurrentSample(int& chan, int sampleIndex)
 {
 
     // if (useOverflowBuffer)
@@ -1096,7 +1117,7 @@ float SpikeSorter::getCurrentSample(int& chan)
 }
 
 
-bool SpikeSorter::samplesAvailable(int nSamples)
+bool SpikeSorter::samplesAvailable(int nSamples, int sampleIndex)
 {
 
     if (sampleIndex > nSamples - overflowBufferSize/2)
@@ -231,6 +231,10 @@ public:
         spikes into the event buffer. */
     void process(AudioSampleBuffer& buffer) override;
 
+    /** Sorts the spikes of a range of electrodes, called from process() on the
+        channel processing threads. */
+    void processChannelRange(AudioSampleBuffer& buffer, int startElectrode, int numElectrodes) override;
+
     /** Used to alter parameters of data acquisition. */
     void setParameter(int parameterIndex, float newValue) override;
 
@@ -405,12 +409,18 @@ private:
 
     int overflowBufferSize;
 
-    int sampleIndex;
-
     std::vector<int> electrodeCounter;
-    float getNextSample(int& chan);
-    float getCurrentSample(int& chan);
-    bool samplesAvailable(int nSamples);
+    float getNextSample(int& chan, int sampleIndex);
+    float getCurrentSample(int& chan, int sampleIndex);
+    bool samplesAvailable(int nSamples, int sampleIndex);
+
+    /** Detects and sorts the spikes of an electrode in the current block, and
+        stages them in spikeStagings. */
+    void detectSpikes(int electrodeIndex);
+
+    /** The spikes of each electrode in the current block, merged into the
+        event buffer by process(). */
+    OwnedArray<SpikeStaging> spikeStagings;
 
     Array<bool> useOverflowBuffer;
 
@@ -439,7 +449,8 @@ private:
     void addWaveformToSpikeObject(SpikeEvent::SpikeBuffer& s,
                                   int& peakIndex,
                                   int& electrodeNumber,
-                                  int& currentChannel);
+                                  int& currentChannel,
+                                  int sampleIndex);
 
 
     OwnedArray<Electrode> electrodes;
@@ -25,8 +25,18 @@
 #include "AudioComponent.h"
 #include <stdio.h>
 
-AudioComponent::AudioComponent() : isPlaying(false)
+AudioComponent::AudioComponent(bool openAudioDevice)
+    : isPlaying(false), graph(nullptr), useProcessingDriver(false), audioDeviceEnabled(openAudioDevice)
 {
+    if (!audioDeviceEnabled)
+    {
+        std::cout << "Audio device disabled, using the processing driver thread." << std::endl;
+
+        useProcessingDriver = true;
+        graphPlayer = new AudioProcessorPlayer();
+        return;
+    }
+
     bool initialized = false;
     while (!initialized)
     {
@@ -67,13 +77,20 @@ AudioComponent::AudioComponent() : isPlaying(false)
     // the error string doesn't tell you if there's no audio device found...
     if (aIOd == 0)
     {
+        // acquisition can still run, clocked by the processing driver thread
+        std::cout << "No audio device found, using the processing driver thread." << std::endl;
+
         String titleMessage = String("No audio device found");
         String contentMessage = String("Couldn't find an audio device. ") +
-                                String("Perhaps some other program has control of the default one.");
+                                String("Perhaps some other program has control of the default one.\n") +
+                                String("Acquisition will run without audio monitoring.");
         AlertWindow::showMessageBox(AlertWindow::InfoIcon,
                                     titleMessage,
                                     contentMessage);
-        JUCEApplication::quit();
+
+        useProcessingDriver = true;
+        graphPlayer = new AudioProcessorPlayer();
+        return;
     }
 
 
@@ -125,6 +142,9 @@ AudioComponent::~AudioComponent()
 
 int AudioComponent::getBufferSize()
 {
+    if (useProcessingDriver)
+        return driver.getBlockSize();
+
     AudioDeviceManager::AudioDeviceSetup setup;
     deviceManager.getAudioDeviceSetup(setup);
 
@@ -133,15 +153,58 @@ int AudioComponent::getBufferSize()
 
 int AudioComponent::getBufferSizeMs()
 {
+    if (useProcessingDriver)
+        return int(driver.getPeriodMs());
+
     AudioDeviceManager::AudioDeviceSetup setup;
     deviceManager.getAudioDeviceSetup(setup);
 
     return int(float(setup.bufferSize)/setup.sampleRate*1000);
 }
 
+double AudioComponent::getSampleRate()
+{
+    if (useProcessingDriver)
+        return driver.getSampleRate();
+
+    AudioDeviceManager::AudioDeviceSetup setup;
+    deviceManager.getAudioDeviceSetup(setup);
+
+    return setup.sampleRate;
+}
+
+void AudioComponent::setUseProcessingDriver(bool useDriver)
+{
+    if (isPlaying)
+    {
+        std::cout << "Can't change the processing clock while acquisition is active." << std::endl;
+        return;
+    }
+
+    if (!useDriver && deviceManager.getCurrentAudioDevice() == nullptr)
+    {
+        std::cout << "No audio device available, keeping the processing driver thread." << std::endl;
+        return;
+    }
+
+    useProcessingDriver = useDriver;
+}
+
+bool AudioComponent::isUsingProcessingDriver() const
+{
+    return useProcessingDriver;
+}
+
+ProcessingDriver& AudioComponent::getProcessingDriver()
+{
+    return driver;
+}
+
 void AudioComponent::connectToProcessorGraph(AudioProcessorGraph* processorGraph)
 {
 
+    graph = processorGraph;
+
     graphPlayer->setProcessor(processorGraph);
 
 }
@@ -149,6 +212,8 @@ void AudioComponent::connectToProcessorGraph(AudioProcessorGraph* processorGraph
 void AudioComponent::disconnectProcessorGraph()
 {
 
+    graph = nullptr;
+
     graphPlayer->setProcessor(0);
 
 }
@@ -173,7 +238,13 @@ void AudioComponent::stopDevice()
 void AudioComponent::beginCallbacks()
 {
 
-    if (!isPlaying)
+    if (!isPlaying && useProcessingDriver)
+    {
+        std::cout << std::endl << "Starting processing driver thread." << std::endl;
+        driver.start(graph);
+        isPlaying = true;
+    }
+    else if (!isPlaying)
     {
 
         //const MessageManagerLock mmLock;
@@ -246,6 +317,14 @@ void AudioComponent::endCallbacks()
     //     std::cout << "NOT THE MESSAGE THREAD -- AUDIO COMPONENT" << std::endl;
 
 
+    if (useProcessingDriver)
+    {
+        std::cout << std::endl << "Stopping processing driver thread." << std::endl;
+        driver.stop();
+        isPlaying = false;
+        return;
+    }
+
     std::cout << std::endl << "Removing audio callback." << std::endl;
     deviceManager.removeAudioCallback(graphPlayer);
     isPlaying = false;
@@ -281,10 +360,22 @@ void AudioComponent::saveStateToXml(XmlElement* parent)
     parent->setAttribute("sampleRate", setup.sampleRate);
     parent->setAttribute("bufferSize", setup.bufferSize);
     parent->setAttribute("deviceType", deviceManager.getCurrentAudioDeviceType());
+
+    // processing driver thread settings
+    parent->setAttribute("clock", useProcessingDriver ? "thread" : "device");
+    parent->setAttribute("driverBlockSize", driver.getBlockSize());
+    parent->setAttribute("driverPeriodMs", driver.getPeriodMs());
+    parent->setAttribute("driverWait", ProcessingDriver::getWaitStrategyName(driver.getWaitStrategy()));
 }
 
 void AudioComponent::loadStateFromXml(XmlElement* parent)
 {
+    if (!audioDeviceEnabled)
+    {
+        loadDriverStateFromXml(parent);
+        return;
+    }
+
     forEachXmlChildElement(*parent, child)
     {
         if (!child->isTextElement())
@@ -333,4 +424,22 @@ void AudioComponent::loadStateFromXml(XmlElement* parent)
     }
 
     deviceManager.setAudioDeviceSetup(setup, true);
+
+    loadDriverStateFromXml(parent);
+}
+
+void AudioComponent::loadDriverStateFromXml(XmlElement* parent)
+{
+    int driverBlockSize = parent->getIntAttribute("driverBlockSize");
+    if (driverBlockSize > 0)
+        driver.setBlockSize(driverBlockSize);
+
+    double driverPeriodMs = parent->getDoubleAttribute("driverPeriodMs");
+    if (driverPeriodMs > 0)
+        driver.setPeriodMs(driverPeriodMs);
+
+    driver.setWaitStrategy(ProcessingDriver::getWaitStrategyFromName(parent->getStringAttribute("driverWait", "hybrid")));
+
+    if (parent->hasAttribute("clock"))
+        setUseProcessingDriver(parent->getStringAttribute("clock") == "thread");
 }
\ No newline at end of file
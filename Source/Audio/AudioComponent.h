@@ -25,13 +25,15 @@
 #define __AUDIOCOMPONENT_H_D97C73CF__
 
 #include "../../JuceLibraryCode/JuceHeader.h"
+#include "ProcessingDriver.h"
 
 /**
 
   Interfaces with system audio hardware.
 
   Uses the audio card to generate the callbacks to run the ProcessorGraph
-  during data acquisition.
+  during data acquisition, or a ProcessingDriver thread when no audio
+  monitoring is needed (or no audio device is available).
 
   Sends output to the audio card for audio monitoring.
 
@@ -47,8 +49,9 @@ class AudioComponent
 
 public:
     /** Constructor. Finds the audio component (if there is one), and sets the
-    default sample rate and buffer size.*/
-    AudioComponent();
+    default sample rate and buffer size. Without openAudioDevice (headless mode),
+    no device is opened and the processing driver thread is always used.*/
+    AudioComponent(bool openAudioDevice = true);
     ~AudioComponent();
 
     /** Begins the audio callbacks that drive data acquisition.*/
@@ -82,6 +85,20 @@ public:
     /** Returns the buffer size (in ms) currently being used.*/
     int getBufferSizeMs();
 
+    /** Returns the sample rate at which the ProcessorGraph is being clocked.*/
+    double getSampleRate();
+
+    /** Clocks the ProcessorGraph from the processing driver thread instead of the
+    audio device. Audio monitoring is not available in that case. Can only be
+    changed while callbacks are not active.*/
+    void setUseProcessingDriver(bool useDriver);
+
+    /** Returns true if the ProcessorGraph is clocked by the processing driver thread.*/
+    bool isUsingProcessingDriver() const;
+
+    /** Block size, period and wait strategy of the processing driver thread.*/
+    ProcessingDriver& getProcessingDriver();
+
     /** Saves all audio settings that can be loaded to an XML element */
     void saveStateToXml(XmlElement* parent);
 
@@ -92,10 +109,18 @@ public:
 
 private:
 
+    /** Loads the processing driver thread settings */
+    void loadDriverStateFromXml(XmlElement* parent);
+
     bool isPlaying;
 
     ScopedPointer<AudioProcessorPlayer> graphPlayer;
 
+    AudioProcessorGraph* graph;
+    ProcessingDriver driver;
+    bool useProcessingDriver;
+    bool audioDeviceEnabled;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioComponent);
 
 };
@@ -0,0 +1,238 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessingDriver.h"
+
+ProcessingDriver::ProcessingDriver()
+    : Thread("Processing driver")
+    , m_processor(nullptr)
+    , m_blockSize(1024)
+    , m_periodMs(1024 * 1000.0 / 44100.0)
+    , m_waitStrategy(HYBRID_WAIT)
+    , m_freeRunning(false)
+    , m_blockLimit(0)
+{
+}
+
+ProcessingDriver::~ProcessingDriver()
+{
+    stop();
+}
+
+void ProcessingDriver::setBlockSize(int blockSize)
+{
+    jassert(!isThreadRunning());
+    m_blockSize = jmax(1, blockSize);
+}
+
+int ProcessingDriver::getBlockSize() const
+{
+    return m_blockSize;
+}
+
+void ProcessingDriver::setPeriodMs(double periodMs)
+{
+    jassert(!isThreadRunning());
+    m_periodMs = jmax(0.1, periodMs);
+}
+
+double ProcessingDriver::getPeriodMs() const
+{
+    return m_periodMs;
+}
+
+void ProcessingDriver::setWaitStrategy(WaitStrategy strategy)
+{
+    jassert(!isThreadRunning());
+    m_waitStrategy = strategy;
+}
+
+ProcessingDriver::WaitStrategy ProcessingDriver::getWaitStrategy() const
+{
+    return m_waitStrategy;
+}
+
+void ProcessingDriver::setFreeRunning(bool freeRunning)
+{
+    jassert(!isThreadRunning());
+    m_freeRunning = freeRunning;
+}
+
+bool ProcessingDriver::isFreeRunning() const
+{
+    return m_freeRunning;
+}
+
+void ProcessingDriver::setBlockLimit(int64 numBlocks)
+{
+    jassert(!isThreadRunning());
+    m_blockLimit = jmax(int64(0), numBlocks);
+}
+
+void ProcessingDriver::requestEnd()
+{
+    m_endRequested = 1;
+}
+
+double ProcessingDriver::getSampleRate() const
+{
+    return m_blockSize * 1000.0 / m_periodMs;
+}
+
+int ProcessingDriver::getSkippedPeriods() const
+{
+    return m_skippedPeriods.get();
+}
+
+int64 ProcessingDriver::getNumProcessedBlocks() const
+{
+    return m_processedBlocks.get();
+}
+
+void ProcessingDriver::start(AudioProcessor* processor)
+{
+    stop();
+
+    if (processor == nullptr)
+        return;
+
+    m_processor = processor;
+    m_skippedPeriods = 0;
+    m_processedBlocks = 0;
+    m_endRequested = 0;
+
+    m_processor->setPlayConfigDetails(m_processor->getTotalNumInputChannels(),
+                                      m_processor->getTotalNumOutputChannels(),
+                                      getSampleRate(),
+                                      m_blockSize);
+    m_processor->prepareToPlay(getSampleRate(), m_blockSize);
+
+    if (m_freeRunning)
+        std::cout << "Processing driver: " << m_blockSize << " samples per block, free running" << std::endl;
+    else
+        std::cout << "Processing driver: " << m_blockSize << " samples every " << m_periodMs << " ms ("
+                  << getWaitStrategyName(m_waitStrategy) << " wait)" << std::endl;
+
+    startThread(9);
+}
+
+void ProcessingDriver::stop()
+{
+    if (m_processor == nullptr)
+        return;
+
+    stopThread(1000);
+
+    m_processor->releaseResources();
+    m_processor = nullptr;
+
+    if (m_skippedPeriods.get() > 0)
+        std::cout << "Processing driver skipped " << m_skippedPeriods.get() << " periods." << std::endl;
+}
+
+void ProcessingDriver::run()
+{
+    AudioSampleBuffer buffer(jmax(1, m_processor->getTotalNumOutputChannels()), m_blockSize);
+    MidiBuffer midiMessages;
+
+    const double ticksPerPeriod = m_periodMs * Time::getHighResolutionTicksPerSecond() / 1000.0;
+    int64 scheduleStart = Time::getHighResolutionTicks();
+    int64 blockIndex = 0;
+
+    while (!threadShouldExit())
+    {
+        buffer.clear();
+        midiMessages.clear();
+
+        {
+            const ScopedLock sl(m_processor->getCallbackLock());
+            m_processor->processBlock(buffer, midiMessages);
+        }
+
+        if (m_endRequested.get() != 0)
+            break;
+
+        if (++m_processedBlocks == m_blockLimit)
+            break;
+
+        if (m_freeRunning)
+            continue;
+
+        blockIndex++;
+        int64 deadline = scheduleStart + int64(blockIndex * ticksPerPeriod);
+        const int64 now = Time::getHighResolutionTicks();
+
+        if (now - deadline > int64(maxLateBlocks * ticksPerPeriod))
+        {
+            // too far behind to catch up, restart the schedule from here
+            m_skippedPeriods += int((now - deadline) / ticksPerPeriod);
+            scheduleStart = now;
+            blockIndex = 0;
+            continue;
+        }
+
+        waitUntil(deadline);
+    }
+}
+
+void ProcessingDriver::waitUntil(int64 deadlineTicks)
+{
+    const double ticksPerMs = Time::getHighResolutionTicksPerSecond() / 1000.0;
+
+    // the margin left for the spin part of the hybrid wait covers the usual sleep overshoot
+    const double spinMarginMs = (m_waitStrategy == HYBRID_WAIT) ? 2.0 : 0.0;
+
+    if (m_waitStrategy != SPIN_WAIT)
+    {
+        const double remainingMs = (deadlineTicks - Time::getHighResolutionTicks()) / ticksPerMs - spinMarginMs;
+        if (remainingMs >= 1.0)
+            wait(int(remainingMs));
+
+        if (m_waitStrategy == SLEEP_WAIT)
+            return;
+    }
+
+    while (Time::getHighResolutionTicks() < deadlineTicks && !threadShouldExit())
+    {
+    }
+}
+
+String ProcessingDriver::getWaitStrategyName(WaitStrategy strategy)
+{
+    switch (strategy)
+    {
+        case SLEEP_WAIT: return "sleep";
+        case SPIN_WAIT: return "spin";
+        default: return "hybrid";
+    }
+}
+
+ProcessingDriver::WaitStrategy ProcessingDriver::getWaitStrategyFromName(const String& name)
+{
+    if (name.equalsIgnoreCase("sleep"))
+        return SLEEP_WAIT;
+    else if (name.equalsIgnoreCase("spin"))
+        return SPIN_WAIT;
+    else
+        return HYBRID_WAIT;
+}
@@ -0,0 +1,129 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PROCESSINGDRIVER_H_5A1E3C7B__
+#define __PROCESSINGDRIVER_H_5A1E3C7B__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+/**
+
+  Clocks the ProcessorGraph from a dedicated high-priority thread, instead of
+  the audio device callbacks.
+
+  Blocks of blockSize samples are processed every period milliseconds, on an
+  absolute schedule so timing errors don't accumulate. The graph sees a nominal
+  sample rate of blockSize / period, which only matters for audio monitoring.
+  As with the audio device, sources must be able to deliver a period's worth of
+  samples in a block.
+
+  If a block takes longer than its period, the following blocks are processed
+  right away to catch up. Once the driver is more than maxLateBlocks behind, the
+  schedule is restarted from the current time and the skipped periods are counted.
+
+  In free-running mode the blocks are processed back to back, with no schedule,
+  for offline processing of sources that don't depend on the wall clock (such as
+  file playback). The nominal sample rate is the same as in real time.
+
+  @see AudioComponent
+
+*/
+
+class ProcessingDriver : public Thread
+{
+public:
+    /** How the thread waits for the next period */
+    enum WaitStrategy
+    {
+        /** Sleeps until the deadline. Cheapest, but the OS timer resolution adds jitter */
+        SLEEP_WAIT = 0,
+        /** Busy-waits until the deadline. Most precise, but keeps a core busy */
+        SPIN_WAIT,
+        /** Sleeps until shortly before the deadline, then spins */
+        HYBRID_WAIT
+    };
+
+    ProcessingDriver();
+    ~ProcessingDriver();
+
+    /** Settings can only be changed while the driver is stopped */
+    void setBlockSize(int blockSize);
+    int getBlockSize() const;
+
+    void setPeriodMs(double periodMs);
+    double getPeriodMs() const;
+
+    void setWaitStrategy(WaitStrategy strategy);
+    WaitStrategy getWaitStrategy() const;
+
+    /** Processes blocks as fast as possible instead of one per period */
+    void setFreeRunning(bool freeRunning);
+    bool isFreeRunning() const;
+
+    /** Stops processing by itself after numBlocks blocks, 0 for no limit */
+    void setBlockLimit(int64 numBlocks);
+
+    /** Stops processing once the block being processed is done, without counting it. Called by
+        processors, from the processing thread, when their source has no more data */
+    void requestEnd();
+
+    /** Nominal sample rate passed to the processor, blockSize / period */
+    double getSampleRate() const;
+
+    /** Prepares the processor and starts processing blocks */
+    void start(AudioProcessor* processor);
+
+    /** Stops processing and releases the processor's resources */
+    void stop();
+
+    /** Number of periods skipped because processing fell too far behind */
+    int getSkippedPeriods() const;
+
+    /** Number of blocks processed since the driver was started */
+    int64 getNumProcessedBlocks() const;
+
+    void run() override;
+
+    static String getWaitStrategyName(WaitStrategy strategy);
+    static WaitStrategy getWaitStrategyFromName(const String& name);
+
+    static const int maxLateBlocks = 4;
+
+private:
+    void waitUntil(int64 deadlineTicks);
+
+    AudioProcessor* m_processor;
+    int m_blockSize;
+    double m_periodMs;
+    WaitStrategy m_waitStrategy;
+    bool m_freeRunning;
+    int64 m_blockLimit;
+
+    Atomic<int> m_skippedPeriods;
+    Atomic<int64> m_processedBlocks;
+    Atomic<int> m_endRequested;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessingDriver);
+};
+
+#endif  // __PROCESSINGDRIVER_H_5A1E3C7B__
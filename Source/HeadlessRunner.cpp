@@ -0,0 +1,207 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "HeadlessRunner.h"
+#include "AccessClass.h"
+#include "CoreServices.h"
+#include "Audio/AudioComponent.h"
+#include "Processors/ProcessorGraph/ProcessorGraph.h"
+#include "Processors/GenericProcessor/GenericProcessor.h"
+#include "Processors/FileReader/FileReader.h"
+#include "UI/EditorViewport.h"
+
+HeadlessSettings HeadlessSettings::fromCommandLine(const StringArray& args)
+{
+	HeadlessSettings settings;
+
+	for (int i = 0; i < args.size(); i++)
+	{
+		String key = args[i].upToFirstOccurrenceOf("=", false, false).trim().toLowerCase();
+		String value = args[i].fromFirstOccurrenceOf("=", false, false).trim();
+
+		if (key == "config")
+			settings.configFile = File::getCurrentWorkingDirectory().getChildFile(value);
+		else if (key == "seconds")
+			settings.duration = jmax(0.0f, value.getFloatValue());
+		else if (key == "dir")
+			settings.directory = File::getCurrentWorkingDirectory().getChildFile(value);
+		else if (key == "engine")
+			settings.engineID = value.toUpperCase();
+		else if (key == "record")
+			settings.record = value.getIntValue() != 0 || value.equalsIgnoreCase("true");
+		else if (key == "realtime")
+			settings.realTime = value.getIntValue() != 0 || value.equalsIgnoreCase("true");
+		else
+			std::cerr << "Unknown headless option " << args[i] << std::endl;
+	}
+	return settings;
+}
+
+HeadlessRunner::HeadlessRunner(const HeadlessSettings& settings)
+	: m_settings(settings),
+	m_numBlocks(0),
+	m_startTime(0),
+	m_lastProgressTime(0)
+{
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+	stopTimer();
+}
+
+String HeadlessRunner::getLastError() const
+{
+	return m_lastError;
+}
+
+bool HeadlessRunner::start()
+{
+	if (!m_settings.configFile.existsAsFile())
+	{
+		m_lastError = "Configuration file " + m_settings.configFile.getFullPathName() + " not found";
+		return false;
+	}
+
+	String result = AccessClass::getEditorViewport()->loadState(m_settings.configFile);
+	if (!result.startsWith("Opened"))
+	{
+		m_lastError = result;
+		return false;
+	}
+
+	Array<GenericProcessor*> processors = AccessClass::getProcessorGraph()->getListOfProcessors();
+	for (int i = 0; i < processors.size(); i++)
+	{
+		if (FileReader* fileReader = dynamic_cast<FileReader*>(processors[i]))
+			m_fileReaders.add(fileReader);
+	}
+
+	// live sources deliver data at their own rate, so a free running driver would only count empty blocks
+	const bool realTime = m_settings.realTime || m_fileReaders.isEmpty();
+	if (!m_settings.realTime && m_fileReaders.isEmpty())
+		std::cout << "No File Reader in the signal chain, running in real time" << std::endl;
+
+	// only offline file playback ends by itself
+	if (m_settings.duration <= 0 && realTime)
+	{
+		m_lastError = "No duration set, and no File Reader to play offline";
+		return false;
+	}
+
+	// the configuration may have selected the audio device, which a headless window doesn't open
+	AudioComponent* audio = AccessClass::getAudioComponent();
+	audio->setUseProcessingDriver(true);
+
+	ProcessingDriver& driver = audio->getProcessingDriver();
+	driver.setFreeRunning(!realTime);
+	m_numBlocks = (m_settings.duration > 0) ? int64(std::ceil(m_settings.duration * 1000.0 / driver.getPeriodMs())) : 0;
+	driver.setBlockLimit(m_numBlocks);
+
+	if (m_settings.directory != File())
+	{
+		m_settings.directory.createDirectory();
+		CoreServices::setRecordingDirectory(m_settings.directory.getFullPathName());
+	}
+
+	if (m_settings.engineID.isNotEmpty() && !CoreServices::setSelectedRecordEngineId(m_settings.engineID))
+	{
+		m_lastError = "Unknown record engine " + m_settings.engineID;
+		return false;
+	}
+
+	m_startTime = Time::getMillisecondCounter();
+	m_lastProgressTime = m_startTime;
+
+	if (m_settings.record)
+		CoreServices::setRecordingStatus(true);
+	else
+		CoreServices::setAcquisitionStatus(true);
+
+	if (!CoreServices::getAcquisitionStatus())
+	{
+		CoreServices::setRecordingStatus(false);
+		m_lastError = "Could not start acquisition, check the signal chain";
+		return false;
+	}
+
+	startTimer(100);
+	return true;
+}
+
+void HeadlessRunner::timerCallback()
+{
+	const ProcessingDriver& driver = AccessClass::getAudioComponent()->getProcessingDriver();
+
+	// File Readers stop acquisition when they reach the end of their file
+	if ((m_numBlocks > 0 && driver.getNumProcessedBlocks() >= m_numBlocks) || !driver.isThreadRunning())
+	{
+		finish();
+		return;
+	}
+
+	if (Time::getMillisecondCounter() - m_lastProgressTime >= 1000)
+	{
+		m_lastProgressTime = Time::getMillisecondCounter();
+		printProgress();
+	}
+}
+
+void HeadlessRunner::printProgress()
+{
+	const ProcessingDriver& driver = AccessClass::getAudioComponent()->getProcessingDriver();
+	std::cout << "Processed " << driver.getNumProcessedBlocks() * driver.getPeriodMs() / 1000.0 << " s";
+
+	for (int i = 0; i < m_fileReaders.size(); i++)
+	{
+		std::cout << ", " << m_fileReaders[i]->getName() << " (" << m_fileReaders[i]->getNodeId() << ") "
+			<< String(m_fileReaders[i]->getPlaybackProgress() * 100.0f, 1) << "%";
+	}
+	std::cout << std::endl;
+}
+
+void HeadlessRunner::finish()
+{
+	stopTimer();
+
+	const ProcessingDriver& driver = AccessClass::getAudioComponent()->getProcessingDriver();
+	const double signalSeconds = driver.getNumProcessedBlocks() * driver.getPeriodMs() / 1000.0;
+	const double elapsedSeconds = (Time::getMillisecondCounter() - m_startTime) / 1000.0;
+
+	CoreServices::setAcquisitionStatus(false);
+
+	std::cout << std::endl << "Processed " << signalSeconds << " s of data in " << elapsedSeconds << " s ("
+		<< signalSeconds / jmax(0.001, elapsedSeconds) << "x real time)" << std::endl;
+
+	ProcessorGraph* graph = AccessClass::getProcessorGraph();
+	std::cout << "Graph callback:" << std::endl << graph->getCallbackProfile().getStatistics().toString() << std::endl;
+
+	Array<GenericProcessor*> processors = graph->getListOfProcessors();
+	for (int i = 0; i < processors.size(); i++)
+	{
+		std::cout << processors[i]->getName() << " (" << processors[i]->getNodeId() << "):" << std::endl
+			<< processors[i]->getProcessingProfile().getStatistics().toString() << std::endl;
+	}
+
+	JUCEApplication::getInstance()->systemRequestedQuit();
+}
@@ -0,0 +1,90 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef HEADLESSRUNNER_H_INCLUDED
+#define HEADLESSRUNNER_H_INCLUDED
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+class FileReader;
+
+/** Settings for a headless run. Can be filled from key=value command line arguments:
+	config=settings.xml seconds=60 dir=/path engine=RAWBINARY record=1 realtime=0
+	seconds is the length of data to process, in signal time, not wall clock time. Without it,
+	the run lasts until the File Readers of the signal chain reach the end of their file.
+	dir and engine override the recording directory and record engine of the configuration.
+	realtime=1 keeps the processing driver period, otherwise blocks are processed as fast
+	as the signal chain can. That only makes sense for sources such as the FileReader, so
+	chains without a File Reader always run in real time. */
+struct HeadlessSettings
+{
+	File configFile;
+	float duration{ 0.0f };
+	File directory;
+	String engineID;
+	bool record{ true };
+	bool realTime{ false };
+
+	static HeadlessSettings fromCommandLine(const StringArray& args);
+};
+
+/**
+Runs a saved signal chain without a window, for batch processing.
+
+Loads the configuration into a headless MainWindow, clocks the graph with the
+processing driver thread, records (optionally) for the requested duration or until
+offline file playback ends, then stops acquisition, prints the processing statistics
+and quits the application. The File Reader progress is printed every second.
+
+The processors still get their editors, since many of them keep their settings
+there, but the editors are never shown.
+
+@see MainWindow, ProcessingDriver
+*/
+class HeadlessRunner : private Timer
+{
+public:
+	HeadlessRunner(const HeadlessSettings& settings);
+	~HeadlessRunner();
+
+	/** Loads the configuration and starts acquisition. Returns false if it could not be started */
+	bool start();
+
+	String getLastError() const;
+
+private:
+	void timerCallback() override;
+	void finish();
+	void printProgress();
+
+	const HeadlessSettings m_settings;
+	int64 m_numBlocks;
+	uint32 m_startTime;
+	uint32 m_lastProgressTime;
+	Array<FileReader*> m_fileReaders;
+	String m_lastError;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessRunner);
+};
+
+#endif  // HEADLESSRUNNER_H_INCLUDED
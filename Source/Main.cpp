@@ -27,6 +27,8 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainWindow.h"
 #include "UI/LookAndFeel/CustomLookAndFeel.h"
+#include "Processors/RecordNode/RecordBenchmark.h"
+#include "HeadlessRunner.h"
 
 #include <stdio.h>
 #include <fstream>
@@ -84,12 +86,48 @@ public:
 
 #endif
 
+        // --processing-threads N processes independent signal chain branches on N extra threads.
+        // Taken out first, since the options of the modes below run to the end of the command line
+        int processingThreads = 0;
+        int threadsArg = parameters.indexOf("--processing-threads", true);
+        if (threadsArg != -1)
+        {
+            processingThreads = parameters[threadsArg + 1].getIntValue();
+            parameters.removeRange(threadsArg, 2);
+        }
+
+        // --benchmark-recording [options] runs the recording benchmark and quits.
+        // All the arguments after it are benchmark options (see RecordBenchmarkSettings)
+        StringArray benchmarkOptions;
+        int benchmarkArg = parameters.indexOf("--benchmark-recording", true);
+        if (benchmarkArg != -1)
+        {
+            for (int i = benchmarkArg + 1; i < parameters.size(); i++)
+                benchmarkOptions.add(parameters[i]);
+            parameters.removeRange(benchmarkArg, parameters.size() - benchmarkArg);
+        }
+
+        // --headless [options] runs a saved signal chain without a window and quits.
+        // All the arguments after it are headless options (see HeadlessSettings)
+        StringArray headlessOptions;
+        int headlessArg = parameters.indexOf("--headless", true);
+        if (headlessArg != -1)
+        {
+            for (int i = headlessArg + 1; i < parameters.size(); i++)
+                headlessOptions.add(parameters[i]);
+            parameters.removeRange(headlessArg, parameters.size() - headlessArg);
+        }
+
         customLookAndFeel = new CustomLookAndFeel();
         LookAndFeel::setDefaultLookAndFeel(customLookAndFeel);
 
 
-        // signal chain to load
-        if (!parameters.isEmpty())
+        // signal chain to load. The benchmark only needs the processor graph, so it doesn't open a window either
+        if (headlessArg != -1 || benchmarkArg != -1)
+        {
+            mainWindow = new MainWindow(File(), true);
+        }
+        else if (!parameters.isEmpty())
         {
             File fileToLoad(File::getCurrentWorkingDirectory().getChildFile(parameters[0]));
             mainWindow = new MainWindow(fileToLoad);
@@ -98,6 +136,14 @@ public:
         {
             mainWindow = new MainWindow();
         }
+
+        if (processingThreads > 0)
+            AccessClass::getProcessorGraph()->setNumProcessingThreads(processingThreads);
+
+        if (benchmarkArg != -1)
+            runRecordBenchmark(benchmarkOptions);
+        else if (headlessArg != -1)
+            runHeadless(headlessOptions);
     }
 
     void shutdown() { }
@@ -127,7 +173,41 @@ public:
     {}
 
 private:
+    void runRecordBenchmark(const StringArray& options)
+    {
+        RecordBenchmarkSettings settings = RecordBenchmarkSettings::fromCommandLine(options);
+        std::cout << "Recording benchmark: " << settings.engineID << ", " << settings.numChannels << " channels at "
+                  << settings.sampleRate << " Hz for " << settings.duration << " s" << std::endl;
+
+        RecordBenchmark benchmark(settings);
+        RecordBenchmarkResults results;
+        if (benchmark.run(results))
+        {
+            std::cout << results.toString() << std::endl;
+            if (results.queues.hasDroppedData())
+                setApplicationReturnValue(2);
+        }
+        else
+        {
+            std::cerr << "Recording benchmark failed: " << benchmark.getLastError() << std::endl;
+            setApplicationReturnValue(1);
+        }
+        systemRequestedQuit();
+    }
+
+    void runHeadless(const StringArray& options)
+    {
+        headlessRunner = new HeadlessRunner(HeadlessSettings::fromCommandLine(options));
+        if (!headlessRunner->start())
+        {
+            std::cerr << "Headless run failed: " << headlessRunner->getLastError() << std::endl;
+            setApplicationReturnValue(1);
+            systemRequestedQuit();
+        }
+    }
+
     ScopedPointer <MainWindow> mainWindow;
+    ScopedPointer <HeadlessRunner> headlessRunner;
     ScopedPointer <CustomLookAndFeel> customLookAndFeel;
     std::ofstream console_out;
 };
@@ -39,10 +39,12 @@ static inline File getSavedStateDirectory() {
 #endif
 }
 
-	MainWindow::MainWindow(const File& fileToLoad)
+	MainWindow::MainWindow(const File& fileToLoad, bool headless_)
 : DocumentWindow(JUCEApplication::getInstance()->getApplicationName(),
 		Colour(Colours::black),
-		DocumentWindow::allButtons)
+		DocumentWindow::allButtons,
+		!headless_),
+	headless(headless_)
 {
 
 	setResizable(true,      // isResizable
@@ -58,7 +60,7 @@ static inline File getSavedStateDirectory() {
 	std::cout << "Created processor graph." << std::endl;
 	std::cout << std::endl;
 
-	audioComponent = new AudioComponent();
+	audioComponent = new AudioComponent(!headless);
 	std::cout << "Created audio component." << std::endl;
 
 	audioComponent->connectToProcessorGraph(processorGraph);
@@ -74,14 +76,21 @@ static inline File getSavedStateDirectory() {
 
 	addKeyListener(commandManager.getKeyMappings());
 
-	loadWindowBounds();
-	setUsingNativeTitleBar(true);
-	Component::addToDesktop(getDesktopWindowStyleFlags());  // prevents the maximize
-	// button from randomly disappearing
-	setVisible(true);
-
-	// Constraining the window's size doesn't seem to work:
-	setResizeLimits(500, 500, 10000, 10000);
+	if (headless)
+	{
+		std::cout << "Running headless." << std::endl;
+	}
+	else
+	{
+		loadWindowBounds();
+		setUsingNativeTitleBar(true);
+		Component::addToDesktop(getDesktopWindowStyleFlags());  // prevents the maximize
+		// button from randomly disappearing
+		setVisible(true);
+
+		// Constraining the window's size doesn't seem to work:
+		setResizeLimits(500, 500, 10000, 10000);
+	}
 
     if (!fileToLoad.getFullPathName().isEmpty())
     {
@@ -106,14 +115,19 @@ MainWindow::~MainWindow()
 		processorGraph->disableProcessors();
 	}
 
-	saveWindowBounds();
+	// a headless run leaves the interactive settings untouched
+	if (!headless)
+		saveWindowBounds();
 
 	audioComponent->disconnectProcessorGraph();
 	UIComponent* ui = (UIComponent*) getContentComponent();
 	ui->disableDataViewport();
 
-	File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
-	ui->getEditorViewport()->saveState(file);
+	if (!headless)
+	{
+		File file = getSavedStateDirectory().getChildFile("lastConfig.xml");
+		ui->getEditorViewport()->saveState(file);
+	}
 
 	setMenuBar(0);
 
@@ -140,6 +154,11 @@ void MainWindow::shutDownGUI()
 	processorGraph->disableProcessors();
 }
 
+bool MainWindow::isHeadless() const
+{
+	return headless;
+}
+
 void MainWindow::saveWindowBounds()
 {
 	std::cout << std::endl;
@@ -45,8 +45,11 @@ class MainWindow   : public DocumentWindow
 public:
 
     /** Initializes the MainWindow, creates the AudioComponent, ProcessorGraph,
-        and UIComponent, and sets the window boundaries. */
-    MainWindow(const File& fileToLoad = File());
+        and UIComponent, and sets the window boundaries.
+
+        A headless window is never put on the desktop and doesn't open the audio
+        device, so a signal chain can run without a display (see HeadlessRunner). */
+    MainWindow(const File& fileToLoad = File(), bool headless = false);
 
     /** Destroys the AudioComponent, ProcessorGraph, and UIComponent, and saves the window boundaries. */
     ~MainWindow();
@@ -64,6 +67,9 @@ public:
 
 	void shutDownGUI();
 
+    /** Returns true if the window was created without being put on the desktop. */
+    bool isHeadless() const;
+
 private:
 
     /** Saves the MainWindow's boundaries into the file "windowState.xml", located in the directory
@@ -80,6 +86,7 @@ private:
     /** A pointer to the application's ProcessorGraph (owned by the MainWindow). */
     ScopedPointer<ProcessorGraph> processorGraph;
 
+    bool headless;
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
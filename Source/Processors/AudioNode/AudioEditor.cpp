@@ -24,6 +24,7 @@
 #include "AudioEditor.h"
 #include "../../Audio/AudioComponent.h"
 #include "../../AccessClass.h"
+#include "../../CoreServices.h"
 #include "../../UI/LookAndFeel/MaterialSliderLookAndFeel.h"
 
 
@@ -217,7 +218,7 @@ void AudioEditor::buttonClicked (Button* button)
         {
             if (! audioConfigurationWindow)
             {
-                audioConfigurationWindow = new AudioConfigurationWindow (AccessClass::getAudioComponent()->deviceManager,
+                audioConfigurationWindow = new AudioConfigurationWindow (AccessClass::getAudioComponent(),
                                                                          audioWindowButton);
                 audioConfigurationWindow->addComponentListener(this);
             }
@@ -286,20 +287,140 @@ void AudioEditor::loadStateFromXml (XmlElement* xml)
 }
 
 
-AudioConfigurationWindow::AudioConfigurationWindow (AudioDeviceManager& adm, AudioWindowButton* cButton)
+ProcessingClockComponent::ProcessingClockComponent (AudioComponent* ac, Component* selector)
+    : audioComponent (ac)
+    , deviceSelector (selector)
+{
+    clockSelector = new ComboBox ("Clock");
+    clockSelector->setBounds (100, 10, 200, 20);
+    clockSelector->addItem ("Audio device", 1);
+    clockSelector->addItem ("Processing thread", 2);
+    clockSelector->addListener (this);
+    clockSelector->setTooltip ("The processing thread runs without an audio device, but there is no audio monitoring");
+    addAndMakeVisible (clockSelector);
+
+    blockSizeValue = createValueLabel ("Block size", 100, 38, "Samples processed in each block by the processing thread");
+    periodValue    = createValueLabel ("Period",     100, 62, "Time between blocks of the processing thread, in ms");
+
+    sampleRateLabel = new Label ("Sample rate", "");
+    sampleRateLabel->setBounds (180, 62, 170, 20);
+    sampleRateLabel->setFont (Font ("Small Text", 12, Font::plain));
+    sampleRateLabel->setColour (Label::textColourId, Colours::lightgrey);
+    addAndMakeVisible (sampleRateLabel);
+
+    updateFromAudioComponent();
+}
+
+
+ProcessingClockComponent::~ProcessingClockComponent()
+{
+}
+
+
+Label* ProcessingClockComponent::createValueLabel (const String& name, int x, int y, const String& tooltip)
+{
+    Label* label = new Label (name, "");
+    label->setBounds (x, y, 70, 20);
+    label->setFont (Font ("Default", 15, Font::plain));
+    label->setColour (Label::textColourId,       Colours::white);
+    label->setColour (Label::backgroundColourId, Colours::grey);
+    label->setEditable (true);
+    label->addListener (this);
+    label->setTooltip (tooltip);
+    addAndMakeVisible (label);
+
+    return label;
+}
+
+
+void ProcessingClockComponent::updateFromAudioComponent()
+{
+    const bool useDriver = audioComponent->isUsingProcessingDriver();
+    ProcessingDriver& driver = audioComponent->getProcessingDriver();
+
+    clockSelector->setSelectedId (useDriver ? 2 : 1, dontSendNotification);
+    clockSelector->setEnabled (audioComponent->deviceManager.getCurrentAudioDevice() != nullptr);
+
+    blockSizeValue->setText (String (driver.getBlockSize()), dontSendNotification);
+    periodValue->setText (String (driver.getPeriodMs(), 2), dontSendNotification);
+    blockSizeValue->setEnabled (useDriver);
+    periodValue->setEnabled (useDriver);
+
+    sampleRateLabel->setText ("ms  (" + String (driver.getSampleRate(), 1) + " Hz)", dontSendNotification);
+
+    // the device settings don't apply while the thread clocks the graph
+    if (deviceSelector != nullptr)
+        deviceSelector->setEnabled (! useDriver);
+}
+
+
+void ProcessingClockComponent::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == clockSelector)
+        audioComponent->setUseProcessingDriver (clockSelector->getSelectedId() == 2);
+
+    updateFromAudioComponent();
+}
+
+
+void ProcessingClockComponent::labelTextChanged (Label* label)
+{
+    ProcessingDriver& driver = audioComponent->getProcessingDriver();
+
+    if (audioComponent->callbacksAreActive())
+    {
+        CoreServices::sendStatusMessage ("Can't change the processing clock while acquisition is active.");
+    }
+    else if (label == blockSizeValue)
+    {
+        const int blockSize = label->getText().getIntValue();
+
+        if (blockSize > 0)
+            driver.setBlockSize (blockSize);
+        else
+            CoreServices::sendStatusMessage ("Value out of range.");
+    }
+    else if (label == periodValue)
+    {
+        const double periodMs = label->getText().getDoubleValue();
+
+        if (periodMs > 0)
+            driver.setPeriodMs (periodMs);
+        else
+            CoreServices::sendStatusMessage ("Value out of range.");
+    }
+
+    updateFromAudioComponent();
+}
+
+
+void ProcessingClockComponent::paint (Graphics& g)
+{
+    g.setColour (Colours::lightgrey);
+    g.setFont (Font ("Small Text", 12, Font::plain));
+    g.drawSingleLineText ("Clock:",      10, 25);
+    g.drawSingleLineText ("Block size:", 10, 53);
+    g.drawSingleLineText ("samples",     180, 53);
+    g.drawSingleLineText ("Period:",     10, 77);
+}
+
+
+AudioConfigurationWindow::AudioConfigurationWindow (AudioComponent* audioComponent, AudioWindowButton* cButton)
     : DocumentWindow ("Audio Settings",
                       Colours::red,
                       DocumentWindow::closeButton)
     , controlButton (cButton)
 
 {
-    centreWithSize (360,500);
+    centreWithSize (360,590);
     setUsingNativeTitleBar (true);
     setResizable (false,false);
 
+    AudioDeviceManager& adm = audioComponent->deviceManager;
+
     //std::cout << "Audio CPU usage:" << adm.getCpuUsage() << std::endl;
 
-    AudioDeviceSelectorComponent* adsc = new AudioDeviceSelectorComponent
+    deviceSelector = new AudioDeviceSelectorComponent
         (adm,
          0, // minAudioInputChannels
          2, // maxAudioInputChannels
@@ -310,9 +431,18 @@ AudioConfigurationWindow::AudioConfigurationWindow (AudioDeviceManager& adm, Aud
          false, // showChannelsAsStereoPairs
          false); // hideAdvancedOptionsWithButton
 
-    adsc->setBounds (0, 0, 450, 440);
+    deviceSelector->setBounds (0, 90, 450, 440);
+
+    clockComponent = new ProcessingClockComponent (audioComponent, deviceSelector);
+    clockComponent->setBounds (0, 0, 360, 90);
+
+    // the window owns both, the content only lays them out
+    Component* content = new Component ("Audio Settings");
+    content->setSize (450, 530);
+    content->addAndMakeVisible (clockComponent);
+    content->addAndMakeVisible (deviceSelector);
 
-    setContentOwned (adsc, true);
+    setContentOwned (content, true);
     setVisible (false);
 }
 
@@ -68,6 +68,44 @@ private:
 };
 
 
+/**
+  Selects what clocks the ProcessorGraph: the audio device, or the
+  ProcessingDriver thread when no audio monitoring is needed, and sets the
+  block size and period of the driver.
+
+  @see AudioComponent, AudioConfigurationWindow
+
+*/
+class ProcessingClockComponent : public Component
+                               , public ComboBox::Listener
+                               , public Label::Listener
+{
+public:
+    ProcessingClockComponent (AudioComponent* audioComponent, Component* deviceSelector);
+    ~ProcessingClockComponent();
+
+    void paint (Graphics& g)    override;
+
+    void comboBoxChanged (ComboBox* comboBox)   override;
+    void labelTextChanged (Label* label)        override;
+
+
+private:
+    /** Shows the settings of the AudioComponent, which may have refused or adjusted the requested ones */
+    void updateFromAudioComponent();
+
+    Label* createValueLabel (const String& name, int x, int y, const String& tooltip);
+
+    AudioComponent* audioComponent;
+    Component* deviceSelector;
+
+    ScopedPointer<ComboBox> clockSelector;
+    ScopedPointer<Label>    blockSizeValue;
+    ScopedPointer<Label>    periodValue;
+    ScopedPointer<Label>    sampleRateLabel;
+};
+
+
 /**
   Allows the user to access audio output settings.
 
@@ -77,7 +115,7 @@ private:
 class AudioConfigurationWindow : public DocumentWindow
 {
 public:
-    AudioConfigurationWindow (AudioDeviceManager& adm, AudioWindowButton* b);
+    AudioConfigurationWindow (AudioComponent* audioComponent, AudioWindowButton* b);
     ~AudioConfigurationWindow();
 
     void paint (Graphics& g)    override;
@@ -88,6 +126,9 @@ private:
     void closeButtonPressed();
 
     AudioWindowButton* controlButton;
+
+    ScopedPointer<AudioDeviceSelectorComponent> deviceSelector;
+    ScopedPointer<ProcessingClockComponent>     clockComponent;
 };
 
 /**
@@ -22,6 +22,11 @@
 
 #include "DataBuffer.h"
 
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+ #define DATABUFFER_USE_SSE 1
+#endif
+
 
 DataBuffer::DataBuffer (int chans, int size)
     : abstractFifo  (size)
@@ -106,6 +111,120 @@ int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes,
 }
 
 
+int DataBuffer::addInterleavedBlock (const float* data, const int64* timestamps, const uint64* eventCodes, int numItems)
+{
+    int startIndex1, blockSize1, startIndex2, blockSize2;
+
+    abstractFifo.prepareToWrite (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+
+    if (numItems > 0)
+        lastTimestamp = timestamps[numItems - 1];
+
+    if (blockSize1 > 0)
+    {
+        deinterleave (data, startIndex1, blockSize1);
+        copyTimestampsAndEvents (timestamps, eventCodes, startIndex1, blockSize1);
+    }
+
+    if (blockSize2 > 0)
+    {
+        deinterleave (data + blockSize1 * numChans, startIndex2, blockSize2);
+        copyTimestampsAndEvents (timestamps + blockSize1, eventCodes + blockSize1, startIndex2, blockSize2);
+    }
+
+    abstractFifo.finishedWrite (blockSize1 + blockSize2);
+
+    return blockSize1 + blockSize2;
+}
+
+
+int DataBuffer::addPlanarBlock (const float* const* data, const int64* timestamps, const uint64* eventCodes, int numItems)
+{
+    int startIndex1, blockSize1, startIndex2, blockSize2;
+
+    abstractFifo.prepareToWrite (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+
+    if (numItems > 0)
+        lastTimestamp = timestamps[numItems - 1];
+
+    for (int chan = 0; chan < numChans; ++chan)
+    {
+        if (blockSize1 > 0)
+            buffer.copyFrom (chan, startIndex1, data[chan], blockSize1);
+
+        if (blockSize2 > 0)
+            buffer.copyFrom (chan, startIndex2, data[chan] + blockSize1, blockSize2);
+    }
+
+    if (blockSize1 > 0)
+        copyTimestampsAndEvents (timestamps, eventCodes, startIndex1, blockSize1);
+
+    if (blockSize2 > 0)
+        copyTimestampsAndEvents (timestamps + blockSize1, eventCodes + blockSize1, startIndex2, blockSize2);
+
+    abstractFifo.finishedWrite (blockSize1 + blockSize2);
+
+    return blockSize1 + blockSize2;
+}
+
+
+void DataBuffer::deinterleave (const float* source, int destStartSample, int numSamples)
+{
+    int chan = 0;
+
+   #if DATABUFFER_USE_SSE
+    // Transpose 4x4 tiles, moving four channels at a time
+    for (; chan + 4 <= numChans; chan += 4)
+    {
+        float* dest0 = buffer.getWritePointer (chan,     destStartSample);
+        float* dest1 = buffer.getWritePointer (chan + 1, destStartSample);
+        float* dest2 = buffer.getWritePointer (chan + 2, destStartSample);
+        float* dest3 = buffer.getWritePointer (chan + 3, destStartSample);
+        const float* src = source + chan;
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 row0 = _mm_loadu_ps (src + i * numChans);
+            __m128 row1 = _mm_loadu_ps (src + (i + 1) * numChans);
+            __m128 row2 = _mm_loadu_ps (src + (i + 2) * numChans);
+            __m128 row3 = _mm_loadu_ps (src + (i + 3) * numChans);
+            _MM_TRANSPOSE4_PS (row0, row1, row2, row3);
+            _mm_storeu_ps (dest0 + i, row0);
+            _mm_storeu_ps (dest1 + i, row1);
+            _mm_storeu_ps (dest2 + i, row2);
+            _mm_storeu_ps (dest3 + i, row3);
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            const float* sample = src + i * numChans;
+            dest0[i] = sample[0];
+            dest1[i] = sample[1];
+            dest2[i] = sample[2];
+            dest3[i] = sample[3];
+        }
+    }
+   #endif
+
+    for (; chan < numChans; ++chan)
+    {
+        float* dest = buffer.getWritePointer (chan, destStartSample);
+        const float* src = source + chan;
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = src[i * numChans];
+    }
+}
+
+
+void DataBuffer::copyTimestampsAndEvents (const int64* timestamps, const uint64* eventCodes, int destStartSample, int numSamples)
+{
+    memcpy (timestampBuffer + destStartSample, timestamps, numSamples * sizeof (int64));
+    memcpy (eventCodeBuffer + destStartSample, eventCodes, numSamples * sizeof (uint64));
+}
+
+
 int DataBuffer::getNumSamples() const { return abstractFifo.getNumReady(); }
 
 
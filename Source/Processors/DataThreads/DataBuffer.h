@@ -55,6 +55,33 @@ public:
     */
     int addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize=1);
 
+    /** Add a whole block of interleaved samples to the buffer in a single write operation.
+        Preferred over calling addToBuffer once per sample, as sources can publish entire
+        device frames at once.
+
+        @param data The data, with all the channels of each sample stored consecutively
+        (numChannels * numItems floats).
+        @param timestamps Array of timestamps. Same length as numItems.
+        @param eventCodes Array of event codes. Same length as numItems.
+        @param numItems Total number of samples per channel.
+
+        @return The number of items actually written. May be less than numItems if
+        the buffer doesn't have space.
+    */
+    int addInterleavedBlock (const float* data, const int64* timestamps, const uint64* eventCodes, int numItems);
+
+    /** Add a whole block of planar samples to the buffer in a single write operation.
+
+        @param data Array of numChannels pointers, each one pointing to numItems samples of a channel.
+        @param timestamps Array of timestamps. Same length as numItems.
+        @param eventCodes Array of event codes. Same length as numItems.
+        @param numItems Total number of samples per channel.
+
+        @return The number of items actually written. May be less than numItems if
+        the buffer doesn't have space.
+    */
+    int addPlanarBlock (const float* const* data, const int64* timestamps, const uint64* eventCodes, int numItems);
+
     /** Returns the number of samples currently available in the buffer.*/
     int getNumSamples() const;
 
@@ -66,6 +93,9 @@ public:
 
 
 private:
+    void deinterleave (const float* source, int destStartSample, int numSamples);
+    void copyTimestampsAndEvents (const int64* timestamps, const uint64* eventCodes, int destStartSample, int numSamples);
+
     AbstractFifo abstractFifo;
     AudioSampleBuffer buffer;
 
@@ -111,6 +111,12 @@ public:
         return m_stageArray[index];
     }
 
+    const Stage& operator[](int index) const
+    {
+        assert(index >= 0 && index < m_numStages);
+        return m_stageArray[index];
+    }
+
 public:
     // Calculate filter response at the given normalized frequency.
     complex_t response(double normalizedFrequency) const;
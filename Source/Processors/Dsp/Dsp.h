@@ -45,6 +45,8 @@ THE SOFTWARE.
 #include "Biquad.h"
 #include "Cascade.h"
 #include "Filter.h"
+#include "InterleavedCascade.h"
+#include "OverlapSave.h"
 #include "PoleFilter.h"
 #include "SmoothedFilter.h"
 #include "State.h"
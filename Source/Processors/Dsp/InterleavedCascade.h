@@ -0,0 +1,223 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_INTERLEAVEDCASCADE_H
+#define DSPFILTERS_INTERLEAVEDCASCADE_H
+
+#include <algorithm>
+
+#include "Common.h"
+#include "Cascade.h"
+#include "MathSupplement.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define DSPFILTERS_USE_SSE 1
+#endif
+
+namespace Dsp
+{
+
+/*
+ * State for running one cascade over several channels at once, for channels
+ * that share the same coefficients.
+ *
+ * The Direct Form II state of Lanes channels is interleaved, so each second
+ * order section updates the lanes two at a time with SSE2 where available.
+ * Samples are copied to an interleaved buffer in chunks and run through the
+ * sections one at a time, which keeps the coefficients and the state in
+ * registers. Lanes must be even.
+ *
+ * The arithmetic is the same as Cascade::process with a DirectFormII state
+ * per channel, and so is the output.
+ *
+ */
+template <int MaxStages, int Lanes = 8>
+class InterleavedCascadeState : private DenormalPrevention
+{
+public:
+    enum
+    {
+        numLanes = Lanes,
+        chunkSize = 64,
+        laneStateSize = 2 * MaxStages
+    };
+
+    InterleavedCascadeState()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(&m_v1[0][0], &m_v1[0][0] + MaxStages * Lanes, 0.);
+        std::fill(&m_v2[0][0], &m_v2[0][0] + MaxStages * Lanes, 0.);
+    }
+
+    // Copy the state of one lane, laneStateSize values, to move a channel between states
+    void getLaneState(int lane, double* state) const
+    {
+        for (int i = 0; i < MaxStages; ++i)
+        {
+            *state++ = m_v1[i][lane];
+            *state++ = m_v2[i][lane];
+        }
+    }
+
+    void setLaneState(int lane, const double* state)
+    {
+        for (int i = 0; i < MaxStages; ++i)
+        {
+            m_v1[i][lane] = *state++;
+            m_v2[i][lane] = *state++;
+        }
+    }
+
+    // Process numChannels (up to Lanes) channels in place. The lanes past
+    // numChannels run on silence.
+    template <typename Sample>
+    void process(const Cascade& cascade, int numSamples,
+                 Sample* const* destChannelArray, int numChannels)
+    {
+        assert(numChannels <= Lanes && Lanes % 2 == 0);
+        assert(cascade.getNumStages() <= MaxStages);
+
+        double block[chunkSize * Lanes];
+        double vsa[chunkSize];
+        const double none[chunkSize] = {};
+
+        for (int offset = 0; offset < numSamples; offset += chunkSize)
+        {
+            const int n = std::min(int(chunkSize), numSamples - offset);
+
+            for (int c = 0; c < Lanes; ++c)
+            {
+                const Sample* src = (c < numChannels) ? destChannelArray[c] + offset : 0;
+                for (int i = 0; i < n; ++i)
+                    block[i * Lanes + c] = src ? src[i] : 0.;
+            }
+
+            // the scalar states add the same alternating amount at the first section
+            for (int i = 0; i < n; ++i)
+                vsa[i] = ac();
+
+            for (int s = 0; s < cascade.getNumStages(); ++s)
+                processStage(cascade[s], n, block, m_v1[s], m_v2[s], (s == 0) ? vsa : none);
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                Sample* dest = destChannelArray[c] + offset;
+                for (int i = 0; i < n; ++i)
+                    dest[i] = static_cast<Sample>(block[i * Lanes + c]);
+            }
+        }
+    }
+
+private:
+    static void processStage(const BiquadBase& s, int numSamples, double* block,
+                             double* stateV1, double* stateV2, const double* vsa)
+    {
+#if DSPFILTERS_USE_SSE
+        const __m128d a1 = _mm_set1_pd(s.m_a1);
+        const __m128d a2 = _mm_set1_pd(s.m_a2);
+        const __m128d b0 = _mm_set1_pd(s.m_b0);
+        const __m128d b1 = _mm_set1_pd(s.m_b1);
+        const __m128d b2 = _mm_set1_pd(s.m_b2);
+
+        // local copies the compiler can keep in registers across the samples
+        __m128d v1[Lanes / 2];
+        __m128d v2[Lanes / 2];
+        for (int l = 0; l < Lanes / 2; ++l)
+        {
+            v1[l] = _mm_loadu_pd(stateV1 + 2 * l);
+            v2[l] = _mm_loadu_pd(stateV2 + 2 * l);
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double* x = block + i * Lanes;
+            const __m128d dc = _mm_set1_pd(vsa[i]);
+
+            for (int l = 0; l < Lanes / 2; ++l)
+            {
+                const __m128d w = _mm_add_pd(_mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(x + 2 * l),
+                                                                   _mm_mul_pd(a1, v1[l])),
+                                                        _mm_mul_pd(a2, v2[l])),
+                                             dc);
+                _mm_storeu_pd(x + 2 * l, _mm_add_pd(_mm_add_pd(_mm_mul_pd(b0, w),
+                                                               _mm_mul_pd(b1, v1[l])),
+                                                    _mm_mul_pd(b2, v2[l])));
+                v2[l] = v1[l];
+                v1[l] = w;
+            }
+        }
+
+        for (int l = 0; l < Lanes / 2; ++l)
+        {
+            _mm_storeu_pd(stateV1 + 2 * l, v1[l]);
+            _mm_storeu_pd(stateV2 + 2 * l, v2[l]);
+        }
+#else
+        const double a1 = s.m_a1;
+        const double a2 = s.m_a2;
+        const double b0 = s.m_b0;
+        const double b1 = s.m_b1;
+        const double b2 = s.m_b2;
+
+        double v1[Lanes];
+        double v2[Lanes];
+        for (int l = 0; l < Lanes; ++l)
+        {
+            v1[l] = stateV1[l];
+            v2[l] = stateV2[l];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double* x = block + i * Lanes;
+            const double dc = vsa[i];
+
+            for (int l = 0; l < Lanes; ++l)
+            {
+                const double w = x[l] - a1 * v1[l] - a2 * v2[l] + dc;
+                x[l] = b0 * w + b1 * v1[l] + b2 * v2[l];
+                v2[l] = v1[l];
+                v1[l] = w;
+            }
+        }
+
+        for (int l = 0; l < Lanes; ++l)
+        {
+            stateV1[l] = v1[l];
+            stateV2[l] = v2[l];
+        }
+#endif
+    }
+
+    double m_v1[MaxStages][Lanes]; // v[n-1] of each section, one value per lane
+    double m_v2[MaxStages][Lanes]; // v[n-2]
+};
+
+}
+
+#endif
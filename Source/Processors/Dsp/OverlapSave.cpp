@@ -0,0 +1,200 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "MathSupplement.h"
+#include "OverlapSave.h"
+
+using juce::FFT;
+
+namespace Dsp
+{
+
+void designFirBandPass(float* taps, int numTaps, double sampleRate,
+                       double lowCut, double highCut)
+{
+    assert(numTaps % 2 == 1);
+
+    const double low = std::max(0., lowCut / sampleRate);
+    const double high = std::min(0.5, highCut / sampleRate);
+    const int centre = (numTaps - 1) / 2;
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        const int m = n - centre;
+        double h;
+        if (m == 0)
+            h = 2 * (high - low);
+        else
+            h = (std::sin(2 * doublePi * high * m) - std::sin(2 * doublePi * low * m)) / (doublePi * m);
+
+        const double x = (numTaps > 1) ? double(n) / (numTaps - 1) : 0.5;
+        const double window = 0.42 - 0.5 * std::cos(2 * doublePi * x) + 0.08 * std::cos(4 * doublePi * x);
+
+        taps[n] = float(h * window);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+OverlapSaveConvolver::State::State()
+    : m_fftSize(0)
+    , m_overlap(0)
+    , m_position(0)
+{
+}
+
+void OverlapSaveConvolver::State::setup(int fftSize, int overlap)
+{
+    if (fftSize != m_fftSize)
+    {
+        m_input.allocate(fftSize, false);
+        m_spectrum.allocate(fftSize, false);
+        m_output.allocate(fftSize, false);
+        m_fftSize = fftSize;
+    }
+    m_overlap = overlap;
+    reset();
+}
+
+void OverlapSaveConvolver::State::reset()
+{
+    if (m_fftSize > 0)
+    {
+        m_input.clear(m_fftSize);
+        m_spectrum.clear(m_fftSize);
+        m_output.clear(m_fftSize);
+    }
+    m_position = 0;
+}
+
+//------------------------------------------------------------------------------
+
+OverlapSaveConvolver::OverlapSaveConvolver()
+    : m_numTaps(0)
+    , m_fftSize(0)
+{
+}
+
+OverlapSaveConvolver::~OverlapSaveConvolver()
+{
+}
+
+bool OverlapSaveConvolver::setup(const float* taps, int numTaps, int fftOrder)
+{
+    const int fftSize = 1 << fftOrder;
+    if (numTaps < 1 || fftSize <= numTaps)
+        return false;
+
+    if (fftSize != m_fftSize)
+    {
+        m_forward = new FFT(fftOrder, false);
+        m_inverse = new FFT(fftOrder, true);
+        m_kernelSpectrum.allocate(fftSize, false);
+    }
+    m_fftSize = fftSize;
+    m_numTaps = numTaps;
+
+    // the inverse transform is not scaled, so the kernel carries the 1 / M
+    juce::HeapBlock<FFT::Complex> kernel(fftSize, true);
+    for (int i = 0; i < numTaps; ++i)
+        kernel[i].r = taps[i] / fftSize;
+
+    m_forward->perform(kernel, m_kernelSpectrum);
+    return true;
+}
+
+void OverlapSaveConvolver::prepare(State& state) const
+{
+    state.setup(m_fftSize, m_numTaps - 1);
+}
+
+void OverlapSaveConvolver::process(State& state, int numSamples, float* channelA, float* channelB) const
+{
+    assert(state.m_fftSize == m_fftSize && state.m_overlap == m_numTaps - 1);
+
+    const int partitionSize = getPartitionSize();
+
+    for (int offset = 0; offset < numSamples;)
+    {
+        const int n = std::min(partitionSize - state.m_position, numSamples - offset);
+
+        // the output of the previous partition goes out as this one comes in
+        FFT::Complex* in = state.m_input + state.m_overlap + state.m_position;
+        const FFT::Complex* out = state.m_output + state.m_overlap + state.m_position;
+        float* a = channelA + offset;
+
+        if (channelB != 0)
+        {
+            float* b = channelB + offset;
+            for (int i = 0; i < n; ++i)
+            {
+                in[i].r = a[i];
+                in[i].i = b[i];
+                a[i] = out[i].r;
+                b[i] = out[i].i;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                in[i].r = a[i];
+                in[i].i = 0;
+                a[i] = out[i].r;
+            }
+        }
+
+        state.m_position += n;
+        offset += n;
+
+        if (state.m_position == partitionSize)
+        {
+            processPartition(state);
+            state.m_position = 0;
+        }
+    }
+}
+
+void OverlapSaveConvolver::processPartition(State& state) const
+{
+    m_forward->perform(state.m_input, state.m_spectrum);
+
+    FFT::Complex* x = state.m_spectrum;
+    const FFT::Complex* h = m_kernelSpectrum;
+    for (int i = 0; i < m_fftSize; ++i)
+    {
+        const float r = x[i].r * h[i].r - x[i].i * h[i].i;
+        const float im = x[i].r * h[i].i + x[i].i * h[i].r;
+        x[i].r = r;
+        x[i].i = im;
+    }
+
+    // the first overlap samples of the output wrap around and are discarded
+    m_inverse->perform(state.m_spectrum, state.m_output);
+
+    std::memmove(state.m_input, state.m_input + getPartitionSize(),
+                 state.m_overlap * sizeof(FFT::Complex));
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_OVERLAPSAVE_H
+#define DSPFILTERS_OVERLAPSAVE_H
+
+#include "Common.h"
+
+namespace Dsp
+{
+
+/*
+ * Linear phase FIR design by the window method.
+ *
+ * Fills numTaps (odd) coefficients of a Blackman windowed sinc band pass
+ * between lowCut and highCut, in Hz. A lowCut of zero gives a low pass. The
+ * filter is symmetric, so its group delay is (numTaps - 1) / 2 samples at all
+ * frequencies.
+ *
+ */
+PLUGIN_API void designFirBandPass(float* taps, int numTaps, double sampleRate,
+                                  double lowCut, double highCut);
+
+/*
+ * FIR filtering by FFT overlap-save convolution.
+ *
+ * The input is cut in partitions of M - N + 1 samples, for an FFT size M and
+ * N taps, and each partition is filtered with one forward and one inverse FFT
+ * of size M, whatever the number of taps. A larger FFT means fewer transforms
+ * per sample but a longer latency, which is one partition.
+ *
+ * Channels are filtered two at a time, one in the real and one in the
+ * imaginary part of the same complex transform, since the kernel is real.
+ *
+ * The convolver is shared, the per channel pair buffers are in a State, and
+ * several states can be processed on different threads at the same time.
+ *
+ */
+class PLUGIN_API OverlapSaveConvolver
+{
+public:
+    class PLUGIN_API State
+    {
+    public:
+        State();
+
+        void reset();
+
+    private:
+        friend class OverlapSaveConvolver;
+
+        void setup(int fftSize, int overlap);
+
+        juce::HeapBlock<juce::FFT::Complex> m_input;    // overlap, then the partition being filled
+        juce::HeapBlock<juce::FFT::Complex> m_spectrum;
+        juce::HeapBlock<juce::FFT::Complex> m_output;   // filtered previous partition, from index overlap
+        int m_fftSize;
+        int m_overlap;
+        int m_position;
+
+        JUCE_DECLARE_NON_COPYABLE(State)
+    };
+
+    OverlapSaveConvolver();
+    ~OverlapSaveConvolver();
+
+    // Sets the kernel and an FFT size of 2^fftOrder, which must be larger
+    // than numTaps. Returns false if it is not.
+    bool setup(const float* taps, int numTaps, int fftOrder);
+
+    // Sizes the buffers of a state for the current setup and clears them
+    void prepare(State& state) const;
+
+    int getNumTaps() const { return m_numTaps; }
+    int getFftSize() const { return m_fftSize; }
+
+    // Samples per partition
+    int getPartitionSize() const { return m_fftSize - m_numTaps + 1; }
+
+    // Delay added by the partitioning, on top of the delay of the kernel
+    int getLatency() const { return getPartitionSize(); }
+
+    // Total delay of the output for a symmetric kernel
+    int getGroupDelay() const { return getLatency() + (m_numTaps - 1) / 2; }
+
+    // Filters one or two channels in place. channelB can be null.
+    void process(State& state, int numSamples, float* channelA, float* channelB) const;
+
+private:
+    void processPartition(State& state) const;
+
+    juce::ScopedPointer<juce::FFT> m_forward;
+    juce::ScopedPointer<juce::FFT> m_inverse;
+    juce::HeapBlock<juce::FFT::Complex> m_kernelSpectrum; // scaled by 1 / M for the inverse transform
+    int m_numTaps;
+    int m_fftSize;
+
+    JUCE_DECLARE_NON_COPYABLE(OverlapSaveConvolver)
+};
+
+}
+
+#endif
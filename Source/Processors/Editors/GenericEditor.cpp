@@ -224,6 +224,19 @@ bool GenericEditor::keyPressed(const KeyPress& key)
     return false;
 }
 
+String GenericEditor::getTooltip()
+{
+    if (getProcessor() == nullptr)
+        return String();
+
+    ProcessingProfile::Statistics stats = getProcessor()->getProcessingProfile().getStatistics();
+
+    if (stats.numBlocks == 0)
+        return String();
+
+    return stats.toString();
+}
+
 void GenericEditor::switchSelectedState()
 {
     //std::cout << "Switching selected state" << std::endl;
@@ -55,6 +55,7 @@ class PLUGIN_API GenericEditor  : public AudioProcessorEditor
                                 , public Timer
                                 , public Button::Listener
                                 , public Slider::Listener
+                                , public TooltipClient
 {
 public:
     /** Constructor. Loads fonts and creates default buttons.
@@ -76,6 +77,9 @@ public:
     /** Called whenever a key is pressed and the editor has keyboard focus.*/
     bool keyPressed (const KeyPress& key) override;
 
+    /** Shows the processing time statistics of the processor once it has processed data.*/
+    String getTooltip() override;
+
     /** Handles button clicks for all editors. Deals with clicks on the editor's
         title bar and channel selector drawer. */
     virtual void buttonClicked (Button* buttonThatWasClicked) override;
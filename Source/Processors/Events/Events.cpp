@@ -316,6 +316,90 @@ const void* Event::getRawDataPointer() const
 	return m_data.getData();
 }
 
+//EventView
+
+EventView::EventView(const void* data, size_t size, const EventChannel* channelInfo)
+	: m_data(static_cast<const uint8*>(data)),
+	m_size(size),
+	m_channelInfo(channelInfo)
+{}
+
+EventView::EventView(const MidiMessage& msg, const EventChannel* channelInfo)
+	: m_data(msg.getRawData()),
+	m_size(msg.getRawDataSize()),
+	m_channelInfo(channelInfo)
+{}
+
+bool EventView::isValid() const
+{
+	if (!m_channelInfo)
+		return false;
+	if (m_size != (m_channelInfo->getDataSize() + EVENT_BASE_SIZE + m_channelInfo->getTotalEventMetaDataSize()))
+		return false;
+	//TODO: remove the mask when the probe system is implemented
+	if (static_cast<EventType>(*(m_data + 0) & 0x7F) != PROCESSOR_EVENT)
+		return false;
+	if (static_cast<EventChannel::EventChannelTypes>(*(m_data + 1)) != m_channelInfo->getChannelType())
+		return false;
+	if (*reinterpret_cast<const uint16*>(m_data + 2) != m_channelInfo->getSourceNodeID())
+		return false;
+	if (*reinterpret_cast<const uint16*>(m_data + 4) != m_channelInfo->getSubProcessorIdx())
+		return false;
+	if (*reinterpret_cast<const uint16*>(m_data + 6) != m_channelInfo->getSourceIndex())
+		return false;
+	return true;
+}
+
+EventChannel::EventChannelTypes EventView::getEventType() const
+{
+	return static_cast<EventChannel::EventChannelTypes>(*(m_data + 1));
+}
+
+const EventChannel* EventView::getChannelInfo() const
+{
+	return m_channelInfo;
+}
+
+juce::int64 EventView::getTimestamp() const
+{
+	return *reinterpret_cast<const juce::int64*>(m_data + 8);
+}
+
+uint16 EventView::getChannel() const
+{
+	return *reinterpret_cast<const uint16*>(m_data + 16);
+}
+
+const void* EventView::getRawDataPointer() const
+{
+	return m_data + EVENT_BASE_SIZE;
+}
+
+size_t EventView::getDataSize() const
+{
+	return m_channelInfo->getDataSize();
+}
+
+bool EventView::getState() const
+{
+	uint16 channel = getChannel();
+	int byteIndex = channel / 8;
+	int bitIndex = channel % 8;
+
+	char data = *(m_data + EVENT_BASE_SIZE + byteIndex);
+	return ((1 << bitIndex) & data);
+}
+
+const void* EventView::getMetaDataPointer() const
+{
+	return m_data + EVENT_BASE_SIZE + getDataSize();
+}
+
+size_t EventView::getMetaDataSize() const
+{
+	return m_channelInfo->getTotalEventMetaDataSize();
+}
+
 //TTLEvent
 
 TTLEvent::TTLEvent(const EventChannel* channelInfo, juce::int64 timestamp, uint16 channel, const void* eventData)
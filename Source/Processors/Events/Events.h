@@ -164,6 +164,42 @@ protected:
 
 };
 
+/**
+Read-only view over a serialized processor event.
+Reads the fields straight from the event packet, without the allocations and copies of
+Event::deserializeFromMessage. The serialized data must outlive the view.
+*/
+class PLUGIN_API EventView
+{
+public:
+	EventView(const void* data, size_t size, const EventChannel* channelInfo);
+	EventView(const MidiMessage& msg, const EventChannel* channelInfo);
+
+	/** Checks the packet size, type and source against the channel info, as deserializeFromMessage does */
+	bool isValid() const;
+
+	EventChannel::EventChannelTypes getEventType() const;
+	const EventChannel* getChannelInfo() const;
+	juce::int64 getTimestamp() const;
+	uint16 getChannel() const;
+
+	/** Gets the raw data payload. For TTL events this is the TTL word */
+	const void* getRawDataPointer() const;
+	size_t getDataSize() const;
+
+	/** For TTL events, the state of the channel that triggered the event */
+	bool getState() const;
+
+	/** Gets the event metadata values, serialized one after the other in descriptor order */
+	const void* getMetaDataPointer() const;
+	size_t getMetaDataSize() const;
+
+private:
+	const uint8* m_data;
+	const size_t m_size;
+	const EventChannel* m_channelInfo;
+};
+
 typedef ScopedPointer<TTLEvent> TTLEventPtr;
 class PLUGIN_API TTLEvent
 	: public Event
@@ -23,9 +23,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "BinaryFileSource.h"
 
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define BINARYSOURCE_USE_MADVISE 1
+#endif
+
 using namespace BinarySource;
 
-BinaryFileSource::BinaryFileSource() : m_samplePos(0)
+#if BINARYSOURCE_USE_MADVISE
+namespace
+{
+	void adviseRange(const void* start, size_t numBytes, int advice)
+	{
+		// madvise needs a page aligned start
+		static const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+		const size_t offset = size_t(start) % pageSize;
+		madvise(const_cast<char*>(static_cast<const char*>(start)) - offset, numBytes + offset, advice);
+	}
+}
+#endif
+
+BinaryFileSource::BinaryFileSource() : m_samplePos(0), m_prefetchedPos(0)
 {}
 
 BinaryFileSource::~BinaryFileSource()
@@ -101,6 +120,7 @@ void BinaryFileSource::fillRecordInfo()
 		numRecords++;	
 
 		m_dataFileArray.add(dataFile);
+		m_recordArray.add(record);
 		
 	}
 
@@ -110,11 +130,38 @@ void BinaryFileSource::updateActiveRecord()
 {
 	m_dataFile = new MemoryMappedFile(m_dataFileArray[activeRecord.get()], MemoryMappedFile::readOnly);
 	m_samplePos = 0;
+	m_prefetchedPos = 0;
+
+	m_seekIndex = FileSeekIndex::openBinaryRecording(m_rootPath, m_recordArray[activeRecord.get()]);
+
+#if BINARYSOURCE_USE_MADVISE
+	// pages are read in order, so the kernel can read further ahead and drop the ones behind
+	if (m_dataFile->getData() != nullptr)
+		adviseRange(m_dataFile->getData(), m_dataFile->getSize(), MADV_SEQUENTIAL);
+#endif
 }
 
 void BinaryFileSource::seekTo(int64 sample)
 {
 	m_samplePos = sample % getActiveNumSamples();
+	m_prefetchedPos = m_samplePos;
+}
+
+void BinaryFileSource::prefetch()
+{
+#if BINARYSOURCE_USE_MADVISE
+	const int64 bytesPerSample = getActiveNumChannels() * sizeof(int16);
+	const int64 prefetchEnd = jmin(getActiveNumSamples(), m_samplePos + prefetchBytes / bytesPerSample);
+
+	// only the part that wasn't requested yet, so most reads issue one small hint
+	if (prefetchEnd > m_prefetchedPos)
+	{
+		const int64 start = jmax(m_prefetchedPos, m_samplePos);
+		adviseRange(static_cast<const char*>(m_dataFile->getData()) + start * bytesPerSample,
+			size_t((prefetchEnd - start) * bytesPerSample), MADV_WILLNEED);
+		m_prefetchedPos = prefetchEnd;
+	}
+#endif
 }
 
 int BinaryFileSource::readData(int16* buffer, int nSamples)
@@ -135,21 +182,22 @@ int BinaryFileSource::readData(int16* buffer, int nSamples)
 
 	memcpy(buffer, data, samplesToRead*nChans*sizeof(int16));
     m_samplePos += samplesToRead;
+
+	prefetch();
 	return samplesToRead;
 }
 
 void BinaryFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
 {
-	int n = getActiveNumChannels();
-	float bitVolts = getChannelInfo(channel).bitVolts;
-
-	for (int i = 0; i < numSamples; i++)
-	{
-		*(outBuffer + i) = *(inBuffer + (n*i) + channel) * bitVolts;
-	}
+	convertChannelData(inBuffer, outBuffer, getActiveNumChannels(), channel, numSamples, getChannelInfo(channel).bitVolts);
 }
 
 bool BinaryFileSource::isReady()
 {
 	return true;
+}
+
+const FileSeekIndex* BinaryFileSource::getSeekIndex() const
+{
+	return m_seekIndex;
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define BINARYFILESOURCE_H_INCLUDED
 
 #include "../FileSource.h"
+#include "../FileSeekIndex.h"
 
 namespace BinarySource
 {
@@ -42,18 +43,29 @@ namespace BinarySource
 
 		bool isReady() override;
 
+		const FileSeekIndex* getSeekIndex() const override;
+
+		/** Bytes of the file the OS is asked to read ahead of the current position */
+		static const int64 prefetchBytes = 16 * 1024 * 1024;
+
 	private:
 		bool Open(File file) override;
 		void fillRecordInfo() override;
 		void updateActiveRecord() override;
 
+		/** Hints the OS to start reading the samples up to prefetchBytes past the current position */
+		void prefetch();
+
 		ScopedPointer<MemoryMappedFile> m_dataFile;
 		var m_jsonData;
 		Array<File> m_dataFileArray;
+		Array<var> m_recordArray; // structure entry of each record
+		ScopedPointer<FileSeekIndex> m_seekIndex;
 
 		File m_rootPath;
 		int64 m_samplePos;
-		
+		int64 m_prefetchedPos;
+
 	};
 }
 
@@ -0,0 +1,261 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedFileSource.h"
+
+using namespace CompressedSource;
+using namespace CompressedRecordingEngine;
+
+CompressedFileSource::CompressedFileSource() :
+m_numChannels(0),
+m_samplesPerChunk(0),
+m_dataOffset(0),
+m_loadedChunk(-1),
+m_samplePos(0)
+{}
+
+CompressedFileSource::~CompressedFileSource()
+{}
+
+bool CompressedFileSource::Open(File file)
+{
+	m_dataFile = new MemoryMappedFile(file, MemoryMappedFile::readOnly);
+	const uint8* data = static_cast<const uint8*>(m_dataFile->getData());
+	size_t size = m_dataFile->getSize();
+	if (data == nullptr || size < sizeof(CompressedFile::FileHeader))
+		return false;
+
+	CompressedFile::FileHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != CompressedFile::headerMagic || header.version != CompressedFile::formatVersion
+		|| header.numChannels == 0 || header.samplesPerChunk == 0
+		|| sizeof(header) + header.jsonSize > size)
+		return false;
+
+	m_jsonData = JSON::parse(String::fromUTF8(reinterpret_cast<const char*>(data + sizeof(header)), header.jsonSize));
+	if (m_jsonData.isVoid())
+		return false;
+
+	m_file = file;
+	m_numChannels = header.numChannels;
+	m_samplesPerChunk = header.samplesPerChunk;
+	m_dataOffset = sizeof(header) + header.jsonSize;
+
+	if (!readIndex())
+	{
+		std::cout << "No chunk index in " << file.getFullPathName() << ", scanning the file" << std::endl;
+		scanChunks();
+	}
+	m_chunkData.malloc(size_t(m_numChannels) * m_samplesPerChunk);
+	return true;
+}
+
+bool CompressedFileSource::readIndex()
+{
+	const uint8* data = static_cast<const uint8*>(m_dataFile->getData());
+	size_t size = m_dataFile->getSize();
+	if (size < m_dataOffset + sizeof(CompressedFile::FileTrailer))
+		return false;
+
+	CompressedFile::FileTrailer trailer;
+	memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+	if (trailer.magic != CompressedFile::trailerMagic || trailer.indexOffset < m_dataOffset
+		|| trailer.indexOffset + int64(trailer.numChunks) * sizeof(CompressedFile::IndexEntry) + sizeof(trailer) != size)
+		return false;
+
+	m_index.resize(trailer.numChunks);
+	memcpy(m_index.getRawDataPointer(), data + trailer.indexOffset, trailer.numChunks * sizeof(CompressedFile::IndexEntry));
+
+	//The index is only trusted if it matches the chunks it points to
+	int64 nextSample = 0;
+	for (int i = 0; i < m_index.size(); i++)
+	{
+		const CompressedFile::IndexEntry& entry = m_index.getReference(i);
+		CompressedFile::ChunkHeader header;
+		if (entry.fileOffset < m_dataOffset || entry.fileOffset > trailer.indexOffset
+			|| !readChunkHeader(entry.fileOffset, header)
+			|| entry.fileOffset + int64(sizeof(header)) + header.compressedSize > trailer.indexOffset
+			|| entry.numSamples != header.numSamples || entry.firstSample != header.firstSample
+			|| entry.firstSample < nextSample)
+		{
+			m_index.clear();
+			return false;
+		}
+		nextSample = entry.firstSample + entry.numSamples;
+	}
+	return true;
+}
+
+void CompressedFileSource::scanChunks()
+{
+	int64 pos = m_dataOffset;
+
+	m_index.clear();
+	CompressedFile::ChunkHeader header;
+	while (readChunkHeader(pos, header))
+	{
+		CompressedFile::IndexEntry entry;
+		entry.fileOffset = pos;
+		entry.firstSample = header.firstSample;
+		entry.numSamples = header.numSamples;
+		m_index.add(entry);
+		pos += sizeof(header) + header.compressedSize;
+	}
+}
+
+bool CompressedFileSource::readChunkHeader(int64 pos, CompressedFile::ChunkHeader& header) const
+{
+	int64 size = m_dataFile->getSize();
+	if (pos < 0 || pos + int64(sizeof(header)) > size)
+		return false;
+
+	memcpy(&header, static_cast<const uint8*>(m_dataFile->getData()) + pos, sizeof(header));
+	return header.numSamples > 0 && header.numSamples <= uint32(m_samplesPerChunk)
+		&& pos + int64(sizeof(header)) + header.compressedSize <= size;
+}
+
+void CompressedFileSource::fillRecordInfo()
+{
+	RecordInfo info;
+
+	String folderName = m_jsonData["folder_name"];
+	info.name = folderName.isEmpty() ? m_file.getParentDirectory().getFileName() : folderName.trimCharactersAtEnd("/");
+	info.sampleRate = m_jsonData["sample_rate"];
+	info.numSamples = m_index.size() > 0 ? m_index.getLast().firstSample + m_index.getLast().numSamples : 0;
+
+	var channels = m_jsonData["channels"];
+	int numDescribedChannels = channels.isArray() ? channels.size() : 0;
+	for (int c = 0; c < m_numChannels; c++)
+	{
+		RecordedChannelInfo cInfo;
+		if (c < numDescribedChannels)
+		{
+			var chan = channels[c];
+			cInfo.name = chan["channel_name"];
+			cInfo.bitVolts = chan["bit_volts"];
+		}
+		else
+		{
+			cInfo.name = "CH" + String(c + 1);
+			cInfo.bitVolts = 1.0f;
+		}
+		info.channels.add(cInfo);
+	}
+
+	infoArray.add(info);
+	numRecords = 1;
+}
+
+void CompressedFileSource::updateActiveRecord()
+{
+	m_samplePos = 0;
+	m_loadedChunk = -1;
+
+	// recorded by the Compressed binary engine, the file sits in the Binary layout, next to its timestamps
+	File dataDirectory = m_file.getParentDirectory();
+	if (m_jsonData["folder_name"].toString().isNotEmpty() && dataDirectory.getParentDirectory().getFileName() == "continuous")
+		m_seekIndex = FileSeekIndex::openBinaryRecording(dataDirectory.getParentDirectory().getParentDirectory(), m_jsonData);
+}
+
+void CompressedFileSource::seekTo(int64 sample)
+{
+	m_samplePos = sample % getActiveNumSamples();
+}
+
+int CompressedFileSource::findChunk(int64 sample) const
+{
+	//Last chunk starting at or before the sample
+	int lo = 0;
+	int hi = m_index.size() - 1;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (m_index.getReference(mid).firstSample <= sample)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+bool CompressedFileSource::loadChunk(int chunk)
+{
+	if (chunk == m_loadedChunk)
+		return true;
+
+	const CompressedFile::IndexEntry& entry = m_index.getReference(chunk);
+	const uint8* data = static_cast<const uint8*>(m_dataFile->getData()) + entry.fileOffset;
+	CompressedFile::ChunkHeader header;
+
+	m_loadedChunk = -1;
+	if (!readChunkHeader(entry.fileOffset, header) || header.numSamples != entry.numSamples
+		|| !ChunkCodec::decode(data + sizeof(header), header.compressedSize, m_numChannels, header.numSamples,
+		m_chunkData, 1, m_numChannels))
+	{
+		std::cerr << "Corrupt chunk " << chunk << " in " << m_file.getFullPathName() << std::endl;
+		return false;
+	}
+	m_loadedChunk = chunk;
+	return true;
+}
+
+int CompressedFileSource::readData(int16* buffer, int nSamples)
+{
+	int samplesRead = 0;
+	int64 numSamples = getActiveNumSamples();
+
+	while (samplesRead < nSamples && m_samplePos < numSamples)
+	{
+		int chunk = findChunk(m_samplePos);
+		const CompressedFile::IndexEntry& entry = m_index.getReference(chunk);
+		int offset = int(m_samplePos - entry.firstSample);
+		int count = int(jmin(int64(nSamples - samplesRead), entry.numSamples - offset));
+		if (count <= 0)
+			break;
+
+		int16* dest = buffer + samplesRead * m_numChannels;
+		if (loadChunk(chunk))
+			memcpy(dest, m_chunkData + offset * m_numChannels, count * m_numChannels * sizeof(int16));
+		else
+			zeromem(dest, count * m_numChannels * sizeof(int16));
+
+		samplesRead += count;
+		m_samplePos += count;
+	}
+	return samplesRead;
+}
+
+void CompressedFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+	convertChannelData(inBuffer, outBuffer, m_numChannels, channel, numSamples, getChannelInfo(channel).bitVolts);
+}
+
+bool CompressedFileSource::isReady()
+{
+	return true;
+}
+
+const FileSeekIndex* CompressedFileSource::getSeekIndex() const
+{
+	return m_seekIndex;
+}
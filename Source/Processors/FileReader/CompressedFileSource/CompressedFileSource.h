@@ -0,0 +1,80 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDFILESOURCE_H_INCLUDED
+#define COMPRESSEDFILESOURCE_H_INCLUDED
+
+#include "../FileSource.h"
+#include "../FileSeekIndex.h"
+#include "../../RecordNode/CompressedFormat/ChunkCodec.h"
+
+namespace CompressedSource
+{
+	/** Reads the continuous.oecz files written by the Compressed binary record engine.
+	Chunks are located through the index at the end of the file, or by scanning the
+	chunk headers if the recording wasn't closed properly */
+	class CompressedFileSource : public FileSource
+	{
+	public:
+		CompressedFileSource();
+		~CompressedFileSource();
+
+		int readData(int16* buffer, int nSamples) override;
+
+		void seekTo(int64 sample) override;
+
+		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+
+		bool isReady() override;
+
+		const FileSeekIndex* getSeekIndex() const override;
+
+	private:
+		bool Open(File file) override;
+		void fillRecordInfo() override;
+		void updateActiveRecord() override;
+
+		bool readIndex();
+		void scanChunks();
+		/** Reads the header of the chunk at pos, if it holds a valid number of samples and the chunk fits in the file */
+		bool readChunkHeader(int64 pos, CompressedRecordingEngine::CompressedFile::ChunkHeader& header) const;
+		int findChunk(int64 sample) const;
+		bool loadChunk(int chunk);
+
+		ScopedPointer<MemoryMappedFile> m_dataFile;
+		File m_file;
+		var m_jsonData;
+		Array<CompressedRecordingEngine::CompressedFile::IndexEntry> m_index;
+		int m_numChannels;
+		int m_samplesPerChunk;
+		int64 m_dataOffset;
+
+		HeapBlock<int16> m_chunkData; //decoded chunk, interleaved
+		int m_loadedChunk;
+		int64 m_samplePos;
+
+		ScopedPointer<FileSeekIndex> m_seekIndex;
+	};
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include "../../Audio/AudioComponent.h"
 #include "../PluginManager/PluginManager.h"
 #include "BinaryFileSource/BinaryFileSource.h"
+#include "CompressedFileSource/CompressedFileSource.h"
 
 
 FileReader::FileReader()
@@ -41,10 +42,15 @@ FileReader::FileReader()
     , startSample           (0)
     , stopSample            (0)
     , counter               (0)
-    , bufferCacheWindow     (0)
-    , m_shouldFillBackBuffer(false)
 	, m_bufferSize(1024)
 	, m_sysSampleRate(44100)
+    , m_offlinePlayback(false)
+    , m_readAheadBlocks(DEFAULT_READ_AHEAD_BLOCKS)
+    , m_readAheadFifo(DEFAULT_READ_AHEAD_BLOCKS + 1)
+    , m_seekTarget(-1)
+    , m_lastEditorUpdate(0)
+    , m_currentBlock(nullptr)
+    , m_currentBlockSamples(0)
 {
     setProcessorType (PROCESSOR_TYPE_SOURCE);
 
@@ -156,25 +162,41 @@ bool FileReader::enable()
 {
 	timestamp = 0;
 
-	AudioDeviceManager& adm = AccessClass::getAudioComponent()->deviceManager;
-	AudioDeviceManager::AudioDeviceSetup ads;
-	adm.getAudioDeviceSetup(ads);
-	m_sysSampleRate = ads.sampleRate;
-	m_bufferSize = ads.bufferSize;
+	// the graph may be clocked by the audio device or by the processing driver thread
+	AudioComponent* audio = AccessClass::getAudioComponent();
+	m_sysSampleRate = audio->getSampleRate();
+	m_bufferSize = audio->getBufferSize();
 	if (m_bufferSize == 0) m_bufferSize = 1024;
 
 	m_samplesPerBuffer.set(m_bufferSize * (getDefaultSampleRate() / m_sysSampleRate));
 
-	bufferA.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
-	bufferB.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
-
-	readAndFillBufferCache(bufferA); // pre-fill the front buffer with a blocking read
-
-	// set the backbuffer so that on the next call to process() we start with bufferA and buffer
-	// cache window id = 0
-	readBuffer = &bufferB;
-	bufferCacheWindow = 0;
-	m_shouldFillBackBuffer.set(false);
+	// offline playback when nothing paces the graph in real time
+	m_offlinePlayback = audio->isUsingProcessingDriver() && audio->getProcessingDriver().isFreeRunning();
+
+	// the fifo keeps one slot free to tell a full queue from an empty one
+	const int numSlots = m_readAheadBlocks + 1;
+	m_readAheadFifo.setTotalSize(numSlots);
+	m_readAheadBuffer.malloc(currentNumChannels * m_samplesPerBuffer.get() * numSlots);
+	m_readAheadLengths.calloc(numSlots);
+	m_readAheadStarts.calloc(numSlots);
+	m_readAheadSeeks.calloc(numSlots);
+	m_blockReady.reset();
+	m_readerFinished = 0;
+	m_endOfFile = 0;
+	m_underruns = 0;
+	m_seekTarget = -1;
+	m_seekGeneration = 0;
+
+	// real-time playback resumes where it stopped, offline playback plays the whole range
+	if (m_offlinePlayback || currentSample >= stopSample)
+		currentSample = startSample;
+	input->seekTo(currentSample);
+	m_playbackPosition = currentSample;
+
+	// pre-fill the queue with blocking reads
+	while (m_readAheadFifo.getFreeSpace() > 0 && readBlock())
+	{
+	}
 
 	startThread(); // start async file reader thread
 
@@ -184,9 +206,87 @@ bool FileReader::enable()
 bool FileReader::disable()
 {
 	stopThread(100);
+	cancelPendingUpdate();
+
+	// the reader thread is ahead of playback, so resume from the last sample played, or a seek it didn't get to
+	const int64 seekTarget = m_seekTarget.exchange(-1);
+	currentSample = (seekTarget >= 0) ? seekTarget : m_playbackPosition.get();
+
 	return true;
 }
 
+bool FileReader::isOfflinePlayback() const
+{
+	return m_offlinePlayback;
+}
+
+float FileReader::getPlaybackProgress() const
+{
+	if (stopSample <= startSample)
+		return 0.0f;
+
+	return float(m_playbackPosition.get() - startSample) / float(stopSample - startSample);
+}
+
+bool FileReader::hasReachedEndOfFile() const
+{
+	return m_endOfFile.get() != 0;
+}
+
+void FileReader::setReadAheadBlocks(int numBlocks)
+{
+	m_readAheadBlocks = jlimit(2, 4096, numBlocks);
+}
+
+int FileReader::getReadAheadBlocks() const
+{
+	return m_readAheadBlocks;
+}
+
+int FileReader::getNumUnderruns() const
+{
+	return m_underruns.get();
+}
+
+const FileSeekIndex* FileReader::getSeekIndex() const
+{
+	return input ? input->getSeekIndex() : nullptr;
+}
+
+void FileReader::seekToSample(int64 sample)
+{
+	if (! input || stopSample <= startSample)
+		return;
+
+	sample = jlimit(startSample, stopSample - 1, sample);
+
+	// during acquisition the file position belongs to the reader thread
+	if (isThreadRunning())
+	{
+		m_seekTarget = sample;
+	}
+	else
+	{
+		currentSample = sample;
+		input->seekTo(currentSample);
+	}
+
+	static_cast<FileReaderEditor*> (getEditor())->setCurrentTime(samplesToMilliseconds(sample));
+}
+
+void FileReader::seekToTimestamp(int64 timestamp)
+{
+	const FileSeekIndex* index = getSeekIndex();
+	seekToSample(index != nullptr ? index->getSampleForTimestamp(timestamp) : timestamp);
+}
+
+void FileReader::seekToMarker(int index)
+{
+	const FileSeekIndex* seekIndex = getSeekIndex();
+	if (seekIndex != nullptr && isPositiveAndBelow(index, seekIndex->getNumMarkers()))
+		seekToSample(seekIndex->getMarker(index).sample);
+}
+
 bool FileReader::isFileSupported (const String& fileName) const
 {
     const File file (fileName);
@@ -227,6 +327,9 @@ bool FileReader::setFile (String fullpath)
 		{
 			input = createBuiltInFileSource(index - numPluginFileSources);
 		}
+
+		// plugin sources may not support converting several channels at once
+		setChannelParallelProcessing(index >= numPluginFileSources, 32);
 		if (!input)
 		{
 			std::cerr << "Error creating file source for extension " << ext << std::endl;
@@ -277,7 +380,6 @@ void FileReader::setActiveRecording (int index)
     currentSample   = 0;
     startSample     = 0;
     stopSample      = currentNumSamples;
-    bufferCacheWindow = 0;
 
     for (int i = 0; i < currentNumChannels; ++i)
     {
@@ -285,6 +387,7 @@ void FileReader::setActiveRecording (int index)
     }
 
     static_cast<FileReaderEditor*> (getEditor())->setTotalTime (samplesToMilliseconds (currentNumSamples));
+    static_cast<FileReaderEditor*> (getEditor())->populateMarkers (currentSampleRate);
 	input->seekTo(startSample);
 
    
@@ -313,35 +416,101 @@ void FileReader::updateSettings()
 
 void FileReader::process (AudioSampleBuffer& buffer)
 {
-    const int samplesNeededPerBuffer = int (float (buffer.getNumSamples()) * (getDefaultSampleRate() / m_sysSampleRate));
-    m_samplesPerBuffer.set(samplesNeededPerBuffer);
-    // FIXME: needs to account for the fact that the ratio might not be an exact
-    //        integer value
-    
-    // if cache window id == 0, we need to read and cache BUFFER_WINDOW_CACHE_SIZE more buffer windows
-    if (bufferCacheWindow == 0)
+    jassert (m_samplesPerBuffer.get() <= buffer.getNumSamples());
+
+    int slot;
+    if (! getNextBlock (slot))
     {
-        switchBuffer();
+        setTimestampAndSamples (timestamp, 0);
+        return;
     }
-    
-    for (int i = 0; i < currentNumChannels; ++i)
+
+    m_currentBlock = m_readAheadBuffer + slot * m_samplesPerBuffer.get() * currentNumChannels;
+    m_currentBlockSamples = m_readAheadLengths[slot];
+
+    processChannelsInParallel (buffer, currentNumChannels);
+
+    m_readAheadFifo.finishedRead (1);
+    notify(); // a block is free for the reader
+
+    setTimestampAndSamples (timestamp, m_currentBlockSamples);
+    timestamp += m_currentBlockSamples;
+
+    // a real-time block can wrap around the end of the range
+    int64 position = m_readAheadStarts[slot] + m_currentBlockSamples;
+    if (position > stopSample)
+        position = startSample + (position - stopSample);
+    m_playbackPosition = position;
+
+    // offline, blocks come much faster than the editor can show them
+    const uint32 now = Time::getMillisecondCounter();
+    if (now - m_lastEditorUpdate >= 100)
     {
-        // offset readBuffer index by current cache window count * buffer window size * num channels
-        input->processChannelData (*readBuffer + (samplesNeededPerBuffer * currentNumChannels * bufferCacheWindow),
-                                   buffer.getWritePointer (i, 0),
-                                   i,
-                                   samplesNeededPerBuffer);
+        m_lastEditorUpdate = now;
+
+        static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (position));
     }
-    
-    setTimestampAndSamples(timestamp, samplesNeededPerBuffer);
-	timestamp += samplesNeededPerBuffer;
+}
 
-	static_cast<FileReaderEditor*> (getEditor())->setCurrentTime(samplesToMilliseconds(startSample + timestamp % (stopSample - startSample)));
-    
-    bufferCacheWindow += 1;
-    bufferCacheWindow %= BUFFER_WINDOW_CACHE_SIZE;
+void FileReader::processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels)
+{
+    for (int i = startChannel; i < startChannel + numChannels; ++i)
+    {
+        input->processChannelData (m_currentBlock, buffer.getWritePointer (i, 0), i, m_currentBlockSamples);
+    }
 }
 
+bool FileReader::getNextBlock (int& slot)
+{
+    for (;;)
+    {
+        if (m_readAheadFifo.getNumReady() == 0 && ! waitForBlock())
+            return false;
+
+        int size1, start2, size2;
+        m_readAheadFifo.prepareToRead (1, slot, size1, start2, size2);
+
+        if (m_readAheadSeeks[slot] == m_seekGeneration.get())
+            return true;
+
+        // read ahead before the last seek
+        m_readAheadFifo.finishedRead (1);
+        notify();
+    }
+}
+
+bool FileReader::waitForBlock()
+{
+    if (! m_offlinePlayback)
+    {
+        // skip the block rather than stall the audio callback
+        ++m_underruns;
+        return false;
+    }
+
+    while (m_readAheadFifo.getNumReady() == 0)
+    {
+        // the reader may have added its last block before finishing, so check the queue again
+        if (m_readerFinished.get() != 0 && m_readAheadFifo.getNumReady() == 0)
+        {
+            if (m_endOfFile.compareAndSetBool (1, 0))
+            {
+                // stop the free running driver right away rather than have it spin on empty blocks
+                // until the message thread stops acquisition
+                AudioComponent* audio = AccessClass::getAudioComponent();
+                if (audio->isUsingProcessingDriver())
+                    audio->getProcessingDriver().requestEnd();
+
+                triggerAsyncUpdate();
+            }
+            return false;
+        }
+
+        m_blockReady.wait (100);
+    }
+
+    return true;
+}
 
 void FileReader::setParameter (int parameterIndex, float newValue)
 {
@@ -382,74 +551,86 @@ int64 FileReader::millisecondsToSamples (unsigned int ms) const
     return (int64) (currentSampleRate * float (ms) / 1000.f);
 }
 
-void FileReader::switchBuffer()
-{
-    if (readBuffer == &bufferA)
-        readBuffer = &bufferB;
-    else
-        readBuffer = &bufferA;
-    
-    m_shouldFillBackBuffer.set(true);
-    notify();
-}
-
-HeapBlock<int16>* FileReader::getFrontBuffer()
-{
-    return readBuffer;
-}
-
-HeapBlock<int16>* FileReader::getBackBuffer()
-{
-    if (readBuffer == &bufferA) return &bufferB;
-    
-    return &bufferA;
-}
-
 void FileReader::run()
 {
-    while (!threadShouldExit())
+    while (! threadShouldExit())
     {
-        if (m_shouldFillBackBuffer.compareAndSetBool(false, true))
+        if (m_readAheadFifo.getFreeSpace() == 0)
         {
-            readAndFillBufferCache(*getBackBuffer());
+            wait (30); // notified when process() frees a block
+            continue;
         }
-        
-        wait(30);
+
+        if (! readBlock())
+            break;
     }
+
+    m_readerFinished = 1;
+    m_blockReady.signal();
 }
 
-void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
+bool FileReader::readBlock()
 {
-    const int samplesNeededPerBuffer = m_samplesPerBuffer.get();
-    const int samplesNeeded = samplesNeededPerBuffer * BUFFER_WINDOW_CACHE_SIZE;
-    
+    if (stopSample <= startSample)
+        return false;
+
+    const int samplesPerBlock = m_samplesPerBuffer.get();
+
+    const int64 seekTarget = m_seekTarget.exchange (-1);
+    if (seekTarget >= 0)
+    {
+        input->seekTo (seekTarget);
+        currentSample = seekTarget;
+        ++m_seekGeneration;
+    }
+
+    int start1, size1, start2, size2;
+    m_readAheadFifo.prepareToWrite (1, start1, size1, start2, size2);
+    int16* block = m_readAheadBuffer + start1 * samplesPerBlock * currentNumChannels;
+    m_readAheadStarts[start1] = currentSample;
+    m_readAheadSeeks[start1] = m_seekGeneration.get();
+
     int samplesRead = 0;
-    
-    // should only loop if reached end of file and resuming from start
-    while (samplesRead < samplesNeeded)
+
+    while (samplesRead < samplesPerBlock)
     {
-        int samplesToRead = samplesNeeded - samplesRead;
-        
-        // if reached end of file stream
-        if ( (currentSample + samplesToRead) > stopSample)
+        const int samplesToRead = int (jmin (int64 (samplesPerBlock - samplesRead), stopSample - currentSample));
+
+        if (samplesToRead > 0)
         {
-            samplesToRead = stopSample - currentSample;
-            if (samplesToRead > 0)
-                input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-            
+            input->readData (block + samplesRead * currentNumChannels, samplesToRead);
+            currentSample += samplesToRead;
+            samplesRead += samplesToRead;
+        }
+
+        if (currentSample >= stopSample)
+        {
+            // offline playback ends with a partial block
+            if (m_offlinePlayback)
+                break;
+
             // reset stream to beginning
             input->seekTo (startSample);
             currentSample = startSample;
         }
-        else // else read the block needed
-        {
-            input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-            
-            currentSample += samplesToRead;
-        }
-        
-        samplesRead += samplesToRead;
     }
+
+    if (samplesRead == 0)
+        return false;
+
+    m_readAheadLengths[start1] = samplesRead;
+    m_readAheadFifo.finishedWrite (1);
+    m_blockReady.signal();
+
+    return true;
+}
+
+void FileReader::handleAsyncUpdate()
+{
+    CoreServices::sendStatusMessage ("File Reader reached the end of the file.");
+
+    if (CoreServices::getAcquisitionStatus())
+        CoreServices::setAcquisitionStatus (false);
 }
 
 StringArray FileReader::getSupportedExtensions() const
@@ -467,7 +648,7 @@ StringArray FileReader::getSupportedExtensions() const
 
 int FileReader::getNumBuiltInFileSources() const
 {
-	return 1;
+	return 2;
 }
 
 String FileReader::getBuiltInFileSourceExtensions(int index) const
@@ -476,6 +657,8 @@ String FileReader::getBuiltInFileSourceExtensions(int index) const
 	{
 	case 0: //Binary
 		return "oebin";
+	case 1: //Compressed binary
+		return "oecz";
 	default:
 		return "";
 	}
@@ -487,6 +670,8 @@ FileSource* FileReader::createBuiltInFileSource(int index) const
 	{
 	case 0:
 		return new BinarySource::BinaryFileSource();
+	case 1:
+		return new CompressedSource::CompressedFileSource();
 	default:
 		return nullptr;
 	}
@@ -30,17 +30,35 @@
 
 #include "../GenericProcessor/GenericProcessor.h"
 #include "FileSource.h"
+#include "FileSeekIndex.h"
 
-#define BUFFER_WINDOW_CACHE_SIZE 10
+#define DEFAULT_READ_AHEAD_BLOCKS 32
 
 
 /**
   Reads data from a file.
 
-  @see GenericProcessor
+  A reader thread keeps a bounded queue of blocks read ahead of playback (the
+  depth is configurable), and process() converts one block per callback, with
+  the channels split across the channel processing threads for built-in file
+  sources. In real time, playback loops over the selected range and a block
+  that isn't ready in time is skipped and counted as an underrun.
+
+  When the graph is clocked by the free-running processing driver, playback is
+  offline instead: process() waits for the next block when the queue is empty,
+  so the graph runs as fast as the slower of the disk and the downstream
+  processors, and acquisition stops at the end of the selected range.
+
+  Playback can jump to a sample, a timestamp or an event of the recording through
+  the seek index of the file source. The reader thread applies the jump before
+  its next read, and the blocks read ahead before it are dropped, so only one
+  read is needed whatever the distance. Output timestamps stay continuous.
+
+  @see GenericProcessor, ProcessingDriver
 */
 class FileReader : public GenericProcessor,
-    private Thread
+    private Thread,
+    private AsyncUpdater
 {
 public:
     FileReader();
@@ -73,6 +91,36 @@ public:
     void createEventChannels();
 	StringArray getSupportedExtensions() const;
 
+    /** Returns true if the current acquisition plays the file offline */
+    bool isOfflinePlayback() const;
+
+    /** Fraction of the selected range played so far in offline playback */
+    float getPlaybackProgress() const;
+
+    /** Returns true once offline playback has played the whole selected range */
+    bool hasReachedEndOfFile() const;
+
+    /** Number of blocks read ahead of playback, applied when acquisition starts */
+    void setReadAheadBlocks (int numBlocks);
+    int getReadAheadBlocks() const;
+
+    /** Number of real-time blocks skipped because the reader thread fell behind */
+    int getNumUnderruns() const;
+
+    /** Index of the timestamps and events of the active recording, or nullptr if the source has none */
+    const FileSeekIndex* getSeekIndex() const;
+
+    /** Moves playback to a sample of the active recording, within the selected range */
+    void seekToSample (int64 sample);
+
+    /** Moves playback to the first sample at or after a recorded timestamp */
+    void seekToTimestamp (int64 timestamp);
+
+    /** Moves playback to a marker of the seek index */
+    void seekToMarker (int index);
+
+    void processChannelRange (AudioSampleBuffer& buffer, int startChannel, int numChannels) override;
+
 private:
     Array<const EventChannel*> moduleEventChannels;
     unsigned int count = 0;
@@ -90,7 +138,6 @@ private:
     int64 currentNumSamples;
     int64 startSample;
     int64 stopSample;
-    int64 bufferCacheWindow; // the current buffer window to read from readBuffer
     Array<RecordedChannelInfo> channelInfo;
 
     // for testing purposes only
@@ -98,33 +145,48 @@ private:
 
     ScopedPointer<FileSource> input;
 
-    HeapBlock<int16> * readBuffer;      // Ptr to the current "front" buffer
-    HeapBlock<int16> bufferA;
-    HeapBlock<int16> bufferB;
-
     HashMap<String, int> supportedExtensions;
     
-    Atomic<int> m_shouldFillBackBuffer;
     Atomic<int> m_samplesPerBuffer;
 
 	unsigned int m_bufferSize;
 	float m_sysSampleRate;
-    
-    /** Swaps the backbuffer to the front and flags the background reader
-        thread to update the new backbuffer */
-    void switchBuffer();
-    
-    HeapBlock<int16>* getFrontBuffer();
-    HeapBlock<int16>* getBackBuffer();
-    
+
+    bool m_offlinePlayback;
+    int m_readAheadBlocks;
+    AbstractFifo m_readAheadFifo;
+    HeapBlock<int16> m_readAheadBuffer; // blocks of interleaved samples
+    HeapBlock<int> m_readAheadLengths;  // number of samples in each block, less than a full block at the end
+    HeapBlock<int64> m_readAheadStarts; // position of each block in the recording
+    HeapBlock<int> m_readAheadSeeks;    // seek generation each block was read in
+    WaitableEvent m_blockReady;
+    Atomic<int> m_readerFinished;
+    Atomic<int> m_endOfFile;
+    Atomic<int> m_underruns;
+    Atomic<int64> m_playbackPosition;
+    Atomic<int64> m_seekTarget;         // -1 when no seek is pending
+    Atomic<int> m_seekGeneration;
+    uint32 m_lastEditorUpdate;
+
+    // block being converted by processChannelRange()
+    int16* m_currentBlock;
+    int m_currentBlockSamples;
+
     /** Executes the background thread task */
     void run() override;
-    
-    /** Reads a chunk of the file that fills an entire buffer cache.
-     
-        This method will read into the buffer that passed in by the param 
-     */
-    void readAndFillBufferCache(HeapBlock<int16> &cacheBuffer);
+
+    /** Reads the next block of the selected range into the read-ahead queue.
+        Returns false once offline playback has read the whole range */
+    bool readBlock();
+
+    /** Waits for a block in offline playback. Returns false if there is none to play */
+    bool waitForBlock();
+
+    /** Finds the next block to play, dropping the ones read before the last seek */
+    bool getNextBlock (int& slot);
+
+    /** Stops acquisition once offline playback reaches the end of the file */
+    void handleAsyncUpdate() override;
 
 	//Methods for built-in file sources
 	int getNumBuiltInFileSources() const;
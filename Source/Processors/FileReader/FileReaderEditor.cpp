@@ -31,6 +31,8 @@ FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaul
     : GenericEditor (parentNode, useDefaultParameterEditors)
     , fileReader   (static_cast<FileReader*> (parentNode))
     , recTotalTime              (0)
+    , markerSampleRate          (0)
+    , markerPageStart           (0)
     , m_isFileDragAndDropActive (false)
 {
     lastFilePath = CoreServices::getDefaultUserSaveDirectory();
@@ -45,10 +47,18 @@ FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaul
     addAndMakeVisible (fileNameLabel);
 
     recordSelector = new ComboBox ("Recordings");
-    recordSelector->setBounds (30, 50, 120, 20);
+    recordSelector->setBounds (30, 50, 70, 20);
     recordSelector->addListener (this);
     addAndMakeVisible (recordSelector);
 
+    markerSelector = new ComboBox ("Markers");
+    markerSelector->setBounds (105, 50, 70, 20);
+    markerSelector->setTextWhenNothingSelected ("Jump to");
+    markerSelector->setTextWhenNoChoicesAvailable ("No events");
+    markerSelector->setTooltip ("Jump to an event of the recording");
+    markerSelector->addListener (this);
+    addAndMakeVisible (markerSelector);
+
     currentTime = new DualTimeComponent (this, false);
     currentTime->setBounds (5, 80, 175, 20);
     addAndMakeVisible (currentTime);
@@ -177,6 +187,27 @@ void FileReaderEditor::setCurrentTime (unsigned int ms)
 
 void FileReaderEditor::comboBoxChanged (ComboBox* combo)
 {
+    if (combo == markerSelector)
+    {
+        const FileSeekIndex* index = fileReader->getSeekIndex();
+        const int numMarkers = index != nullptr ? index->getNumMarkers() : 0;
+        const int id = combo->getSelectedId();
+
+        // so the same event can be picked again
+        combo->setSelectedId (0, dontSendNotification);
+
+        if (id == numMarkers + 1 || id == numMarkers + 2)
+        {
+            showMarkerPage (markerPageStart + (id == numMarkers + 1 ? -maxListedMarkers : maxListedMarkers));
+            combo->showPopup();
+        }
+        else if (id > 0)
+        {
+            fileReader->seekToMarker (id - 1);
+        }
+        return;
+    }
+
     fileReader->setParameter (0, combo->getSelectedId() - 1);
     CoreServices::updateSignalChain (this);
 }
@@ -197,10 +228,57 @@ void FileReaderEditor::populateRecordings (FileSource* source)
 }
 
 
+void FileReaderEditor::populateMarkers (float sampleRate)
+{
+    markerSampleRate = sampleRate;
+    showMarkerPage (0);
+}
+
+
+void FileReaderEditor::showMarkerPage (int firstMarker)
+{
+    markerSelector->clear (dontSendNotification);
+
+    const FileSeekIndex* index = fileReader->getSeekIndex();
+    if (index == nullptr)
+        return;
+
+    // markers have their index + 1 as id, the page items the two ids after them
+    const int numMarkers = index->getNumMarkers();
+    markerPageStart = jlimit (0, jmax (0, numMarkers - 1), firstMarker);
+    const int pageEnd = jmin (numMarkers, markerPageStart + maxListedMarkers);
+
+    if (numMarkers > maxListedMarkers)
+        markerSelector->addSectionHeading ("Events " + String (markerPageStart + 1) + " to " + String (pageEnd)
+                                           + " of " + String (numMarkers));
+
+    if (markerPageStart > 0)
+        markerSelector->addItem ("Previous " + String (jmin (markerPageStart, maxListedMarkers)) + " events", numMarkers + 1);
+
+    for (int i = markerPageStart; i < pageEnd; ++i)
+    {
+        const FileSeekIndex::Marker& marker = index->getMarker (i);
+        const RelativeTime time (marker.sample / double (markerSampleRate));
+
+        String text;
+        text << String (int (time.inHours())).paddedLeft ('0', 2)
+             << ":" << String (int (time.inMinutes()) % 60).paddedLeft ('0', 2)
+             << ":" << String (std::fmod (time.inSeconds(), 60.0), 3).paddedLeft ('0', 6)
+             << "  " << marker.getDescription();
+
+        markerSelector->addItem (text, i + 1);
+    }
+
+    if (pageEnd < numMarkers)
+        markerSelector->addItem ("Next " + String (jmin (numMarkers - pageEnd, maxListedMarkers)) + " events", numMarkers + 2);
+}
+
+
 void FileReaderEditor::clearEditor()
 {
     fileNameLabel->setText ("No file selected.", dontSendNotification);
     recordSelector->clear (dontSendNotification);
+    markerSelector->clear (dontSendNotification);
 
     timeLimits->setTimeMilliseconds     (0, 0);
     timeLimits->setTimeMilliseconds     (1, 0);
@@ -236,6 +314,9 @@ void FileReaderEditor::saveCustomParameters (XmlElement* xml)
     childNode = xml->createNewChildElement ("TIME_LIMITS");
     childNode->setAttribute ("start_time",  (double)timeLimits->getTimeMilliseconds (0));
     childNode->setAttribute ("stop_time",   (double)timeLimits->getTimeMilliseconds (1));
+
+    childNode = xml->createNewChildElement ("READ_AHEAD");
+    childNode->setAttribute ("blocks", fileReader->getReadAheadBlocks());
 }
 
 
@@ -263,6 +344,10 @@ void FileReaderEditor::loadCustomParameters (XmlElement* xml)
             setPlaybackStopTime (time);
             timeLimits->setTimeMilliseconds (1, time);
         }
+        else if (element->hasTagName ("READ_AHEAD"))
+        {
+            fileReader->setReadAheadBlocks (element->getIntAttribute ("blocks", DEFAULT_READ_AHEAD_BLOCKS));
+        }
     }
 }
 
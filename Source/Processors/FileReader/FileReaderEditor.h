@@ -31,6 +31,7 @@
 class FileReader;
 class DualTimeComponent;
 class FileSource;
+class FileSeekIndex;
 
 /**
 
@@ -75,20 +76,33 @@ public:
     void comboBoxChanged (ComboBox* combo);
     void populateRecordings (FileSource* source);
 
+    /** Lists the markers of the seek index of the active recording, selecting one jumps to it */
+    void populateMarkers (float sampleRate);
+
+    /** Markers listed at a time. Longer lists are split in pages, with items to go to the next and previous ones */
+    static const int maxListedMarkers = 1000;
+
 
 private:
     void clearEditor();
 
+    /** Lists the markers from firstMarker on */
+    void showMarkerPage (int firstMarker);
+
 
     ScopedPointer<UtilityButton>        fileButton;
     ScopedPointer<Label>                fileNameLabel;
     ScopedPointer<ComboBox>             recordSelector;
+    ScopedPointer<ComboBox>             markerSelector;
     ScopedPointer<DualTimeComponent>    currentTime;
     ScopedPointer<DualTimeComponent>    timeLimits;
 
     FileReader* fileReader;
     unsigned int recTotalTime;
 
+    float markerSampleRate;
+    int markerPageStart;
+
     bool m_isFileDragAndDropActive;
 
     File lastFilePath;
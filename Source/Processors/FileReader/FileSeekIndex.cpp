@@ -0,0 +1,455 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FileSeekIndex.h"
+#include <algorithm>
+#include <cstdlib>
+
+const char* const FileSeekIndex::indexFileName = "seek_index.bin";
+
+namespace
+{
+    const int indexMagic = 0x4953454f; // "OESI"
+    const int indexVersion = 1;
+
+    /** Memory maps a .npy file and locates the data following its header */
+    class NpyData
+    {
+    public:
+        NpyData (const File& file)
+            : m_data        (nullptr)
+            , m_dataSize    (0)
+        {
+            if (! file.existsAsFile())
+                return;
+
+            m_file = new MemoryMappedFile (file, MemoryMappedFile::readOnly);
+
+            const char* bytes = static_cast<const char*> (m_file->getData());
+            const size_t fileSize = m_file->getSize();
+            if (bytes == nullptr || fileSize < 12 || memcmp (bytes, "\x93NUMPY", 6) != 0)
+                return;
+
+            // the header length field grew from 16 to 32 bits in version 2
+            const size_t headerStart = (bytes[6] == 1) ? 10 : 12;
+            const size_t headerEnd = headerStart + ((bytes[6] == 1) ? ByteOrder::littleEndianShort (bytes + 8)
+                                                                    : ByteOrder::littleEndianInt (bytes + 8));
+            if (headerEnd > fileSize)
+                return;
+
+            m_header = String::fromUTF8 (bytes + headerStart, int (headerEnd - headerStart));
+            m_data = bytes + headerEnd;
+            m_dataSize = int64 (fileSize - headerEnd);
+        }
+
+        bool isValid() const { return m_data != nullptr; }
+
+        const void* getData() const { return m_data; }
+
+        /** Complete items in the data, which can be more than the header shape if the file wasn't closed */
+        int64 getNumItems (int itemSize) const { return itemSize > 0 ? m_dataSize / itemSize : 0; }
+
+        /** Length of byte string items, such as "|S256" */
+        int getStringLength() const
+        {
+            return m_header.fromFirstOccurrenceOf ("'descr'", false, false)
+                           .fromFirstOccurrenceOf ("S", false, false).getIntValue();
+        }
+
+    private:
+        ScopedPointer<MemoryMappedFile> m_file;
+        String m_header;
+        const char* m_data;
+        int64 m_dataSize;
+    };
+
+    struct MarkerSorter
+    {
+        static int compareElements (const FileSeekIndex::Marker& first, const FileSeekIndex::Marker& second)
+        {
+            return (first.sample < second.sample) ? -1 : ((second.sample < first.sample) ? 1 : 0);
+        }
+    };
+}
+
+
+String FileSeekIndex::Marker::getDescription() const
+{
+    switch (type)
+    {
+        case TTL_MARKER:    return "TTL " + String (channel + 1) + (state ? " on" : " off");
+        case SYNC_MARKER:   return "Sync";
+        default:            return text.substring (0, 32);
+    }
+}
+
+
+FileSeekIndex::FileSeekIndex()
+{
+}
+
+
+FileSeekIndex::~FileSeekIndex()
+{
+}
+
+
+int FileSeekIndex::findRun (int64 sample) const
+{
+    int first = 0;
+    int last = m_runs.size();
+
+    while (last - first > 1)
+    {
+        const int middle = (first + last) / 2;
+        if (m_runs.getReference (middle).sample <= sample)
+            first = middle;
+        else
+            last = middle;
+    }
+
+    return first;
+}
+
+
+int64 FileSeekIndex::getTimestampForSample (int64 sample) const
+{
+    if (m_runs.size() == 0)
+        return sample;
+
+    const TimestampRun& run = m_runs.getReference (findRun (sample));
+    return run.timestamp + (sample - run.sample);
+}
+
+
+int64 FileSeekIndex::getSampleForTimestamp (int64 timestamp) const
+{
+    if (m_runs.size() == 0)
+        return timestamp;
+
+    // timestamps increase with the samples, so the runs are sorted by both
+    int first = 0;
+    int last = m_runs.size();
+
+    while (last - first > 1)
+    {
+        const int middle = (first + last) / 2;
+        if (m_runs.getReference (middle).timestamp <= timestamp)
+            first = middle;
+        else
+            last = middle;
+    }
+
+    const TimestampRun& run = m_runs.getReference (first);
+    const int64 sample = run.sample + jmax (int64 (0), timestamp - run.timestamp);
+
+    if (first + 1 < m_runs.size())
+        return jmin (sample, m_runs.getReference (first + 1).sample);
+
+    return sample;
+}
+
+
+int FileSeekIndex::getNumTimestampGaps() const
+{
+    return jmax (0, m_runs.size() - 1);
+}
+
+
+int FileSeekIndex::getNumMarkers() const
+{
+    return m_markers.size();
+}
+
+
+const FileSeekIndex::Marker& FileSeekIndex::getMarker (int index) const
+{
+    return m_markers.getReference (index);
+}
+
+
+int FileSeekIndex::findMarker (int64 sample) const
+{
+    int first = 0;
+    int last = m_markers.size();
+
+    while (first < last)
+    {
+        const int middle = (first + last) / 2;
+        if (m_markers.getReference (middle).sample < sample)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    return (first < m_markers.size()) ? first : -1;
+}
+
+
+void FileSeekIndex::addTimestampRuns (const int64* timestamps, int64 first, int64 last)
+{
+    // timestamps increase, so a range is a single run when they span exactly its length.
+    // Bisecting only visits the pages around the gaps instead of reading the whole file
+    if (timestamps[last] - timestamps[first] == last - first)
+        return;
+
+    if (last - first == 1)
+    {
+        TimestampRun run = { last, timestamps[last] };
+        m_runs.add (run);
+        return;
+    }
+
+    const int64 middle = first + (last - first) / 2;
+    addTimestampRuns (timestamps, first, middle);
+    addTimestampRuns (timestamps, middle, last);
+}
+
+
+void FileSeekIndex::addMarker (MarkerType type, int64 timestamp, int channel, bool state, const String& text)
+{
+    Marker marker;
+    marker.type = type;
+    marker.timestamp = timestamp;
+    marker.sample = getSampleForTimestamp (timestamp);
+    marker.channel = channel;
+    marker.state = state;
+    marker.text = text;
+
+    m_markers.add (marker);
+}
+
+
+void FileSeekIndex::addEvents (const File& recordingDirectory, const String& recordFolder)
+{
+    var events = JSON::parse (recordingDirectory.getChildFile ("structure.oebin"))["events"];
+    const File eventDirectory = recordingDirectory.getChildFile ("events");
+
+    for (int i = 0; i < events.size(); ++i)
+    {
+        const String folderName = events[i]["folder_name"].toString().trimCharactersAtEnd ("/");
+        const String groupName = folderName.fromLastOccurrenceOf ("/", false, false);
+        const File folder = eventDirectory.getChildFile (folderName);
+
+        NpyData timestampData (folder.getChildFile ("timestamps.npy"));
+        if (! timestampData.isValid())
+            continue;
+
+        const int64* timestamps = static_cast<const int64*> (timestampData.getData());
+
+        // TTL events of the record's own source, text events of any processor since they are annotations
+        if (groupName.startsWith ("TTL") && folderName.startsWith (recordFolder + "/"))
+        {
+            NpyData stateData (folder.getChildFile ("channel_states.npy"));
+            const int16* states = static_cast<const int16*> (stateData.getData());
+            const int64 numEvents = jmin (timestampData.getNumItems (sizeof (int64)), stateData.getNumItems (sizeof (int16)));
+
+            // states are the channel number, positive when the line goes high
+            for (int64 e = 0; e < numEvents; ++e)
+                addMarker (TTL_MARKER, timestamps[e], std::abs (states[e]) - 1, states[e] > 0, String::empty);
+        }
+        else if (groupName.startsWith ("TEXT"))
+        {
+            NpyData textData (folder.getChildFile ("text.npy"));
+            const int length = textData.getStringLength();
+            const char* text = static_cast<const char*> (textData.getData());
+            const int64 numEvents = jmin (timestampData.getNumItems (sizeof (int64)), textData.getNumItems (length));
+
+            for (int64 e = 0; e < numEvents; ++e)
+            {
+                const char* item = text + e * length;
+                addMarker (TEXT_MARKER, timestamps[e], 0, false,
+                           String::fromUTF8 (item, int (std::find (item, item + length, '\0') - item)));
+            }
+        }
+    }
+}
+
+
+void FileSeekIndex::addSyncMessages (const File& syncFile, int processorId, int subProcessorIdx)
+{
+    StringArray lines;
+    syncFile.readLines (lines);
+
+    // "Processor: <name> Id: <id> subProcessor: <index> start time: <timestamp>@<rate>Hz"
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const String& line = lines[i];
+        if (! line.startsWith ("Processor:"))
+            continue;
+
+        const int id = line.fromLastOccurrenceOf (" Id: ", false, false).getIntValue();
+        const int subIdx = line.fromLastOccurrenceOf ("subProcessor: ", false, false).getIntValue();
+        if (id != processorId || subIdx != subProcessorIdx)
+            continue;
+
+        const int64 timestamp = line.fromLastOccurrenceOf ("start time: ", false, false)
+                                    .upToFirstOccurrenceOf ("@", false, false).getLargeIntValue();
+        addMarker (SYNC_MARKER, timestamp, 0, false, line);
+    }
+}
+
+
+void FileSeekIndex::sortMarkers()
+{
+    MarkerSorter sorter;
+    m_markers.sort (sorter, true);
+}
+
+
+bool FileSeekIndex::writeToFile (const File& file, const String& sourceKey) const
+{
+    TemporaryFile temp (file);
+    {
+        FileOutputStream out (temp.getFile());
+        if (out.failedToOpen())
+            return false;
+
+        out.writeInt (indexMagic);
+        out.writeInt (indexVersion);
+        out.writeString (sourceKey);
+
+        out.writeInt (m_runs.size());
+        for (int i = 0; i < m_runs.size(); ++i)
+        {
+            out.writeInt64 (m_runs.getReference (i).sample);
+            out.writeInt64 (m_runs.getReference (i).timestamp);
+        }
+
+        out.writeInt (m_markers.size());
+        for (int i = 0; i < m_markers.size(); ++i)
+        {
+            const Marker& marker = m_markers.getReference (i);
+            out.writeByte (char (marker.type));
+            out.writeInt64 (marker.timestamp);
+            out.writeInt64 (marker.sample);
+            out.writeInt (marker.channel);
+            out.writeBool (marker.state);
+            out.writeString (marker.text);
+        }
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+
+bool FileSeekIndex::readFromFile (const File& file, const String& sourceKey)
+{
+    FileInputStream in (file);
+    if (in.failedToOpen()
+        || in.readInt() != indexMagic
+        || in.readInt() != indexVersion
+        || in.readString() != sourceKey)
+        return false;
+
+    // each run takes 16 bytes and each marker at least 22
+    const int numRuns = in.readInt();
+    if (numRuns < 0 || numRuns > in.getNumBytesRemaining() / 16)
+        return false;
+
+    m_runs.ensureStorageAllocated (numRuns);
+    for (int i = 0; i < numRuns; ++i)
+    {
+        TimestampRun run;
+        run.sample = in.readInt64();
+        run.timestamp = in.readInt64();
+        m_runs.add (run);
+    }
+
+    const int numMarkers = in.readInt();
+    if (numMarkers < 0 || numMarkers > in.getNumBytesRemaining() / 22)
+        return false;
+
+    m_markers.ensureStorageAllocated (numMarkers);
+    for (int i = 0; i < numMarkers; ++i)
+    {
+        Marker marker;
+        marker.type = MarkerType (in.readByte());
+        marker.timestamp = in.readInt64();
+        marker.sample = in.readInt64();
+        marker.channel = in.readInt();
+        marker.state = in.readBool();
+        marker.text = in.readString();
+        m_markers.add (marker);
+    }
+
+    return true;
+}
+
+
+FileSeekIndex* FileSeekIndex::openBinaryRecording (const File& recordingDirectory, const var& continuousInfo)
+{
+    const String recordFolder = continuousInfo["folder_name"].toString().trimCharactersAtEnd ("/");
+    const File dataDirectory = recordingDirectory.getChildFile ("continuous").getChildFile (recordFolder);
+    const File runFile = dataDirectory.getChildFile ("timestamp_runs.npy");
+    const File timestampFile = runFile.existsAsFile() ? runFile : dataDirectory.getChildFile ("timestamps.npy");
+    const File structureFile = recordingDirectory.getChildFile ("structure.oebin");
+    const File syncFile = recordingDirectory.getChildFile ("sync_messages.txt");
+    const File indexFile = dataDirectory.getChildFile (indexFileName);
+
+    // the saved index is only reused for the files it was built from
+    String sourceKey;
+    sourceKey << recordFolder
+              << ";" << timestampFile.getSize() << ";" << timestampFile.getLastModificationTime().toMilliseconds()
+              << ";" << structureFile.getLastModificationTime().toMilliseconds()
+              << ";" << syncFile.getSize();
+
+    ScopedPointer<FileSeekIndex> index = new FileSeekIndex();
+    if (index->readFromFile (indexFile, sourceKey))
+        return index.release();
+
+    index = new FileSeekIndex();
+
+    NpyData timestampData (timestampFile);
+    const int64 numTimestamps = timestampData.getNumItems (sizeof (int64));
+    if (timestampFile == runFile)
+    {
+        // written in run-length mode, the rows already are the runs
+        const TimestampRun* runs = static_cast<const TimestampRun*> (timestampData.getData());
+        const int64 numRuns = timestampData.getNumItems (sizeof (TimestampRun));
+
+        for (int64 r = 0; r < numRuns; ++r)
+            index->m_runs.add (runs[r]);
+    }
+    else if (numTimestamps > 0)
+    {
+        const int64* timestamps = static_cast<const int64*> (timestampData.getData());
+
+        TimestampRun firstRun = { 0, timestamps[0] };
+        index->m_runs.add (firstRun);
+        index->addTimestampRuns (timestamps, 0, numTimestamps - 1);
+    }
+
+    index->addEvents (recordingDirectory, recordFolder);
+    index->addSyncMessages (syncFile, continuousInfo["source_processor_id"], continuousInfo["source_processor_sub_idx"]);
+    index->sortMarkers();
+
+    if (! index->writeToFile (indexFile, sourceKey))
+        std::cout << "Could not save the seek index to " << indexFile.getFullPathName() << std::endl;
+
+    return index.release();
+}
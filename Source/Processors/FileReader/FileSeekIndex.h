@@ -0,0 +1,117 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef FILESEEKINDEX_H_INCLUDED
+#define FILESEEKINDEX_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+
+/**
+    Maps the timestamps and the events of a recording to sample positions in its
+    continuous data, so the FileReader can jump anywhere without scanning the files.
+
+    Timestamps are stored as runs of consecutive values, so a recording without
+    dropped samples is a single run, and conversions are a binary search over the
+    runs. Markers are the TTL and text events and the sync messages of the recording,
+    sorted by sample.
+
+    The index of a recording in the Binary layout is built the first time it is
+    opened and saved next to its continuous data, then loaded from there as long as
+    the timestamp and structure files are unchanged.
+
+    @see FileSource, FileReader
+*/
+class PLUGIN_API FileSeekIndex
+{
+public:
+    enum MarkerType
+    {
+        TTL_MARKER = 0,
+        TEXT_MARKER,
+        SYNC_MARKER
+    };
+
+    struct Marker
+    {
+        MarkerType type;
+        int64 timestamp;
+        int64 sample;
+        int channel;
+        bool state;
+        String text;
+
+        /** Short description for menus, such as "TTL 3 on" */
+        String getDescription() const;
+    };
+
+    FileSeekIndex();
+    ~FileSeekIndex();
+
+    /** First sample at or after the timestamp. Timestamps in a gap map to the sample after it */
+    int64 getSampleForTimestamp (int64 timestamp) const;
+    int64 getTimestampForSample (int64 sample) const;
+
+    /** Number of discontinuities in the timestamps */
+    int getNumTimestampGaps() const;
+
+    int getNumMarkers() const;
+    const Marker& getMarker (int index) const;
+
+    /** Index of the first marker at or after the sample, or -1 if there is none */
+    int findMarker (int64 sample) const;
+
+    /** Loads the saved index of a continuous record in the Binary layout, or builds and saves it.
+        continuousInfo is the record's entry in the "continuous" list of structure.oebin */
+    static FileSeekIndex* openBinaryRecording (const File& recordingDirectory, const var& continuousInfo);
+
+    static const char* const indexFileName;
+
+private:
+    struct TimestampRun
+    {
+        int64 sample;
+        int64 timestamp;
+    };
+
+    /** Index of the last run starting at or before the sample */
+    int findRun (int64 sample) const;
+
+    void addTimestampRuns (const int64* timestamps, int64 first, int64 last);
+    void addEvents (const File& recordingDirectory, const String& recordFolder);
+    void addSyncMessages (const File& syncFile, int processorId, int subProcessorIdx);
+    void addMarker (MarkerType type, int64 timestamp, int channel, bool state, const String& text);
+    void sortMarkers();
+
+    bool readFromFile (const File& file, const String& sourceKey);
+    bool writeToFile (const File& file, const String& sourceKey) const;
+
+    Array<TimestampRun> m_runs;
+    Array<Marker> m_markers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FileSeekIndex);
+};
+
+
+#endif  // FILESEEKINDEX_H_INCLUDED
@@ -23,6 +23,11 @@
 
 #include "FileSource.h"
 
+#if JUCE_INTEL
+ #include <emmintrin.h>
+ #define FILESOURCE_USE_SSE 1
+#endif
+
 
 FileSource::FileSource() 
     : fileOpened    (false)
@@ -146,3 +151,40 @@ bool FileSource::isReady()
 {
     return true;
 }
+
+
+const FileSeekIndex* FileSource::getSeekIndex() const
+{
+    return nullptr;
+}
+
+
+void FileSource::convertChannelData (const int16* inBuffer, float* outBuffer, int numChannels, int channel,
+                                     int64 numSamples, float bitVolts)
+{
+    const int16* in = inBuffer + channel;
+    const int64 n = numChannels;
+    int64 i = 0;
+
+   #if FILESOURCE_USE_SSE
+    const __m128 scale = _mm_set1_ps (bitVolts);
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const int16* s = in + i * n;
+        const __m128i packed = (n == 1) ? _mm_loadu_si128 (reinterpret_cast<const __m128i*> (s))
+                                        : _mm_set_epi16 (s[7 * n], s[6 * n], s[5 * n], s[4 * n],
+                                                         s[3 * n], s[2 * n], s[n], s[0]);
+
+        // duplicating each value into both halves of a 32 bit lane and shifting back sign-extends it
+        const __m128i low = _mm_srai_epi32 (_mm_unpacklo_epi16 (packed, packed), 16);
+        const __m128i high = _mm_srai_epi32 (_mm_unpackhi_epi16 (packed, packed), 16);
+
+        _mm_storeu_ps (outBuffer + i, _mm_mul_ps (_mm_cvtepi32_ps (low), scale));
+        _mm_storeu_ps (outBuffer + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (high), scale));
+    }
+   #endif
+
+    for (; i < numSamples; ++i)
+        outBuffer[i] = in[i * n] * bitVolts;
+}
@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../PluginManager/OpenEphysPlugin.h"
 
+class FileSeekIndex;
 
 struct RecordedChannelInfo
 {
@@ -64,12 +65,22 @@ public:
     String getFileName() const;
 
     virtual int readData (int16* buffer, int nSamples) = 0;
+
+    /** Converts one channel of the interleaved samples returned by readData. Built-in sources
+        can be called concurrently for different channels of the same buffer */
     virtual void processChannelData (int16* inBuffer, float* outBuffer, int channel, int64 numSamples) = 0;
     virtual void seekTo (int64 sample) = 0;
 
     virtual bool isReady();
 
+    /** Index of the timestamps and events of the active record, or nullptr if the source has none */
+    virtual const FileSeekIndex* getSeekIndex() const;
+
 protected:
+    /** Extracts one channel of interleaved int16 samples and scales it to float, with SIMD where available */
+    static void convertChannelData (const int16* inBuffer, float* outBuffer, int numChannels, int channel,
+                                    int64 numSamples, float bitVolts);
+
     struct RecordInfo
     {
         String name;
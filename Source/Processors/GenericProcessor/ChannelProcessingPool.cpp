@@ -0,0 +1,120 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2014 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ChannelProcessingPool.h"
+#include "GenericProcessor.h"
+
+ChannelProcessingPool::Worker::Worker(ChannelProcessingPool& pool, int index)
+	: Thread("Channel processing " + String(index)),
+	m_pool(pool)
+{
+}
+
+void ChannelProcessingPool::Worker::run()
+{
+	while (!threadShouldExit())
+	{
+		jobStart.wait();
+
+		if (threadShouldExit())
+			break;
+
+		m_pool.processChunks();
+		--m_pool.m_activeWorkers;
+	}
+}
+
+ChannelProcessingPool::ChannelProcessingPool()
+	: m_processor(nullptr),
+	m_buffer(nullptr),
+	m_numChannels(0),
+	m_chunkSize(1),
+	m_numChunks(0)
+{
+	const int numWorkers = SystemStats::getNumCpus() - 1;
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		Worker* worker = new Worker(*this, i + 1);
+		m_workers.add(worker);
+		worker->startThread(9);
+	}
+}
+
+ChannelProcessingPool::~ChannelProcessingPool()
+{
+	for (int i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->signalThreadShouldExit();
+		m_workers[i]->jobStart.signal();
+	}
+
+	for (int i = 0; i < m_workers.size(); i++)
+		m_workers[i]->stopThread(1000);
+}
+
+int ChannelProcessingPool::getNumThreads() const
+{
+	return m_workers.size() + 1;
+}
+
+bool ChannelProcessingPool::process(GenericProcessor* processor, AudioSampleBuffer& buffer, int numChannels, int chunkSize)
+{
+	const GenericScopedTryLock<SpinLock> lock(m_jobLock);
+	if (!lock.isLocked())
+		return false;
+
+	m_processor = processor;
+	m_buffer = &buffer;
+	m_numChannels = numChannels;
+	m_chunkSize = jmax(1, chunkSize);
+	m_numChunks = (numChannels + m_chunkSize - 1) / m_chunkSize;
+	m_nextChunk = 0;
+
+	// only wake as many workers as there are ranges left for them
+	const int numWorkers = jmin(m_workers.size(), m_numChunks - 1);
+	m_activeWorkers = numWorkers;
+
+	for (int i = 0; i < numWorkers; i++)
+		m_workers.getUnchecked(i)->jobStart.signal();
+
+	processChunks();
+
+	// the job can't be released until every worker is done with it
+	while (m_activeWorkers.get() > 0)
+		Thread::yield();
+
+	m_processor = nullptr;
+	m_buffer = nullptr;
+	return true;
+}
+
+void ChannelProcessingPool::processChunks()
+{
+	int chunk;
+	while ((chunk = ++m_nextChunk - 1) < m_numChunks)
+	{
+		const int startChannel = chunk * m_chunkSize;
+		m_processor->processChannelRange(*m_buffer, startChannel, jmin(m_chunkSize, m_numChannels - startChannel));
+	}
+}
@@ -0,0 +1,86 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2014 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHANNELPROCESSINGPOOL_H_INCLUDED
+#define CHANNELPROCESSINGPOOL_H_INCLUDED
+
+#include <JuceHeader.h>
+
+class GenericProcessor;
+
+/**
+	Persistent threads that run the per-channel kernels of the processors that
+	enable channel-parallel processing (see GenericProcessor::processChannelsInParallel).
+
+	The pool is shared by all processors through a SharedResourcePointer, and
+	exists as long as one of them does. A block is split into contiguous ranges of
+	channels, so every thread works on neighbouring buffers and filter states. The
+	calling thread processes ranges too, and returns once all of them are done.
+
+	Only one processor uses the pool at a time. If the pool is busy (e.g., with the
+	graph running branches on several threads), the caller processes its channels
+	itself, which gives the same result.
+*/
+class ChannelProcessingPool
+{
+public:
+	ChannelProcessingPool();
+	~ChannelProcessingPool();
+
+	/** Returns the number of threads that process ranges, including the caller */
+	int getNumThreads() const;
+
+	/** Calls processChannelRange on processor for channels [0, numChannels) in ranges of at most
+	chunkSize channels. Returns false without processing anything if the pool is busy */
+	bool process(GenericProcessor* processor, AudioSampleBuffer& buffer, int numChannels, int chunkSize);
+
+private:
+	class Worker : public Thread
+	{
+	public:
+		Worker(ChannelProcessingPool& pool, int index);
+		void run() override;
+
+		WaitableEvent jobStart;
+
+	private:
+		ChannelProcessingPool& m_pool;
+	};
+
+	void processChunks();
+
+	OwnedArray<Worker> m_workers;
+	SpinLock m_jobLock;
+
+	GenericProcessor* m_processor;
+	AudioSampleBuffer* m_buffer;
+	int m_numChannels;
+	int m_chunkSize;
+	int m_numChunks;
+	Atomic<int> m_nextChunk;
+	Atomic<int> m_activeWorkers;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelProcessingPool);
+};
+
+#endif
@@ -21,10 +21,13 @@
 
 	*/
 #include "GenericProcessor.h"
+#include "ChannelProcessingPool.h"
 #include "../../UI/UIComponent.h"
 #include "../../AccessClass.h"
 
 #include <exception>
+#include <algorithm>
+#include <vector>
 
 
 const String GenericProcessor::m_unusedNameString("xxx-UNUSED-OPEN-EPHYS-xxx");
@@ -409,8 +412,14 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 	dataChannelMap.clear();
 	eventChannelMap.clear();
 	spikeChannelMap.clear();
+	m_channelSourceBlocks.clearQuick();
 	unsigned int nChans;
 
+	//Register this processor's own sources too, for setTimestampAndSamples
+	int nSubs = getNumSubProcessors();
+	for (int sub = 0; sub < nSubs; sub++)
+		addSourceBlock(getProcessorFullId(nodeId, sub));
+
 	nChans = dataChannelArray.size();
 	for (int i = 0; i < nChans; i++)
 	{
@@ -424,6 +433,7 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 		}
 		uint32 sourceID = getProcessorFullId(channel->getSourceNodeID(), channel->getSubProcessorIdx());
 		dataChannelMap[sourceID][channel->getSourceIndex()] = i;
+		m_channelSourceBlocks.add(addSourceBlock(sourceID));
 	}
 	nChans = eventChannelArray.size();
 	for (int i = 0; i < nChans; i++)
@@ -575,67 +585,62 @@ void GenericProcessor::disableEditor()
 /** Used to get the number of samples in a given buffer, for a given channel. */
 uint32 GenericProcessor::getNumSamples(int channelNum) const
 {
-	int sourceNodeId = 0;
-	int subProcessorId = 0;
-	int nSamples = 0;
-
-	if (channelNum >= 0
-		&& channelNum < dataChannelArray.size())
-	{
-		sourceNodeId = dataChannelArray[channelNum]->getSourceNodeID();
-		subProcessorId = dataChannelArray[channelNum]->getSubProcessorIdx();
-	}
-	else
-	{
+	int index = getChannelSourceBlockIndex(channelNum);
+	if (index < 0)
 		return 0;
-	}
-
-	// std::cout << "Requesting samples for channel " << channelNum << " with source node " << sourceNodeId << std::endl;
-	uint32 sourceID = getProcessorFullId(sourceNodeId, subProcessorId);
-	try
-	{
-		nSamples = numSamples.at(sourceID);
-	}
-	catch (...)
-	{
-		return 0;
-	}
 
-	//std::cout << nSamples << " were found." << std::endl;
-
-	return nSamples;
+	return m_sourceBlocks.getReference(index).numSamples;
 }
 
 
 /** Used to get the timestamp for a given buffer, for a given source node. */
 juce::uint64 GenericProcessor::getTimestamp(int channelNum) const
 {
-	int sourceNodeId = 0;
-	int subProcessorIdx = 0;
-	int64 ts = 0;
-
-	if (channelNum >= 0
-		&& channelNum < dataChannelArray.size())
-	{
-		sourceNodeId = dataChannelArray[channelNum]->getSourceNodeID();
-		subProcessorIdx = dataChannelArray[channelNum]->getSubProcessorIdx();
-	}
-	else
-	{
+	int index = getChannelSourceBlockIndex(channelNum);
+	if (index < 0)
 		return 0;
-	}
 
-	uint32 sourceID = getProcessorFullId(sourceNodeId, subProcessorIdx);
-	try
+	return m_sourceBlocks.getReference(index).timestamp;
+}
+
+int GenericProcessor::getChannelSourceBlockIndex(int channelNum) const
+{
+	if (channelNum < 0 || channelNum >= dataChannelArray.size())
+		return -1;
+
+	//The table is only stale if channels were added or removed without calling updateChannelIndexes
+	if (m_channelSourceBlocks.size() == dataChannelArray.size())
+		return m_channelSourceBlocks.getUnchecked(channelNum);
+
+	const DataChannel* chan = dataChannelArray[channelNum];
+	return getSourceBlockIndex(getProcessorFullId(chan->getSourceNodeID(), chan->getSubProcessorIdx()));
+}
+
+int GenericProcessor::getSourceBlockIndex(uint32 sourceID) const
+{
+	//There are only a few sources per processor, so a linear search is faster than any map
+	int nSources = m_sourceBlocks.size();
+	for (int i = 0; i < nSources; i++)
 	{
-		ts = timestamps.at(sourceID);
+		if (m_sourceBlocks.getReference(i).sourceID == sourceID)
+			return i;
 	}
-	catch (...)
+	return -1;
+}
+
+int GenericProcessor::addSourceBlock(uint32 sourceID)
+{
+	int index = getSourceBlockIndex(sourceID);
+	if (index < 0)
 	{
-		return 0;
+		SourceBlockInfo info;
+		info.sourceID = sourceID;
+		info.timestamp = 0;
+		info.numSamples = 0;
+		m_sourceBlocks.add(info);
+		index = m_sourceBlocks.size() - 1;
 	}
-
-	return ts;
+	return index;
 }
 
 uint32 GenericProcessor::getNumSourceSamples(uint16 processorID, uint16 subProcessorIdx) const
@@ -645,16 +650,10 @@ uint32 GenericProcessor::getNumSourceSamples(uint16 processorID, uint16 subProce
 
 uint32 GenericProcessor::getNumSourceSamples(uint32 fullSourceID) const
 {
-	uint32 nSamples;
-	try
-	{
-		nSamples = numSamples.at(fullSourceID);
-	}
-	catch (...)
-	{
+	int index = getSourceBlockIndex(fullSourceID);
+	if (index < 0)
 		return 0;
-	}
-	return nSamples;
+	return m_sourceBlocks.getReference(index).numSamples;
 }
 
 juce::uint64 GenericProcessor::getSourceTimestamp(uint16 processorID, uint16 subProcessorIdx) const
@@ -664,16 +663,10 @@ juce::uint64 GenericProcessor::getSourceTimestamp(uint16 processorID, uint16 sub
 
 juce::uint64 GenericProcessor::getSourceTimestamp(uint32 fullSourceID) const
 {
-	juce::uint64 ts;
-	try
-	{
-		ts = timestamps.at(fullSourceID);
-	}
-	catch (...)
-	{
+	int index = getSourceBlockIndex(fullSourceID);
+	if (index < 0)
 		return 0;
-	}
-	return ts;
+	return m_sourceBlocks.getReference(index).timestamp;
 }
 
 
@@ -692,9 +685,10 @@ void GenericProcessor::setTimestampAndSamples(juce::uint64 timestamp, uint32 nSa
 
 	uint32 sourceID = getProcessorFullId(nodeId, subProcessorIdx);
 
-	//since the processor generating the timestamp won't get the event, add it to the map
-	timestamps[sourceID] = timestamp;
-	numSamples[sourceID] = nSamples;
+	//since the processor generating the timestamp won't get the event, add it to the table
+	SourceBlockInfo& info = m_sourceBlocks.getReference(addSourceBlock(sourceID));
+	info.timestamp = timestamp;
+	info.numSamples = nSamples;
 
 	if (m_needsToSendTimestampMessages[subProcessorIdx] && nSamples > 0)
 	{
@@ -707,7 +701,6 @@ void GenericProcessor::setTimestampAndSamples(juce::uint64 timestamp, uint32 nSa
 	}
 }
 
-
 int GenericProcessor::processEventBuffer()
 {
 	//
@@ -742,8 +735,10 @@ int GenericProcessor::processEventBuffer()
 
 				juce::uint64 timestamp = *reinterpret_cast<const juce::uint64*>(dataptr + 8);
 				uint32 nSamples = *reinterpret_cast<const uint32*>(dataptr + 16);
-				numSamples[sourceID] = nSamples;
-				timestamps[sourceID] = timestamp;
+				//sources are registered in updateChannelIndexes, so this only adds to the table for sources without data channels
+				SourceBlockInfo& info = m_sourceBlocks.getReference(addSourceBlock(sourceID));
+				info.numSamples = nSamples;
+				info.timestamp = timestamp;
 			}
 			//set the "recorded" bit on the first byte. This will go away when the probe system is implemented.
 			//doing a const cast is always a bad idea, but there's no better way to do this until whe change the event record system
@@ -760,46 +755,54 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 {
 	if (m_currentMidiBuffer->getNumEvents() > 0)
 	{
-		//Since adding events to the buffer inside this loop could be dangerous, create a temporal event buffer
-		//so any call to addEvent will operate on it;
-		MidiBuffer temporalEventBuffer;
+		//Since adding events to the buffer inside this loop could be dangerous, use a temporal event buffer
+		//so any call to addEvent will operate on it. It is kept between blocks to reuse its storage
+		m_temporalEventBuffer.clear();
 		MidiBuffer* originalEventBuffer = m_currentMidiBuffer;
-		m_currentMidiBuffer = &temporalEventBuffer;
+		m_currentMidiBuffer = &m_temporalEventBuffer;
 		// int m = midiMessages.getNumEvents();
 		//std::cout << m << " events received by node " << getNodeId() << std::endl;
 
 		MidiBuffer::Iterator i(*originalEventBuffer);
-		MidiMessage message(0xf4);
+		const uint8* dataptr;
+		int dataSize;
 
 		int samplePosition = 0;
 		i.setNextSamplePosition(samplePosition);
 
-		while (i.getNextEvent(message, samplePosition))
+		//Events are filtered by their raw header, so a MidiMessage (which allocates for any event
+		//larger than a few bytes) is only built for the events that are actually handled
+		while (i.getNextEvent(dataptr, dataSize, samplePosition))
 		{
-			uint16 sourceId = EventBase::getSourceID(message);
-			uint16 subProc = EventBase::getSubProcessorIdx(message);
-			uint16 index = EventBase::getSourceIndex(message);
-			if (EventBase::getBaseType(message) == EventType::PROCESSOR_EVENT)
+			//TODO: remove the mask when the probe system is implemented
+			EventType type = static_cast<EventType>(*(dataptr + 0) & 0x7F);
+			if (type == SPIKE_EVENT && !checkForSpikes)
+				continue;
+
+			uint16 sourceId = *reinterpret_cast<const uint16*>(dataptr + 2);
+			uint16 subProc = *reinterpret_cast<const uint16*>(dataptr + 4);
+			uint16 index = *reinterpret_cast<const uint16*>(dataptr + 6);
+			if (type == PROCESSOR_EVENT)
 			{
 				int eventIndex = getEventChannelIndex(index, sourceId, subProc);
 				if (eventIndex >= 0)
-					handleEvent(eventChannelArray[eventIndex], message, samplePosition);
+					handleEvent(eventChannelArray[eventIndex], MidiMessage(dataptr, dataSize, samplePosition), samplePosition);
 			}
-			else if (EventBase::getBaseType(message) == EventType::SYSTEM_EVENT && SystemEvent::getSystemEventType(message) == SystemEventType::TIMESTAMP_SYNC_TEXT)
+			else if (type == SYSTEM_EVENT && static_cast<SystemEventType>(*(dataptr + 1)) == TIMESTAMP_SYNC_TEXT)
 			{
-				handleTimestampSyncTexts(message);
+				handleTimestampSyncTexts(MidiMessage(dataptr, dataSize, samplePosition));
 			}
-			else if (checkForSpikes && EventBase::getBaseType(message) == EventType::SPIKE_EVENT)
+			else if (type == SPIKE_EVENT)
 			{
 				int spikeIndex = getSpikeChannelIndex(index, sourceId, subProc);
 				if (spikeIndex >= 0)
-					handleSpike(spikeChannelArray[index], message, samplePosition);
+					handleSpike(spikeChannelArray[spikeIndex], MidiMessage(dataptr, dataSize, samplePosition), samplePosition);
 			}
 		}
 		//Restore the original buffer pointer and, if some new event has been added here, copy it to the original buffer
 		m_currentMidiBuffer = originalEventBuffer;
-		if (temporalEventBuffer.getNumEvents() > 0)
-			m_currentMidiBuffer->addEvents(temporalEventBuffer, 0, -1, 0);
+		if (m_temporalEventBuffer.getNumEvents() > 0)
+			m_currentMidiBuffer->addEvents(m_temporalEventBuffer, 0, -1, 0);
 
 		return 0;
 	}
@@ -815,7 +818,7 @@ void GenericProcessor::addEvent(int channelIndex, const Event* event, int sample
 void GenericProcessor::addEvent(const EventChannel* channel, const Event* event, int sampleNum)
 {
 	size_t size = channel->getDataSize() + channel->getTotalEventMetaDataSize() + EVENT_BASE_SIZE;
-	HeapBlock<char> buffer(size);
+	char* buffer = getEventSerializationBuffer(size);
 	event->serialize(buffer, size);
 	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
 }
@@ -828,21 +831,150 @@ void GenericProcessor::addSpike(int channelIndex, const SpikeEvent* event, int s
 void GenericProcessor::addSpike(const SpikeChannel* channel, const SpikeEvent* event, int sampleNum)
 {
 	size_t size = channel->getDataSize() + channel->getTotalEventMetaDataSize() + SPIKE_BASE_SIZE + channel->getNumChannels()*sizeof(float);
-	HeapBlock<char> buffer(size);
+	char* buffer = getEventSerializationBuffer(size);
 	event->serialize(buffer, size);
 	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
 }
 
+void GenericProcessor::SpikeStaging::add(const SpikeChannel* channel, SpikeEvent* event, int sampleNum)
+{
+	events.add(event);
+	channels.add(channel);
+	sampleNums.add(sampleNum);
+}
+
+int GenericProcessor::SpikeStaging::size() const
+{
+	return events.size();
+}
+
+void GenericProcessor::SpikeStaging::clear()
+{
+	events.clear();
+	channels.clearQuick();
+	sampleNums.clearQuick();
+}
+
+namespace
+{
+	struct StagedSpikeRef
+	{
+		juce::int64 timestamp;
+		int staging;
+		int index;
+
+		bool operator<(const StagedSpikeRef& other) const
+		{
+			if (timestamp != other.timestamp)
+				return timestamp < other.timestamp;
+			if (staging != other.staging)
+				return staging < other.staging;
+			return index < other.index;
+		}
+	};
+}
+
+void GenericProcessor::addStagedSpikes(OwnedArray<SpikeStaging>& stagings)
+{
+	int total = 0;
+	for (int s = 0; s < stagings.size(); s++)
+		total += stagings[s]->size();
+
+	if (total > 0)
+	{
+		std::vector<StagedSpikeRef> order;
+		order.reserve(total);
+		for (int s = 0; s < stagings.size(); s++)
+		{
+			const SpikeStaging* staging = stagings[s];
+			for (int i = 0; i < staging->size(); i++)
+			{
+				StagedSpikeRef ref = { juce::int64(staging->events[i]->getTimestamp()), s, i };
+				order.push_back(ref);
+			}
+		}
+		std::sort(order.begin(), order.end());
+
+		for (size_t n = 0; n < order.size(); n++)
+		{
+			const SpikeStaging* staging = stagings[order[n].staging];
+			addSpike(staging->channels[order[n].index], staging->events[order[n].index], staging->sampleNums[order[n].index]);
+		}
+	}
+
+	for (int s = 0; s < stagings.size(); s++)
+		stagings[s]->clear();
+}
+
+char* GenericProcessor::getEventSerializationBuffer(size_t size)
+{
+	//The event buffer copies the data, so the same block can be reused for every event
+	if (size > m_serializationBufferSize)
+	{
+		m_serializationBuffer.malloc(size);
+		m_serializationBufferSize = size;
+	}
+	return m_serializationBuffer;
+}
+
+
+void GenericProcessor::setChannelParallelProcessing(bool enabled, int minChannelsPerRange)
+{
+	m_minChannelsPerRange = jmax(1, minChannelsPerRange);
+
+	if (enabled && m_channelProcessingPool == nullptr)
+		m_channelProcessingPool = new SharedResourcePointer<ChannelProcessingPool>();
+	else if (!enabled)
+		m_channelProcessingPool = nullptr;
+}
+
+bool GenericProcessor::isChannelParallelProcessing() const
+{
+	return m_channelProcessingPool != nullptr;
+}
+
+void GenericProcessor::processChannelsInParallel(AudioSampleBuffer& buffer, int numChannels)
+{
+	if (numChannels <= 0)
+		return;
+
+	if (m_channelProcessingPool != nullptr)
+	{
+		ChannelProcessingPool& pool = m_channelProcessingPool->getObject();
+
+		// a couple of ranges per thread, so a thread that finishes early can take over another one
+		const int numThreads = pool.getNumThreads();
+		const int rangeSize = jmax(m_minChannelsPerRange, (numChannels + 2 * numThreads - 1) / (2 * numThreads));
+
+		if (rangeSize < numChannels && pool.process(this, buffer, numChannels, rangeSize))
+			return;
+	}
+
+	processChannelRange(buffer, 0, numChannels);
+}
+
+void GenericProcessor::processChannelRange(AudioSampleBuffer& buffer, int startChannel, int numChannels)
+{
+	// processors calling processChannelsInParallel() must override this
+	jassertfalse;
+}
 
 void GenericProcessor::processBlock(AudioSampleBuffer& buffer, MidiBuffer& eventBuffer)
 {
 	m_currentMidiBuffer = &eventBuffer;
+	const int eventsIn = eventBuffer.getNumEvents();
 	processEventBuffer(); // extract buffer sizes and timestamps,
 	// set flag on all TTL events to zero
 
 	m_lastProcessTime = Time::getHighResolutionTicks();
 	process(buffer);
 
+	// the budget is the duration of the audio callback block
+	const double callbackRate = AudioProcessor::getSampleRate();
+	m_processingProfile.addBlock(m_lastProcessTime, Time::getHighResolutionTicks(),
+		callbackRate > 0 ? buffer.getNumSamples() / callbackRate : 0,
+		eventsIn, eventBuffer.getNumEvents());
+
 }
 
 const DataChannel* GenericProcessor::getDataChannel(int index) const
@@ -1239,6 +1371,7 @@ void GenericProcessor::setEnabledState(bool t)
 bool GenericProcessor::enableProcessor()
 {
 	m_lastProcessTime = Time::getHighResolutionTicks();
+	m_processingProfile.reset();
 	return enable();
 }
 
@@ -1287,6 +1420,11 @@ uint16 GenericProcessor::getSubProcessorFromFullId(uint32 fid)
 	return (fid & 0x0000FFFF);
 }
 
+ProcessingProfile& GenericProcessor::getProcessingProfile()
+{
+	return m_processingProfile;
+}
+
 int64 GenericProcessor::getLastProcessedsoftwareTime() const
 {
 	return m_lastProcessTime;
@@ -33,6 +33,7 @@
 #include "../../Processors/PluginManager/PluginIDs.h"
 #include "../Channel/InfoObjects.h"
 #include "../Events/Events.h"
+#include "ProcessingProfile.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -44,6 +45,7 @@ class DataViewport;
 class UIComponent;
 class GenericEditor;
 class Parameter;
+class ChannelProcessingPool;
 
 
 using namespace Plugin;
@@ -234,6 +236,22 @@ public:
     */
     virtual void process (AudioSampleBuffer& continuousBuffer) = 0;
 
+	/** Enables channel-parallel processing for processors whose channels are independent.
+	When enabled, processChannelsInParallel() splits the channels in ranges of at least
+	minChannelsPerRange channels and spreads them over the shared channel processing threads.
+	Should be called from the constructor. */
+	void setChannelParallelProcessing(bool enabled, int minChannelsPerRange = 16);
+
+	bool isChannelParallelProcessing() const;
+
+	/** Calls processChannelRange() for channels [0, numChannels) of the current block, in parallel
+	if channel-parallel processing is enabled. Meant to be called from process() */
+	void processChannelsInParallel(AudioSampleBuffer& buffer, int numChannels);
+
+	/** Processes a range of channels for processChannelsInParallel(). It's called concurrently for
+	disjoint ranges, so it must only modify data and state belonging to those channels. */
+	virtual void processChannelRange(AudioSampleBuffer& buffer, int startChannel, int numChannels);
+
     /** Pointer to a processor's immediate source node.*/
     GenericProcessor* sourceNode;
 
@@ -520,6 +538,9 @@ public:
 
 	juce::int64 getLastProcessedsoftwareTime() const;
 
+	/** Timing of the process() calls of the current acquisition */
+	ProcessingProfile& getProcessingProfile();
+
 	static uint32 getProcessorFullId(uint16 processorId, uint16 subprocessorIdx);
 
 	static uint16 getNodeIdFromFullId(uint32 fullId);
@@ -583,6 +604,29 @@ protected:
 	void addSpike(int channelIndex, const SpikeEvent* event, int sampleNum);
 	void addSpike(const SpikeChannel* channel, const SpikeEvent* event, int sampleNum);
 
+	/** Holds spikes detected in processChannelRange(), where addSpike() can't be called as it is not
+	thread safe. Use one per unit of work, so each is only filled by one thread, and pass them all to
+	addStagedSpikes() from process() once the parallel processing is done. */
+	class PLUGIN_API SpikeStaging
+	{
+	public:
+		/** Takes ownership of the event */
+		void add(const SpikeChannel* channel, SpikeEvent* event, int sampleNum);
+		int size() const;
+		void clear();
+
+	private:
+		friend class GenericProcessor;
+		OwnedArray<SpikeEvent> events;
+		Array<const SpikeChannel*> channels;
+		Array<int> sampleNums;
+	};
+
+	/** Adds the spikes of all the stagings to the outgoing event buffer in timestamp order, and clears them.
+	Spikes with the same timestamp keep the order of the stagings and, within one, the order they were
+	added in, so the output doesn't depend on how the work was split between threads. */
+	void addStagedSpikes(OwnedArray<SpikeStaging>& stagings);
+
 	/** Method to create the data channels pertaining to this processor, called automatically by update()*/
 	virtual void createDataChannels();
 
@@ -604,10 +648,27 @@ protected:
 	void updateChannelIndexes(bool updateNodeID = true);
 
 private:
-	std::map<uint32, uint32> numSamples;
-	std::map<uint32, juce::int64> timestamps;
+	/** Timestamp and number of samples of the current block of a source (processor and subprocessor) */
+	struct SourceBlockInfo
+	{
+		uint32 sourceID;
+		juce::int64 timestamp;
+		uint32 numSamples;
+	};
+
+	/** Returns the index of a source in m_sourceBlocks, or -1 if no block info has been seen for it */
+	int getSourceBlockIndex(uint32 sourceID) const;
+	/** Returns the index of a source in m_sourceBlocks, adding it if needed */
+	int addSourceBlock(uint32 sourceID);
+	int getChannelSourceBlockIndex(int channelNum) const;
+
+	Array<SourceBlockInfo> m_sourceBlocks;
+	/** Index in m_sourceBlocks of the source of each data channel, so the per-channel lookups
+	done on every block are a plain array access. Resolved in updateChannelIndexes */
+	Array<int> m_channelSourceBlocks;
 
 	juce::int64 m_lastProcessTime;
+	ProcessingProfile m_processingProfile;
 
 	void createDataChannelsByType(DataChannel::DataChannelTypes type);
 
@@ -638,6 +699,15 @@ private:
 	Array<bool> m_needsToSendTimestampMessages;
 
 	MidiBuffer* m_currentMidiBuffer;
+	MidiBuffer m_temporalEventBuffer;
+
+	/** Returns a block of at least size bytes where addEvent and addSpike serialize events */
+	char* getEventSerializationBuffer(size_t size);
+	HeapBlock<char> m_serializationBuffer;
+	size_t m_serializationBufferSize{ 0 };
+
+	ScopedPointer<SharedResourcePointer<ChannelProcessingPool>> m_channelProcessingPool;
+	int m_minChannelsPerRange{ 16 };
 
 	typedef std::map<uint16, int> ChannelIndexes;
 	typedef std::unordered_map<uint32, ChannelIndexes> ChannelIndexMap;
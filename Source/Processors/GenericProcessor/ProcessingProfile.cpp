@@ -0,0 +1,123 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2014 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessingProfile.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+ProcessingProfile::ProcessingProfile()
+{
+	m_history.calloc(historySize);
+}
+
+void ProcessingProfile::reset()
+{
+	m_numBlocks = 0;
+}
+
+void ProcessingProfile::addBlock(int64 startTicks, int64 endTicks, double budgetSeconds, int eventsIn, int eventsOut)
+{
+	const int n = m_numBlocks.get();
+	Block& block = m_history[n % historySize];
+	block.startTicks = startTicks;
+	block.endTicks = endTicks;
+	block.budgetMs = float(budgetSeconds * 1000);
+	block.eventsIn = eventsIn;
+	block.eventsOut = eventsOut;
+
+	// wrap around before overflowing, keeping the ring position
+	m_numBlocks = (n + 1 == std::numeric_limits<int>::max() - std::numeric_limits<int>::max() % historySize) ? historySize : n + 1;
+}
+
+void ProcessingProfile::getHistory(Array<Block>& blocks) const
+{
+	blocks.clearQuick();
+
+	const int n = m_numBlocks.get();
+	const int first = jmax(0, n - historySize);
+	blocks.ensureStorageAllocated(n - first);
+
+	for (int i = first; i < n; i++)
+		blocks.add(m_history[i % historySize]);
+}
+
+ProcessingProfile::Statistics ProcessingProfile::getStatistics() const
+{
+	Statistics stats = Statistics();
+
+	Array<Block> blocks;
+	getHistory(blocks);
+	if (blocks.size() == 0)
+		return stats;
+
+	const double msPerTick = 1000.0 / Time::getHighResolutionTicksPerSecond();
+	std::vector<double> durations;
+	durations.reserve(blocks.size());
+
+	stats.numBlocks = blocks.size();
+	stats.minMarginMs = std::numeric_limits<double>::max();
+
+	for (int i = 0; i < blocks.size(); i++)
+	{
+		const Block& block = blocks.getReference(i);
+		const double duration = (block.endTicks - block.startTicks) * msPerTick;
+		const double margin = block.budgetMs - duration;
+
+		durations.push_back(duration);
+		stats.meanMs += duration;
+		stats.maxMs = jmax(stats.maxMs, duration);
+		stats.budgetMs += block.budgetMs;
+		stats.minMarginMs = jmin(stats.minMarginMs, margin);
+		if (margin < 0)
+			stats.overruns++;
+		stats.meanEventsIn += block.eventsIn;
+		stats.meanEventsOut += block.eventsOut;
+	}
+
+	stats.meanMs /= stats.numBlocks;
+	stats.budgetMs /= stats.numBlocks;
+	stats.meanEventsIn /= stats.numBlocks;
+	stats.meanEventsOut /= stats.numBlocks;
+
+	const size_t p99Index = jmin(durations.size() - 1, (durations.size() * 99) / 100);
+	std::nth_element(durations.begin(), durations.begin() + p99Index, durations.end());
+	stats.p99Ms = durations[p99Index];
+
+	return stats;
+}
+
+String ProcessingProfile::Statistics::toString() const
+{
+	if (numBlocks == 0)
+		return "No blocks processed";
+
+	String s;
+	s << "Process time: mean " << String(meanMs, 3) << " ms, p99 " << String(p99Ms, 3)
+		<< " ms, max " << String(maxMs, 3) << " ms\n";
+	s << "Block budget: " << String(budgetMs, 2) << " ms, min margin " << String(minMarginMs, 3)
+		<< " ms, " << overruns << " overruns\n";
+	s << "Events per block: " << String(meanEventsIn, 1) << " in, " << String(meanEventsOut, 1) << " out\n";
+	s << "Last " << numBlocks << " blocks";
+	return s;
+}
@@ -0,0 +1,92 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2014 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PROCESSINGPROFILE_H_INCLUDED
+#define PROCESSINGPROFILE_H_INCLUDED
+
+#include <JuceHeader.h>
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+	Timing history of the blocks processed by a processor (or by the whole graph).
+
+	The processing thread adds one entry per block to a fixed size ring, without
+	locking or allocating. The message thread computes statistics over the blocks
+	still in the ring, or copies them to export a trace. Entries being overwritten
+	while they are read only affect the statistics of a single block.
+
+	@see GenericProcessor::getProcessingProfile, ProcessorGraph::exportProcessingTrace
+*/
+class PLUGIN_API ProcessingProfile
+{
+public:
+	struct Block
+	{
+		juce::int64 startTicks;
+		juce::int64 endTicks;
+		/** Real-time duration of the block, which is the time available to process it */
+		float budgetMs;
+		int eventsIn;
+		int eventsOut;
+	};
+
+	struct Statistics
+	{
+		int numBlocks;
+		double meanMs;
+		double p99Ms;
+		double maxMs;
+		double budgetMs;
+		/** Smallest time left before the end of the block budget (negative on overruns) */
+		double minMarginMs;
+		int overruns;
+		double meanEventsIn;
+		double meanEventsOut;
+
+		String toString() const;
+	};
+
+	ProcessingProfile();
+
+	/** Clears the history. Must not be called while blocks are being processed */
+	void reset();
+
+	/** Called from the processing thread at the end of every block */
+	void addBlock(juce::int64 startTicks, juce::int64 endTicks, double budgetSeconds, int eventsIn, int eventsOut);
+
+	/** Statistics over the blocks currently in the history */
+	Statistics getStatistics() const;
+
+	/** Copies the blocks currently in the history, oldest first */
+	void getHistory(Array<Block>& blocks) const;
+
+	static const int historySize = 4096;
+
+private:
+	HeapBlock<Block> m_history;
+	Atomic<int> m_numBlocks;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessingProfile);
+};
+
+#endif
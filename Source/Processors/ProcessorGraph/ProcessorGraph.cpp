@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <limits>
 
 #include "ProcessorGraph.h"
 #include "../GenericProcessor/GenericProcessor.h"
@@ -667,6 +668,7 @@ bool ProcessorGraph::enableProcessors()
 
     //	sendActionMessage("Acquisition started.");
 	m_startSoftTimestamp = Time::getHighResolutionTicks();
+	m_callbackProfile.reset();
 	if (m_timestampWindow)
 		m_timestampWindow->setAcquisitionState(true);
     return true;
@@ -826,3 +828,143 @@ void ProcessorGraph::setTimestampWindow(TimestampSourceSelectionWindow* window)
 {
 	m_timestampWindow = window;
 }
+
+void ProcessorGraph::setNumProcessingThreads(int numThreads)
+{
+	m_numProcessingThreads = jmax(0, numThreads);
+}
+
+int ProcessorGraph::getNumProcessingThreads() const
+{
+	return m_numProcessingThreads;
+}
+
+void ProcessorGraph::prepareToPlay(double sampleRate, int estimatedSamplesPerBlock)
+{
+	AudioProcessorGraph::prepareToPlay(sampleRate, estimatedSamplesPerBlock);
+
+	ScopedPointer<ProcessorGraphScheduler> scheduler;
+
+	if (m_numProcessingThreads > 0)
+	{
+		scheduler = new ProcessorGraphScheduler(*this, m_numProcessingThreads);
+
+		if (scheduler->prepare(estimatedSamplesPerBlock))
+		{
+			std::cout << "Processing " << scheduler->getNumTasks() << " nodes on "
+				<< m_numProcessingThreads + 1 << " threads (critical path of "
+				<< scheduler->getCriticalPathLength() << " nodes)" << std::endl;
+		}
+		else
+		{
+			std::cout << "Could not schedule the processor graph, processing serially." << std::endl;
+			scheduler = nullptr;
+		}
+	}
+
+	// the previous scheduler is destroyed once the lock is released
+	const ScopedLock sl(getCallbackLock());
+	m_scheduler.swapWith(scheduler);
+}
+
+void ProcessorGraph::releaseResources()
+{
+	ScopedPointer<ProcessorGraphScheduler> scheduler;
+	{
+		const ScopedLock sl(getCallbackLock());
+		m_scheduler.swapWith(scheduler);
+	}
+
+	AudioProcessorGraph::releaseResources();
+}
+
+void ProcessorGraph::processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+	const int64 startTicks = Time::getHighResolutionTicks();
+
+	if (m_scheduler != nullptr)
+		m_scheduler->process(buffer, midiMessages);
+	else
+		AudioProcessorGraph::processBlock(buffer, midiMessages);
+
+	const double sampleRate = getSampleRate();
+	m_callbackProfile.addBlock(startTicks, Time::getHighResolutionTicks(),
+		sampleRate > 0 ? buffer.getNumSamples() / sampleRate : 0, 0, 0);
+}
+
+ProcessingProfile& ProcessorGraph::getCallbackProfile()
+{
+	return m_callbackProfile;
+}
+
+bool ProcessorGraph::exportProcessingTrace(const File& file)
+{
+	struct TraceThread
+	{
+		int id;
+		String name;
+		Array<ProcessingProfile::Block> blocks;
+	};
+	OwnedArray<TraceThread> threads;
+
+	TraceThread* callback = new TraceThread();
+	callback->id = 0;
+	callback->name = "Audio callback";
+	m_callbackProfile.getHistory(callback->blocks);
+	threads.add(callback);
+
+	for (int i = 0; i < getNumNodes(); i++)
+	{
+		Node* node = getNode(i);
+		if (node->nodeId == OUTPUT_NODE_ID)
+			continue;
+
+		GenericProcessor* p = (GenericProcessor*) node->getProcessor();
+		TraceThread* thread = new TraceThread();
+		thread->id = p->getNodeId();
+		thread->name = p->getName() + " (" + String(p->getNodeId()) + ")";
+		p->getProcessingProfile().getHistory(thread->blocks);
+		threads.add(thread);
+	}
+
+	int64 firstTicks = std::numeric_limits<int64>::max();
+	for (int t = 0; t < threads.size(); t++)
+	{
+		for (int b = 0; b < threads[t]->blocks.size(); b++)
+			firstTicks = jmin(firstTicks, threads[t]->blocks.getReference(b).startTicks);
+	}
+
+	file.deleteFile();
+	FileOutputStream out(file);
+	if (out.failedToOpen())
+		return false;
+
+	// complete ("X") events, one trace thread per processor
+	const double usPerTick = 1.0e6 / Time::getHighResolutionTicksPerSecond();
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+
+	for (int t = 0; t < threads.size(); t++)
+	{
+		const TraceThread* thread = threads[t];
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+			<< ",\"args\":{\"name\":" << JSON::toString(thread->name) << "}}";
+		first = false;
+
+		const String name = JSON::toString(thread->name);
+		for (int b = 0; b < thread->blocks.size(); b++)
+		{
+			const ProcessingProfile::Block& block = thread->blocks.getReference(b);
+			out << ",\n{\"name\":" << name << ",\"cat\":\"process\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+				<< ",\"ts\":" << String((block.startTicks - firstTicks) * usPerTick, 1)
+				<< ",\"dur\":" << String((block.endTicks - block.startTicks) * usPerTick, 1)
+				<< ",\"args\":{\"budget_ms\":" << String(block.budgetMs, 3)
+				<< ",\"events_in\":" << block.eventsIn
+				<< ",\"events_out\":" << block.eventsOut << "}}";
+		}
+	}
+
+	out << "\n]}\n";
+	out.flush();
+	return out.getStatus().wasOk();
+}
@@ -27,6 +27,8 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../../AccessClass.h"
+#include "ProcessorGraphScheduler.h"
+#include "../GenericProcessor/ProcessingProfile.h"
 
 class GenericProcessor;
 class RecordNode;
@@ -101,6 +103,25 @@ public:
 
 	void setTimestampWindow(TimestampSourceSelectionWindow* window);
 
+	/** Sets the number of threads used to process the signal chains, in addition to the audio
+		callback thread. With 0 threads the signal chains are processed serially by the JUCE
+		graph renderer; otherwise independent branches are run in parallel by a
+		ProcessorGraphScheduler. Takes effect the next time acquisition starts. */
+	void setNumProcessingThreads(int numThreads);
+	int getNumProcessingThreads() const;
+
+	void prepareToPlay(double sampleRate, int estimatedSamplesPerBlock) override;
+	void releaseResources() override;
+	void processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
+	using AudioProcessorGraph::processBlock;
+
+	/** Timing of the whole audio callback of the current acquisition */
+	ProcessingProfile& getCallbackProfile();
+
+	/** Writes the processing history of the callback and of every processor as a
+		Chrome trace (JSON, viewable in chrome://tracing or Perfetto) */
+	bool exportProcessingTrace(const File& file);
+
 private:
     int currentNodeId;
 
@@ -123,6 +144,10 @@ private:
 	int m_timestampSourceSubIdx;
 	Array<const GenericProcessor*> m_validTimestampSources;
 	WeakReference<TimestampSourceSelectionWindow> m_timestampWindow;
+
+	int m_numProcessingThreads{ 0 };
+	ScopedPointer<ProcessorGraphScheduler> m_scheduler;
+	ProcessingProfile m_callbackProfile;
 };
 
 
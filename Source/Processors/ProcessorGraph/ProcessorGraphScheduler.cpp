@@ -0,0 +1,415 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProcessorGraphScheduler.h"
+
+namespace
+{
+    struct DestChannelSorter
+    {
+        template <class SourceType>
+        static int compareElements(const SourceType& first, const SourceType& second)
+        {
+            return first.destChannel - second.destChannel;
+        }
+    };
+}
+
+//==============================================================================
+
+void ProcessorGraphScheduler::ReadyQueue::push(int task)
+{
+    const SpinLock::ScopedLockType lock_(lock);
+    tasks[tail++] = task;
+}
+
+bool ProcessorGraphScheduler::ReadyQueue::pop(int& task)
+{
+    const SpinLock::ScopedLockType lock_(lock);
+    if (tail == head)
+        return false;
+    task = tasks[--tail];
+    return true;
+}
+
+bool ProcessorGraphScheduler::ReadyQueue::steal(int& task)
+{
+    const SpinLock::ScopedLockType lock_(lock);
+    if (tail == head)
+        return false;
+    task = tasks[head++];
+    return true;
+}
+
+//==============================================================================
+
+ProcessorGraphScheduler::Worker::Worker(ProcessorGraphScheduler& scheduler, int queueIndex)
+    : Thread("Graph worker " + String(queueIndex))
+    , m_scheduler(scheduler)
+    , m_queueIndex(queueIndex)
+{
+}
+
+void ProcessorGraphScheduler::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        blockStart.wait();
+
+        if (threadShouldExit())
+            break;
+
+        m_scheduler.workUntilBlockDone(m_queueIndex);
+        --m_scheduler.m_activeWorkers;
+    }
+}
+
+//==============================================================================
+
+ProcessorGraphScheduler::ProcessorGraphScheduler(AudioProcessorGraph& graph, int numWorkerThreads)
+    : m_graph(graph)
+    , m_numWorkerThreads(jmax(0, numWorkerThreads))
+    , m_numSamples(0)
+    , m_criticalPathLength(0)
+{
+    // queue 0 belongs to the audio callback thread
+    for (int i = 0; i <= m_numWorkerThreads; i++)
+        m_queues.add(new ReadyQueue());
+
+    for (int i = 1; i <= m_numWorkerThreads; i++)
+    {
+        Worker* worker = new Worker(*this, i);
+        m_workers.add(worker);
+        worker->startThread(9);
+    }
+}
+
+ProcessorGraphScheduler::~ProcessorGraphScheduler()
+{
+    for (int i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i]->signalThreadShouldExit();
+        m_workers[i]->blockStart.signal();
+    }
+
+    for (int i = 0; i < m_workers.size(); i++)
+        m_workers[i]->stopThread(1000);
+}
+
+int ProcessorGraphScheduler::getNumWorkerThreads() const
+{
+    return m_numWorkerThreads;
+}
+
+int ProcessorGraphScheduler::getNumTasks() const
+{
+    return m_tasks.size();
+}
+
+int ProcessorGraphScheduler::getCriticalPathLength() const
+{
+    return m_criticalPathLength;
+}
+
+void ProcessorGraphScheduler::clear()
+{
+    m_tasks.clear();
+    m_executionOrder.clear();
+    m_outputSources.clear();
+    m_criticalPathLength = 0;
+}
+
+int ProcessorGraphScheduler::getTaskIndex(uint32 nodeId) const
+{
+    for (int i = 0; i < m_tasks.size(); i++)
+    {
+        if (m_tasks.getUnchecked(i)->nodeId == nodeId)
+            return i;
+    }
+    return -1;
+}
+
+bool ProcessorGraphScheduler::isGraphOutput(const AudioProcessor* processor)
+{
+    typedef AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+    const IOProcessor* io = dynamic_cast<const IOProcessor*>(processor);
+    return io != nullptr && io->getType() == IOProcessor::audioOutputNode;
+}
+
+bool ProcessorGraphScheduler::prepare(int maximumBlockSize)
+{
+    clear();
+
+    // Every node but the graph I/O nodes becomes a task. The graph has no inputs, and the
+    // audio output node is rendered directly into the output buffer by process()
+    for (int i = 0; i < m_graph.getNumNodes(); i++)
+    {
+        AudioProcessorGraph::Node* node = m_graph.getNode(i);
+        AudioProcessor* processor = node->getProcessor();
+
+        if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*>(processor) != nullptr)
+            continue;
+
+        Task* task = new Task();
+        task->processor = processor;
+        task->nodeId = node->nodeId;
+        task->numChannels = jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        task->buffer.setSize(task->numChannels, maximumBlockSize);
+        task->midiBuffer.ensureSize(4096);
+        task->numDependencies = 0;
+        m_tasks.add(task);
+    }
+
+    // Sources are collected in the same order as the JUCE renderer, last connection first
+    for (int i = m_graph.getNumConnections(); --i >= 0;)
+    {
+        const AudioProcessorGraph::Connection* c = m_graph.getConnection(i);
+        const int source = getTaskIndex(c->sourceNodeId);
+        if (source < 0)
+            continue;
+
+        ChannelSource channelSource;
+        channelSource.task = source;
+        channelSource.sourceChannel = c->sourceChannelIndex;
+        channelSource.destChannel = c->destChannelIndex;
+
+        const int dest = getTaskIndex(c->destNodeId);
+        if (dest < 0)
+        {
+            AudioProcessorGraph::Node* destNode = m_graph.getNodeForId(c->destNodeId);
+            if (destNode != nullptr && isGraphOutput(destNode->getProcessor())
+                && c->sourceChannelIndex != AudioProcessorGraph::midiChannelIndex)
+                m_outputSources.add(channelSource);
+            continue;
+        }
+
+        if (dest == source)
+        {
+            std::cout << "Graph scheduler: " << m_tasks[source]->processor->getName() << " is connected to itself." << std::endl;
+            clear();
+            return false;
+        }
+
+        Task* destTask = m_tasks.getUnchecked(dest);
+
+        if (c->sourceChannelIndex == AudioProcessorGraph::midiChannelIndex)
+        {
+            destTask->midiSources.addIfNotAlreadyThere(source);
+        }
+        else if (c->destChannelIndex < destTask->numChannels
+                 && c->sourceChannelIndex < m_tasks.getUnchecked(source)->numChannels)
+        {
+            destTask->audioSources.add(channelSource);
+        }
+        else
+        {
+            continue;
+        }
+
+        Task* sourceTask = m_tasks.getUnchecked(source);
+        if (!sourceTask->dependents.contains(dest))
+        {
+            sourceTask->dependents.add(dest);
+            destTask->numDependencies++;
+        }
+    }
+
+    DestChannelSorter sorter;
+    for (int i = 0; i < m_tasks.size(); i++)
+        m_tasks.getUnchecked(i)->audioSources.sort(sorter, true);
+
+    // Topological order, taking the ready node that comes first in the graph at each step.
+    // This is the order used when there are no worker threads
+    Array<int> remaining;
+    Array<int> pathLength;
+    for (int i = 0; i < m_tasks.size(); i++)
+    {
+        remaining.add(m_tasks.getUnchecked(i)->numDependencies);
+        pathLength.add(1);
+    }
+
+    while (m_executionOrder.size() < m_tasks.size())
+    {
+        const int next = remaining.indexOf(0);
+        if (next < 0)
+        {
+            std::cout << "Graph scheduler: the processor graph contains a feedback loop." << std::endl;
+            clear();
+            return false;
+        }
+
+        remaining.set(next, -1);
+        m_executionOrder.add(next);
+        m_criticalPathLength = jmax(m_criticalPathLength, pathLength[next]);
+
+        const Array<int>& dependents = m_tasks.getUnchecked(next)->dependents;
+        for (int i = 0; i < dependents.size(); i++)
+        {
+            const int dependent = dependents.getUnchecked(i);
+            remaining.set(dependent, remaining[dependent] - 1);
+            pathLength.set(dependent, jmax(pathLength[dependent], pathLength[next] + 1));
+        }
+    }
+
+    for (int i = 0; i < m_queues.size(); i++)
+        m_queues[i]->tasks.malloc(jmax(1, m_tasks.size()));
+
+    return true;
+}
+
+void ProcessorGraphScheduler::process(AudioSampleBuffer& outputBuffer, MidiBuffer& midiMessages)
+{
+    m_numSamples = outputBuffer.getNumSamples();
+
+    if (m_workers.size() == 0)
+    {
+        for (int i = 0; i < m_executionOrder.size(); i++)
+            runTask(m_executionOrder.getUnchecked(i), -1);
+    }
+    else
+    {
+        for (int i = 0; i < m_queues.size(); i++)
+        {
+            m_queues[i]->head = 0;
+            m_queues[i]->tail = 0;
+        }
+
+        // spread the nodes without sources (the signal chain heads and the message center)
+        // over the queues, so every thread has a branch to start with
+        int queue = 0;
+        for (int i = 0; i < m_executionOrder.size(); i++)
+        {
+            const int taskIndex = m_executionOrder.getUnchecked(i);
+            Task* task = m_tasks.getUnchecked(taskIndex);
+            task->pendingDependencies = task->numDependencies;
+
+            if (task->numDependencies == 0)
+            {
+                m_queues.getUnchecked(queue)->push(taskIndex);
+                queue = (queue + 1) % m_queues.size();
+            }
+        }
+
+        m_remainingTasks = m_tasks.size();
+        m_activeWorkers = m_workers.size();
+
+        for (int i = 0; i < m_workers.size(); i++)
+            m_workers.getUnchecked(i)->blockStart.signal();
+
+        workUntilBlockDone(0);
+
+        // the workers must be out of the queues before they are reset for the next block
+        while (m_activeWorkers.get() > 0)
+            Thread::yield();
+    }
+
+    outputBuffer.clear();
+    for (int i = 0; i < m_outputSources.size(); i++)
+    {
+        const ChannelSource& source = m_outputSources.getReference(i);
+        if (source.destChannel < outputBuffer.getNumChannels())
+            outputBuffer.addFrom(source.destChannel, 0, m_tasks.getUnchecked(source.task)->buffer,
+                                 source.sourceChannel, 0, m_numSamples);
+    }
+
+    midiMessages.clear();
+}
+
+void ProcessorGraphScheduler::workUntilBlockDone(int queueIndex)
+{
+    ReadyQueue* ownQueue = m_queues.getUnchecked(queueIndex);
+    int taskIndex;
+
+    while (m_remainingTasks.get() > 0)
+    {
+        if (ownQueue->pop(taskIndex) || stealTask(queueIndex, taskIndex))
+            runTask(taskIndex, queueIndex);
+        else
+            Thread::yield();
+    }
+}
+
+bool ProcessorGraphScheduler::stealTask(int queueIndex, int& task)
+{
+    for (int i = 1; i < m_queues.size(); i++)
+    {
+        if (m_queues.getUnchecked((queueIndex + i) % m_queues.size())->steal(task))
+            return true;
+    }
+    return false;
+}
+
+void ProcessorGraphScheduler::runTask(int taskIndex, int queueIndex)
+{
+    Task& task = *m_tasks.getUnchecked(taskIndex);
+
+    gatherInputs(task);
+    task.processor->processBlock(task.buffer, task.midiBuffer);
+
+    if (queueIndex < 0)
+        return;
+
+    // whichever thread completes the last source of a node runs it next, unless it gets stolen
+    for (int i = 0; i < task.dependents.size(); i++)
+    {
+        const int dependent = task.dependents.getUnchecked(i);
+        if (--(m_tasks.getUnchecked(dependent)->pendingDependencies) == 0)
+            m_queues.getUnchecked(queueIndex)->push(dependent);
+    }
+
+    --m_remainingTasks;
+}
+
+void ProcessorGraphScheduler::gatherInputs(Task& task)
+{
+    task.buffer.setSize(task.numChannels, m_numSamples, false, false, true);
+
+    // audioSources is sorted by destination channel. The first source of a channel is copied
+    // and the following ones are mixed in, unconnected channels are cleared
+    int nextChannel = 0;
+    for (int i = 0; i < task.audioSources.size(); i++)
+    {
+        const ChannelSource& source = task.audioSources.getReference(i);
+        const AudioSampleBuffer& sourceBuffer = m_tasks.getUnchecked(source.task)->buffer;
+
+        if (source.destChannel < nextChannel)
+        {
+            task.buffer.addFrom(source.destChannel, 0, sourceBuffer, source.sourceChannel, 0, m_numSamples);
+        }
+        else
+        {
+            for (; nextChannel < source.destChannel; nextChannel++)
+                task.buffer.clear(nextChannel, 0, m_numSamples);
+
+            task.buffer.copyFrom(source.destChannel, 0, sourceBuffer, source.sourceChannel, 0, m_numSamples);
+            nextChannel = source.destChannel + 1;
+        }
+    }
+
+    for (; nextChannel < task.numChannels; nextChannel++)
+        task.buffer.clear(nextChannel, 0, m_numSamples);
+
+    task.midiBuffer.clear();
+    for (int i = 0; i < task.midiSources.size(); i++)
+        task.midiBuffer.addEvents(m_tasks.getUnchecked(task.midiSources.getUnchecked(i))->midiBuffer, 0, -1, 0);
+}
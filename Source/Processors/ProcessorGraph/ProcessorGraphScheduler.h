@@ -0,0 +1,148 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PROCESSORGRAPHSCHEDULER_H_3C1F7A20__
+#define __PROCESSORGRAPHSCHEDULER_H_3C1F7A20__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+/**
+  Renders an AudioProcessorGraph by running independent branches in parallel.
+
+  The JUCE renderer shares a small set of buffers between all nodes and reuses
+  them as soon as a node's output has been consumed, which forces every node to
+  run one after the other. The scheduler instead gives every node its own audio
+  and event buffers and builds a dependency DAG from the graph connections, so
+  the branches downstream of a Splitter (or any other processors that don't feed
+  each other) can be processed at the same time.
+
+  Ready nodes are placed on per-thread queues. Each thread works from the back of
+  its own queue, which keeps it following a single branch, and steals from the
+  front of the other queues when it runs out of work. The audio callback thread
+  takes part in the rendering as the first of these threads.
+
+  A node only starts once all of its sources have finished, and its inputs are
+  always gathered in the same order, so the output is identical to rendering the
+  nodes serially, whatever the number of threads.
+
+  Connections must not be changed between prepare() and the last call to
+  process(). Processors that share state between branches outside of the graph
+  connections must not be used with more than one thread.
+
+  @see ProcessorGraph
+*/
+
+class ProcessorGraphScheduler
+{
+public:
+    /** numWorkerThreads is the number of threads used in addition to the audio callback thread */
+    ProcessorGraphScheduler(AudioProcessorGraph& graph, int numWorkerThreads);
+    ~ProcessorGraphScheduler();
+
+    /** Builds the dependency DAG from the current graph connections and allocates the node buffers.
+        Returns false if the graph can't be scheduled (e.g., if it contains a feedback loop) */
+    bool prepare(int maximumBlockSize);
+
+    /** Processes one block. The graph output nodes are rendered into outputBuffer */
+    void process(AudioSampleBuffer& outputBuffer, MidiBuffer& midiMessages);
+
+    int getNumWorkerThreads() const;
+    int getNumTasks() const;
+
+    /** Returns the longest chain of dependent nodes, which bounds the speedup that can be obtained */
+    int getCriticalPathLength() const;
+
+private:
+    struct ChannelSource
+    {
+        int task;
+        int sourceChannel;
+        int destChannel;
+    };
+
+    struct Task
+    {
+        AudioProcessor* processor;
+        uint32 nodeId;
+        int numChannels;
+        AudioSampleBuffer buffer;
+        MidiBuffer midiBuffer;
+        Array<ChannelSource> audioSources;
+        Array<int> midiSources;
+        Array<int> dependents;
+        int numDependencies;
+        Atomic<int> pendingDependencies;
+    };
+
+    /** Fixed capacity queue. Every task is pushed once per block, so numTasks slots are always enough */
+    struct ReadyQueue
+    {
+        SpinLock lock;
+        HeapBlock<int> tasks;
+        int head;
+        int tail;
+
+        void push(int task);
+        bool pop(int& task);
+        bool steal(int& task);
+    };
+
+    class Worker : public Thread
+    {
+    public:
+        Worker(ProcessorGraphScheduler& scheduler, int queueIndex);
+        void run() override;
+
+        WaitableEvent blockStart;
+
+    private:
+        ProcessorGraphScheduler& m_scheduler;
+        const int m_queueIndex;
+    };
+
+    void clear();
+    int getTaskIndex(uint32 nodeId) const;
+    static bool isGraphOutput(const AudioProcessor* processor);
+    void runTask(int taskIndex, int queueIndex);
+    void gatherInputs(Task& task);
+    void workUntilBlockDone(int queueIndex);
+    bool stealTask(int queueIndex, int& task);
+
+    AudioProcessorGraph& m_graph;
+    const int m_numWorkerThreads;
+
+    OwnedArray<Task> m_tasks;
+    Array<int> m_executionOrder;
+    Array<ChannelSource> m_outputSources;
+    OwnedArray<ReadyQueue> m_queues;
+    OwnedArray<Worker> m_workers;
+
+    int m_numSamples;
+    int m_criticalPathLength;
+    Atomic<int> m_remainingTasks;
+    Atomic<int> m_activeWorkers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessorGraphScheduler);
+};
+
+#endif  // __PROCESSORGRAPHSCHEDULER_H_3C1F7A20__
@@ -31,7 +31,6 @@ BinaryRecording::BinaryRecording()
 {
     m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
-    m_tsBuffer.malloc(MAX_BUFFER_SIZE);
 }
 
 BinaryRecording::~BinaryRecording()
@@ -119,9 +118,9 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
             if (!found)
             {
                 String datPath = getProcessorString(channelInfo);
-                continuousFileNames.add(contPath + datPath + "continuous.dat");
+                continuousFileNames.add(contPath + datPath);
 
-                ScopedPointer<NpyFile> tFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::INT64,1));
+                ScopedPointer<DataTimestampFile> tFile = new DataTimestampFile(contPath + datPath, m_runLengthTimestamps);
                 m_dataTimestampFiles.add(tFile.release());
 
                 m_fileIndexes.set(recordedChan, nInfoArrays);
@@ -146,20 +145,29 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         lastId = indexedDataChannels.size();
     }
     int nFiles = continuousFileNames.size();
+    int maxFileChannels = 0;
     for (int i = 0; i < nFiles; i++)
     {
         int numChannels = jsonChannels.getReference(i).size();
-        ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
-        if (bFile->openFile(continuousFileNames[i]))
-            m_DataFiles.add(bFile.release());
-        else
-            m_DataFiles.add(nullptr);
+        maxFileChannels = jmax(maxFileChannels, numChannels);
+        m_fileChannels.add(new Array<int>());
+        m_fileChannels.getLast()->insertMultiple(0, 0, numChannels);
         DynamicObject::Ptr jsonFile = jsonContinuousfiles.getReference(i).getDynamicObject();
         jsonFile->setProperty("num_channels", numChannels);
         jsonFile->setProperty("channels", jsonChannels.getReference(i));
+        openContinuousFile(continuousFileNames[i], numChannels, jsonFile);
     }
 
     int nChans = getNumRecordedChannels();
+    //Channel layout of each file, so all the channels of a file can be written at once
+    for (int i = 0; i < nChans; i++)
+    {
+        m_fileChannels[m_fileIndexes[i]]->set(m_channelIndexes[i], i);
+        m_channelScales.add(1 / (float(0x7fff) * getDataChannel(getRealChannel(i))->getBitVolts()));
+    }
+    m_channelPointers.malloc(maxFileChannels);
+    m_fileScales.malloc(maxFileChannels);
+
     //Timestamps
     Array<uint32> procIDs;
     for (int i = 0; i < nChans; i++)
@@ -448,6 +456,32 @@ void BinaryRecording::createChannelMetaData(const MetaDataInfoObject* channel, D
     jsonFile->setProperty("channel_metadata", jsonMetaData);
 }
 
+void BinaryRecording::openContinuousFile(String folderPath, int numChannels, DynamicObject* jsonFile)
+{
+    ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
+    if (bFile->openFile(folderPath + "continuous.dat", m_asyncContinuousWrites, int64(m_preallocationMB) * 1024 * 1024))
+        m_DataFiles.add(bFile.release());
+    else
+        m_DataFiles.add(nullptr);
+}
+
+void BinaryRecording::writeContinuousChannel(int fileIndex, uint64 startPos, int channel, int16* data, int nSamples)
+{
+    if (m_DataFiles[fileIndex])
+        m_DataFiles[fileIndex]->writeChannel(startPos, channel, data, nSamples);
+}
+
+void BinaryRecording::writeContinuousFile(int fileIndex, uint64 startPos, const float* const* data, const float* scales, int nSamples)
+{
+    if (m_DataFiles[fileIndex])
+        m_DataFiles[fileIndex]->writeChannelBlock(startPos, data, scales, nSamples);
+}
+
+void BinaryRecording::closeContinuousFiles()
+{
+    m_DataFiles.clear();
+}
+
 void BinaryRecording::closeFiles()
 {
     resetChannels();
@@ -455,9 +489,11 @@ void BinaryRecording::closeFiles()
 
 void BinaryRecording::resetChannels()
 {
-    m_DataFiles.clear();
+    closeContinuousFiles();
     m_channelIndexes.clear();
     m_fileIndexes.clear();
+    m_fileChannels.clear();
+    m_channelScales.clear();
     m_dataTimestampFiles.clear();
     m_eventFiles.clear();
     m_spikeChannelIndexes.clear();
@@ -467,7 +503,6 @@ void BinaryRecording::resetChannels()
 
     m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
-    m_tsBuffer.malloc(MAX_BUFFER_SIZE);
     m_bufferSize = MAX_BUFFER_SIZE;
     m_startTS.clear();
 }
@@ -475,38 +510,106 @@ void BinaryRecording::resetChannels()
 void BinaryRecording::writeData(int writeChannel, int realChannel, const float* buffer,
                                 int size)
 {
-    if (size > m_bufferSize)
-    // shouldn't happen, and if it does it'll be slow, but better this than crashing
+    writeChannelData(writeChannel, realChannel, buffer, size, getTimestamp(writeChannel));
+}
+
+void BinaryRecording::writeContinuousBlock(const AudioSampleBuffer& buffer, const Array<CircularBufferIndexes>& indexes)
+{
+    int nFiles = m_fileChannels.size();
+    for (int file = 0; file < nFiles; file++)
     {
-        std::cerr << "Write buffer overrun, resizing to" << size << std::endl;
-        m_bufferSize = size;
-        m_scaledBuffer.malloc(size);
-        m_intBuffer.malloc(size);
-        m_tsBuffer.malloc(size);
+        const Array<int>& channels = *m_fileChannels[file];
+        int nChans = channels.size();
+        int firstChan = channels[0];
+        const CircularBufferIndexes& first = indexes.getReference(firstChan);
+        int64 firstTS = getTimestamp(firstChan);
+
+        //All the channels of a file come from the same source, so they should always be in step
+        bool aligned = true;
+        for (int i = 1; i < nChans && aligned; i++)
+        {
+            int chan = channels[i];
+            const CircularBufferIndexes& idx = indexes.getReference(chan);
+            aligned = (idx.index1 == first.index1) && (idx.size1 == first.size1) && (idx.size2 == first.size2)
+                && ((getTimestamp(chan) - m_startTS[chan]) == (firstTS - m_startTS[firstChan]));
+        }
+
+        if (aligned)
+        {
+            if (first.size1 > 0)
+            {
+                writeFileData(file, buffer, first.index1, first.size1, firstTS);
+                if (first.size2 > 0)
+                    writeFileData(file, buffer, first.index2, first.size2, firstTS + first.size1);
+            }
+        }
+        else
+        {
+            //Shouldn't happen, but if it does, write the channels one by one
+            for (int i = 0; i < nChans; i++)
+            {
+                int chan = channels[i];
+                const CircularBufferIndexes& idx = indexes.getReference(chan);
+                if (idx.size1 > 0)
+                {
+                    writeChannelData(chan, getRealChannel(chan), buffer.getReadPointer(chan, idx.index1), idx.size1, getTimestamp(chan));
+                    if (idx.size2 > 0)
+                        writeChannelData(chan, getRealChannel(chan), buffer.getReadPointer(chan, idx.index2), idx.size2, getTimestamp(chan) + idx.size1);
+                }
+            }
+        }
     }
+}
+
+void BinaryRecording::writeChannelData(int writeChannel, int realChannel, const float* buffer, int size, int64 timestamp)
+{
+    checkBufferSize(size);
     double multFactor = 1 / (float(0x7fff) * getDataChannel(realChannel)->getBitVolts());
     FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), buffer, multFactor,
                                             size);
     AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(),
                                                size);
     int fileIndex = m_fileIndexes[writeChannel];
-    m_DataFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
-                                         m_channelIndexes[writeChannel],
-                                         m_intBuffer.getData(), size);
+    writeContinuousChannel(fileIndex, timestamp - m_startTS[writeChannel],
+                           m_channelIndexes[writeChannel],
+                           m_intBuffer.getData(), size);
 
     if (m_channelIndexes[writeChannel] == 0)
+        writeDataTimestamps(fileIndex, timestamp, size);
+}
+
+void BinaryRecording::writeFileData(int fileIndex, const AudioSampleBuffer& buffer, int bufferIndex, int size, int64 timestamp)
+{
+    checkBufferSize(size);
+    const Array<int>& channels = *m_fileChannels[fileIndex];
+    int nChans = channels.size();
+    for (int i = 0; i < nChans; i++)
     {
-        int64 baseTS = getTimestamp(writeChannel);
-        //Let's hope that the compiler is smart enough to vectorize this.
-        for (int i = 0; i < size; i++)
-        {
-            m_tsBuffer[i] = (baseTS + i);
-        }
-        m_dataTimestampFiles[fileIndex]->writeData(m_tsBuffer, size*sizeof(int64));
-        m_dataTimestampFiles[fileIndex]->increaseRecordCount(size);
+        int chan = channels[i];
+        m_channelPointers[i] = buffer.getReadPointer(chan, bufferIndex);
+        m_fileScales[i] = m_channelScales[chan];
     }
+    writeContinuousFile(fileIndex, timestamp - m_startTS[channels[0]], m_channelPointers, m_fileScales, size);
+
+    writeDataTimestamps(fileIndex, timestamp, size);
 }
 
+void BinaryRecording::writeDataTimestamps(int fileIndex, int64 baseTS, int size)
+{
+    m_dataTimestampFiles[fileIndex]->writeTimestamps(baseTS, size);
+}
+
+void BinaryRecording::checkBufferSize(int size)
+{
+    if (size > m_bufferSize)
+    // shouldn't happen, and if it does it'll be slow, but better this than crashing
+    {
+        std::cerr << "Write buffer overrun, resizing to" << size << std::endl;
+        m_bufferSize = size;
+        m_scaledBuffer.malloc(size);
+        m_intBuffer.malloc(size);
+    }
+}
 
 void BinaryRecording::addSpikeElectrode(int index, const SpikeChannel* elec)
 {
@@ -525,30 +628,43 @@ void BinaryRecording::writeEventMetaData(const MetaDataEvent* event, NpyFile* fi
 
 void BinaryRecording::writeEvent(int eventIndex, const MidiMessage& event)
 {
-    EventPtr ev = Event::deserializeFromMessage(event, getEventChannel(eventIndex));
+    writeEventView(eventIndex, EventView(event, getEventChannel(eventIndex)));
+}
+
+void BinaryRecording::writeEvents(const QueuedEvent* events, int nEvents)
+{
+    for (int i = 0; i < nEvents; i++)
+    {
+        const QueuedEvent& event = events[i];
+        writeEventView(event.extra, EventView(event.data, event.size, getEventChannel(event.extra)));
+    }
+}
+
+void BinaryRecording::writeEventView(int eventIndex, const EventView& ev)
+{
     EventRecording* rec = m_eventFiles[eventIndex];
-    if (!rec) return;
-    const EventChannel* info = getEventChannel(eventIndex);
-    int64 ts = ev->getTimestamp();
+    if (!rec || !ev.isValid()) return;
+    int64 ts = ev.getTimestamp();
     rec->timestampFile->writeData(&ts, sizeof(int64));
 
-    uint16 chan = ev->getChannel() +1;
+    uint16 chan = ev.getChannel() +1;
     rec->channelFile->writeData(&chan, sizeof(uint16));
 
-    if (ev->getEventType() == EventChannel::TTL)
+    if (ev.getEventType() == EventChannel::TTL)
     {
-        TTLEvent* ttl = static_cast<TTLEvent*>(ev.get());
-        int16 data = (ttl->getChannel()+1) * (ttl->getState() ? 1 : -1);
+        int16 data = (ev.getChannel()+1) * (ev.getState() ? 1 : -1);
         rec->mainFile->writeData(&data, sizeof(int16));
         if (rec->extraFile)
-            rec->extraFile->writeData(ttl->getTTLWordPointer(), info->getDataSize());
+            rec->extraFile->writeData(ev.getRawDataPointer(), ev.getDataSize());
     }
     else
     {
-        rec->mainFile->writeData(ev->getRawDataPointer(), info->getDataSize());
+        rec->mainFile->writeData(ev.getRawDataPointer(), ev.getDataSize());
     }
 
-    writeEventMetaData(ev.get(), rec->metaDataFile);
+    //Metadata values are serialized back to back, in the same order they are stored in the file
+    if (rec->metaDataFile && ev.getMetaDataSize() > 0)
+        rec->metaDataFile->writeData(ev.getMetaDataPointer(), ev.getMetaDataSize());
     increaseEventCounts(rec);
 }
 
@@ -611,12 +727,21 @@ RecordEngineManager* BinaryRecording::getEngineManager()
     EngineParameter* param;
     param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
     man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 1, "Write continuous data in a separate thread", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 2, "Disk preallocation step (MB, Linux only)", 0, 0, 4096);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 4, "Write continuous timestamps as runs", false);
+    man->addParameter(param);
     return man;
 }
 
 void BinaryRecording::setParameter(EngineParameter& parameter)
 {
     boolParameter(0, m_saveTTLWords);
+    boolParameter(1, m_asyncContinuousWrites);
+    intParameter(2, m_preallocationMB);
+    boolParameter(4, m_runLengthTimestamps);
 }
 
 String BinaryRecording::jsonTypeValue(BaseType type)
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../RecordEngine.h"
 #include "SequentialBlockFile.h"
 #include "NpyFile.h"
+#include "DataTimestampFile.h"
 
 namespace BinaryRecordingEngine
 {
@@ -40,7 +41,9 @@ namespace BinaryRecordingEngine
         void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
         void closeFiles() override;
         void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
+        void writeContinuousBlock(const AudioSampleBuffer& buffer, const Array<CircularBufferIndexes>& indexes) override;
         void writeEvent(int eventIndex, const MidiMessage& event) override;
+        void writeEvents(const QueuedEvent* events, int nEvents) override;
         void resetChannels() override;
         void addSpikeElectrode(int index, const SpikeChannel* elec) override;
         void writeSpike(int electrodeIndex, const SpikeEvent* spike) override;
@@ -49,6 +52,16 @@ namespace BinaryRecordingEngine
 
         static RecordEngineManager* getEngineManager();
 
+    protected:
+        /** Continuous file handling. Engines deriving from BinaryRecording can override these to store
+        continuous data differently while keeping the rest of the Binary format.
+        folderPath is the continuous folder of the file and jsonFile its entry in structure.oebin */
+        virtual void openContinuousFile(String folderPath, int numChannels, DynamicObject* jsonFile);
+        virtual void writeContinuousChannel(int fileIndex, uint64 startPos, int channel, int16* data, int nSamples);
+        /** data and scales hold one entry per channel of the file */
+        virtual void writeContinuousFile(int fileIndex, uint64 startPos, const float* const* data, const float* scales, int nSamples);
+        virtual void closeContinuousFiles();
+
     private:
 
         class EventRecording
@@ -65,23 +78,34 @@ namespace BinaryRecordingEngine
         NpyFile* createEventMetadataFile(const MetaDataEventObject* channel, String fileName, DynamicObject* jsonObject);
         void createChannelMetaData(const MetaDataInfoObject* channel, DynamicObject* jsonObject);
         void writeEventMetaData(const MetaDataEvent* event, NpyFile* file);
+        void writeEventView(int eventIndex, const EventView& event);
         void increaseEventCounts(EventRecording* rec);
+        void writeChannelData(int writeChannel, int realChannel, const float* buffer, int size, int64 timestamp);
+        void writeFileData(int fileIndex, const AudioSampleBuffer& buffer, int bufferIndex, int size, int64 timestamp);
+        void writeDataTimestamps(int fileIndex, int64 baseTS, int size);
+        void checkBufferSize(int size);
         static String jsonTypeValue(BaseType type);
         static String getProcessorString(const InfoObjectCommon* channelInfo);
 
         bool m_saveTTLWords{ true };
+        bool m_asyncContinuousWrites{ false };
+        int m_preallocationMB{ 0 };
+        bool m_runLengthTimestamps{ false };
 
         HeapBlock<float> m_scaledBuffer;
         HeapBlock<int16> m_intBuffer;
-        HeapBlock<int64> m_tsBuffer;
         int m_bufferSize;
 
         OwnedArray<SequentialBlockFile> m_DataFiles;
         Array<unsigned int> m_channelIndexes;
         Array<unsigned int> m_fileIndexes;
+        OwnedArray<Array<int>> m_fileChannels;
+        Array<float> m_channelScales;
+        HeapBlock<const float*> m_channelPointers;
+        HeapBlock<float> m_fileScales;
         OwnedArray<EventRecording> m_eventFiles;
         OwnedArray<EventRecording> m_spikeFiles;
-        OwnedArray<NpyFile> m_dataTimestampFiles;
+        OwnedArray<DataTimestampFile> m_dataTimestampFiles;
         ScopedPointer<FileOutputStream> m_syncTextFile;
 
         Array<unsigned int> m_spikeFileIndexes;
@@ -0,0 +1,163 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BlockWriterThread.h"
+
+#if JUCE_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace BinaryRecordingEngine;
+
+BlockWriterThread::BlockWriterThread(String filename, int blockSizeInBytes, int maxPendingBlocks, int64 preallocationSize) :
+Thread("Binary Block Writer"),
+m_blockSizeInBytes(blockSizeInBytes),
+m_maxPendingBlocks(maxPendingBlocks),
+m_preallocationSize(preallocationSize),
+m_bytesWritten(0),
+m_bytesAllocated(0),
+m_fileDescriptor(-1)
+{
+#if JUCE_LINUX
+    if (m_preallocationSize > 0)
+    {
+        m_fileDescriptor = open(filename.toRawUTF8(), O_WRONLY);
+        if (m_fileDescriptor < 0)
+            std::cerr << "BINARY WRITER: Could not open " << filename << " for preallocation" << std::endl;
+    }
+#endif
+    preallocate(m_preallocationSize);
+}
+
+BlockWriterThread::~BlockWriterThread()
+{
+    //run() writes all the pending blocks before exiting
+    signalThreadShouldExit();
+    m_blockQueued.signal();
+    stopThread(-1);
+
+#if JUCE_LINUX
+    if (m_fileDescriptor >= 0)
+        close(m_fileDescriptor);
+#endif
+}
+
+void BlockWriterThread::queueBlock(FileBlock* block)
+{
+    while (true)
+    {
+        {
+            const ScopedLock sl(m_queueLock);
+            if (m_pendingBlocks.size() < m_maxPendingBlocks)
+            {
+                m_pendingBlocks.add(block);
+                break;
+            }
+        }
+        m_blockWritten.wait(10);
+    }
+    m_blockQueued.signal();
+}
+
+FileBlock* BlockWriterThread::getFreeBlock()
+{
+    const ScopedLock sl(m_queueLock);
+    if (m_freeBlocks.size() > 0)
+        return m_freeBlocks.removeAndReturn(m_freeBlocks.size() - 1);
+    return nullptr;
+}
+
+void BlockWriterThread::waitForPendingBlocks()
+{
+    while (true)
+    {
+        {
+            const ScopedLock sl(m_queueLock);
+            if (m_pendingBlocks.size() == 0)
+                return;
+        }
+        m_blockWritten.wait(10);
+    }
+}
+
+void BlockWriterThread::run()
+{
+    while (true)
+    {
+        FileBlock* block = nullptr;
+        {
+            const ScopedLock sl(m_queueLock);
+            if (m_pendingBlocks.size() > 0)
+                block = m_pendingBlocks.getFirst();
+        }
+
+        if (block)
+        {
+            while (m_bytesWritten + m_blockSizeInBytes > m_bytesAllocated)
+                preallocate(m_preallocationSize);
+
+            block->flush();
+            m_bytesWritten += m_blockSizeInBytes;
+            {
+                //The block stays in the pending list while being written, so waitForPendingBlocks also waits for it
+                const ScopedLock sl(m_queueLock);
+                m_pendingBlocks.remove(0);
+                if (m_freeBlocks.size() < m_maxPendingBlocks)
+                    m_freeBlocks.add(block);
+                else
+                    delete block;
+            }
+            m_blockWritten.signal();
+        }
+        else if (threadShouldExit())
+        {
+            break;
+        }
+        else
+        {
+            m_blockQueued.wait(100);
+        }
+    }
+}
+
+void BlockWriterThread::preallocate(int64 size)
+{
+#if JUCE_LINUX
+    //Reserve disk space ahead of the writes without changing the file size, so no trailing zeroes are left on close
+    if (m_fileDescriptor >= 0 && size > 0)
+    {
+        if (fallocate(m_fileDescriptor, FALLOC_FL_KEEP_SIZE, m_bytesAllocated, size) == 0)
+            m_bytesAllocated += size;
+        else
+        {
+            std::cerr << "BINARY WRITER: File preallocation failed, disabling it" << std::endl;
+            close(m_fileDescriptor);
+            m_fileDescriptor = -1;
+        }
+    }
+#endif
+    //Without preallocation, never ask again
+    if (m_fileDescriptor < 0)
+        m_bytesAllocated = std::numeric_limits<int64>::max();
+}
@@ -0,0 +1,74 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BLOCKWRITERTHREAD_H
+#define BLOCKWRITERTHREAD_H
+
+#include "FileMemoryBlock.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /** Writes the filled memory blocks of a SequentialBlockFile from its own thread, so a disk
+    stall doesn't block the record thread. At most maxPendingBlocks can be waiting to be written;
+    past that, queueing a block waits for the writer to catch up. Written blocks are kept for reuse
+    instead of being freed and allocated again for every block. */
+    class BlockWriterThread : public Thread
+    {
+    public:
+        BlockWriterThread(String filename, int blockSizeInBytes, int maxPendingBlocks, int64 preallocationSize);
+        ~BlockWriterThread();
+
+        /** Queues a block to be written in order. The writer takes ownership of the block */
+        void queueBlock(FileBlock* block);
+
+        /** Returns an already written block that can be reset and reused, or nullptr if there are none */
+        FileBlock* getFreeBlock();
+
+        /** Waits until all the queued blocks have been written */
+        void waitForPendingBlocks();
+
+        void run() override;
+
+    private:
+        void preallocate(int64 size);
+
+        CriticalSection m_queueLock;
+        Array<FileBlock*> m_pendingBlocks;
+        OwnedArray<FileBlock> m_freeBlocks;
+        WaitableEvent m_blockQueued;
+        WaitableEvent m_blockWritten;
+
+        const int m_blockSizeInBytes;
+        const int m_maxPendingBlocks;
+        const int64 m_preallocationSize;
+        int64 m_bytesWritten;
+        int64 m_bytesAllocated;
+        int m_fileDescriptor;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockWriterThread);
+    };
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "DataTimestampFile.h"
+
+using namespace BinaryRecordingEngine;
+
+DataTimestampFile::DataTimestampFile(String path, bool runLength) :
+    m_runLength(runLength)
+{
+    if (m_runLength)
+    {
+        m_file = new NpyFile(path + "timestamp_runs.npy", NpyType(BaseType::INT64, 2));
+    }
+    else
+    {
+        m_file = new NpyFile(path + "timestamps.npy", NpyType(BaseType::INT64, 1));
+        m_buffer.malloc(expandBufferSize);
+    }
+}
+
+DataTimestampFile::~DataTimestampFile()
+{
+}
+
+void DataTimestampFile::writeTimestamps(int64 firstTimestamp, int nSamples)
+{
+    if (nSamples <= 0)
+        return;
+
+    if (m_runLength)
+    {
+        // a row only goes out when a run starts, the rest of its samples just extend it
+        if (firstTimestamp != m_nextTimestamp)
+        {
+            int64 row[2] = { m_numSamples, firstTimestamp };
+            m_file->writeData(row, sizeof(row));
+            m_file->increaseRecordCount();
+        }
+        m_numSamples += nSamples;
+        m_nextTimestamp = firstTimestamp + nSamples;
+        return;
+    }
+
+    while (nSamples > 0)
+    {
+        int size = jmin(nSamples, expandBufferSize);
+        for (int i = 0; i < size; i++)
+            m_buffer[i] = firstTimestamp + i;
+        m_file->writeData(m_buffer, size * sizeof(int64));
+        m_file->increaseRecordCount(size);
+        firstTimestamp += size;
+        nSamples -= size;
+    }
+}
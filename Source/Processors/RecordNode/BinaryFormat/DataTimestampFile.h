@@ -0,0 +1,63 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATATIMESTAMPFILE_H
+#define DATATIMESTAMPFILE_H
+
+#include "NpyFile.h"
+
+namespace BinaryRecordingEngine
+{
+
+    /** The timestamps of a continuous file.
+    By default every sample timestamp is written to timestamps.npy as the data arrives. In run-length
+    mode timestamp_runs.npy is written instead, with a (first sample, first timestamp) row for each
+    contiguous run of samples, so timestamp writes don't compete with the sample data for disk
+    bandwidth. Since timestamps are contiguous except after a source restart, there are usually very
+    few runs. The timestamp of sample s is that of the last run starting at or before it plus the
+    samples since its start, which is how the File Reader's seek index reads them. */
+    class DataTimestampFile
+    {
+    public:
+        /** Opens timestamps.npy or timestamp_runs.npy in the directory of path, which ends in a separator */
+        DataTimestampFile(String path, bool runLength);
+        ~DataTimestampFile();
+
+        /** Adds the timestamps of nSamples samples, starting at firstTimestamp */
+        void writeTimestamps(int64 firstTimestamp, int nSamples);
+
+    private:
+        ScopedPointer<NpyFile> m_file;
+        const bool m_runLength;
+        int64 m_numSamples{ 0 };
+        int64 m_nextTimestamp{ -1 };
+        HeapBlock<int64> m_buffer;
+
+        // Compile-time constants
+
+        // number of timestamps written at a time:
+        const int expandBufferSize{ 32768 };
+    };
+
+};
+#endif
@@ -55,14 +55,28 @@ namespace BinaryRecordingEngine
             if (markFlushed)
                 m_flushed = true;
         }
+        void flush()
+        {
+            m_file->write(m_data, m_blockSize*sizeof(StorageType));
+            m_flushed = true;
+        }
+        /** Clears the block so it can be reused at a new position of the same file */
+        void reset(uint64 offset)
+        {
+            m_data.clear(m_blockSize);
+            m_offset = offset;
+            m_flushed = false;
+        }
 
     private:
         HeapBlock<StorageType> m_data;
         FileOutputStream* const m_file;
         const int m_blockSize;
-        const uint64 m_offset;
+        uint64 m_offset;
         bool m_flushed{ false };
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileMemoryBlock);
     };
+
+    typedef FileMemoryBlock<int16> FileBlock;
 }
 #endif
@@ -82,6 +82,7 @@ bool NpyFile::openFile(String path)
     if (!m_file)
         return false;
 
+    m_stagingBuffer.malloc(stagingBufferSize);
     m_okOpen = true;
     return true;
 }
@@ -156,6 +157,9 @@ void NpyFile::writeHeader(const Array<NpyType>& typeList)
 
 void NpyFile::updateHeader()
 {
+    // the header must never count records that are still in the staging buffer
+    flushStagingBuffer();
+
     // overwrite the shape part of the header - even without explicitly calling
     // m_file->flush(), overwriting seems to trigger a flush to disk,
     // while appending to end of file does not
@@ -180,12 +184,31 @@ void NpyFile::updateHeader()
 
 NpyFile::~NpyFile()
 {
-    updateHeader();
+    if (m_okOpen)
+        updateHeader();
 }
 
 void NpyFile::writeData(const void* data, size_t size)
 {
-    m_file->write(data, size);
+    if (m_stagingUsed + size > stagingBufferSize)
+        flushStagingBuffer();
+
+    if (size >= stagingBufferSize)
+    {
+        // large writes go straight to the file
+        m_file->write(data, size);
+        return;
+    }
+    memcpy(m_stagingBuffer + m_stagingUsed, data, size);
+    m_stagingUsed += size;
+}
+
+void NpyFile::flushStagingBuffer()
+{
+    if (m_stagingUsed == 0)
+        return;
+    m_file->write(m_stagingBuffer, m_stagingUsed);
+    m_stagingUsed = 0;
 }
 
 void NpyFile::increaseRecordCount(int count)
@@ -51,10 +51,12 @@ namespace BinaryRecordingEngine
         NpyFile(String path, const Array<NpyType>& typeList);
         NpyFile(String path, NpyType type, unsigned int dim = 1);
         ~NpyFile();
+        /** Data is gathered in a staging buffer and written to the file in large blocks */
         void writeData(const void* data, size_t size);
         void increaseRecordCount(int count = 1);
     private:
         bool openFile(String path);
+        void flushStagingBuffer();
         String getShapeString();
         void writeHeader(const Array<NpyType>& typeList);
         void updateHeader();
@@ -65,11 +67,15 @@ namespace BinaryRecordingEngine
         size_t m_shapePos;
         unsigned int m_dim1;
         unsigned int m_dim2;
+        HeapBlock<char> m_stagingBuffer;
+        size_t m_stagingUsed{ 0 };
 
         // Compile-time constants
 
         // flush file buffer to disk and update the .npy header every this many records:
-        const int recordBufferSize{ 1024 };
+        const int recordBufferSize{ 8192 };
+        // size of the buffer where small writes are gathered before going to the file:
+        const size_t stagingBufferSize{ 256 * 1024 };
 
     };
 
@@ -33,6 +33,7 @@ m_blockSize(nChannels*samplesPerBlock),
 m_lastBlockFill(0)
 {
     m_memBlocks.ensureStorageAllocated(blockArrayInitSize);
+    m_conversionBuffer.malloc(conversionTileSize);
     for (int i = 0; i < nChannels; i++)
         m_currentBlock.add(-1);
 }
@@ -43,14 +44,19 @@ SequentialBlockFile::~SequentialBlockFile()
     int n = m_memBlocks.size();
     for (int i = 0; i < n - 1; i++)
     {
-        m_memBlocks.remove(0);
+        if (m_writer)
+            m_writer->queueBlock(m_memBlocks.removeAndReturn(0));
+        else
+            m_memBlocks.remove(0);
     }
+    //Stopping the writer writes all the queued blocks, so the last one can be appended after them
+    m_writer = nullptr;
 
     //manually flush the last one to avoid trailing zeroes
     m_memBlocks[0]->partialFlush(m_lastBlockFill * m_nChannels);
 }
 
-bool SequentialBlockFile::openFile(String filename)
+bool SequentialBlockFile::openFile(String filename, bool asyncWrite, int64 preallocationSize)
 {
     File file(filename);
     Result res = file.create();
@@ -64,6 +70,12 @@ bool SequentialBlockFile::openFile(String filename)
         return false;
 
     m_memBlocks.add(new FileBlock(m_file, m_blockSize, 0));
+
+    if (asyncWrite)
+    {
+        m_writer = new BlockWriterThread(filename, m_blockSize*sizeof(int16), maxPendingBlocks, preallocationSize);
+        m_writer->startThread();
+    }
     return true;
 }
 
@@ -72,15 +84,7 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
     if (!m_file)
         return false;
 
-    int bIndex = m_memBlocks.size() - 1;
-    if ((bIndex < 0) || (m_memBlocks[bIndex]->getOffset() + m_samplesPerBlock) < (startPos + nSamples))
-        allocateBlocks(startPos, nSamples);
-
-    for (bIndex = m_memBlocks.size() - 1; bIndex >= 0; bIndex--)
-    {
-        if (m_memBlocks[bIndex]->getOffset() <= startPos)
-            break;
-    }
+    int bIndex = getWriteBlock(startPos, nSamples);
     if (bIndex < 0)
     {
         std::cerr << "BINARY WRITER: Memory block unloaded ahead of time for chan " << channel << " start " << startPos << " ns " << nSamples << " first " << m_memBlocks[0]->getOffset() <<std::endl;
@@ -125,6 +129,70 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
     return true;
 }
 
+bool SequentialBlockFile::writeChannelBlock(uint64 startPos, const float* const* data, const float* scales, int nSamples)
+{
+    if (!m_file)
+        return false;
+
+    int bIndex = getWriteBlock(startPos, nSamples);
+    if (bIndex < 0)
+    {
+        std::cerr << "BINARY WRITER: Memory block unloaded ahead of time for block start " << startPos << " ns " << nSamples << " first " << m_memBlocks[0]->getOffset() << std::endl;
+        return false;
+    }
+
+    const int sampleStride = m_nChannels * sizeof(int16);
+    int writtenSamples = 0;
+    int startIdx = startPos - m_memBlocks[bIndex]->getOffset();
+    int lastBlockIdx = m_memBlocks.size() - 1;
+
+    while (writtenSamples < nSamples)
+    {
+        int16* blockPtr = m_memBlocks[bIndex]->getData() + startIdx*m_nChannels;
+        int samplesToWrite = jmin((nSamples - writtenSamples), (m_samplesPerBlock - startIdx));
+
+        //Convert in small tiles, so the interleaved rows being filled stay in cache while going through all the channels
+        for (int tile = 0; tile < samplesToWrite; tile += conversionTileSize)
+        {
+            int tileSamples = jmin(conversionTileSize, samplesToWrite - tile);
+            int16* rowPtr = blockPtr + tile*m_nChannels;
+            for (int chan = 0; chan < m_nChannels; chan++)
+            {
+                FloatVectorOperations::copyWithMultiply(m_conversionBuffer, data[chan] + writtenSamples + tile, scales[chan], tileSamples);
+                AudioDataConverters::convertFloatToInt16LE(m_conversionBuffer, rowPtr + chan, tileSamples, sampleStride);
+            }
+        }
+        writtenSamples += samplesToWrite;
+
+        //Update the last block fill index
+        size_t samplePos = startIdx + samplesToWrite;
+        if (bIndex == lastBlockIdx && samplePos > m_lastBlockFill)
+        {
+            m_lastBlockFill = samplePos;
+        }
+
+        startIdx = 0;
+        bIndex++;
+    }
+    for (int i = 0; i < m_nChannels; i++)
+        m_currentBlock.set(i, bIndex - 1);
+    return true;
+}
+
+int SequentialBlockFile::getWriteBlock(uint64 startPos, int nSamples)
+{
+    int bIndex = m_memBlocks.size() - 1;
+    if ((bIndex < 0) || (m_memBlocks[bIndex]->getOffset() + m_samplesPerBlock) < (startPos + nSamples))
+        allocateBlocks(startPos, nSamples);
+
+    for (bIndex = m_memBlocks.size() - 1; bIndex >= 0; bIndex--)
+    {
+        if (m_memBlocks[bIndex]->getOffset() <= startPos)
+            break;
+    }
+    return bIndex;
+}
+
 void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
 {
     //First deallocate full blocks
@@ -142,7 +210,14 @@ void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
         m_currentBlock.set(i, m_currentBlock[i] - minBlock);
     }
 
-    m_memBlocks.removeRange(0, minBlock);
+    if (m_writer)
+    {
+        int numToRemove = jmin((int)minBlock, m_memBlocks.size());
+        for (int i = 0; i < numToRemove; i++)
+            m_writer->queueBlock(m_memBlocks.removeAndReturn(0));
+    }
+    else
+        m_memBlocks.removeRange(0, minBlock);
 
     //for (int i = 0; i < minBlock; i++)
     //{
@@ -159,7 +234,12 @@ void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
     for (int i = 0; i < newBlocks; i++)
     {
         lastOffset += m_samplesPerBlock;
-        m_memBlocks.add(new FileBlock(m_file, m_blockSize, lastOffset));
+        FileBlock* block = m_writer ? m_writer->getFreeBlock() : nullptr;
+        if (block)
+            block->reset(lastOffset);
+        else
+            block = new FileBlock(m_file, m_blockSize, lastOffset);
+        m_memBlocks.add(block);
     }
     if (newBlocks > 0)
         m_lastBlockFill = 0; //we've added some new blocks, so the last one will be empty
@@ -25,20 +25,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SEQUENTIALBLOCKFILE_H
 
 #include "FileMemoryBlock.h"
+#include "BlockWriterThread.h"
 
 namespace BinaryRecordingEngine
 {
 
-    typedef FileMemoryBlock<int16> FileBlock;
-
     class SequentialBlockFile
     {
     public:
         SequentialBlockFile(int nChannels, int samplesPerBlock);
         ~SequentialBlockFile();
 
-        bool openFile(String filename);
+        /** Opens the file for writing. If asyncWrite is set, full blocks are written from a separate
+        thread. preallocationSize sets the size of the chunks of disk space reserved ahead of the writes
+        (only for asynchronous writes on Linux, 0 to disable) */
+        bool openFile(String filename, bool asyncWrite = false, int64 preallocationSize = 0);
         bool writeChannel(uint64 startPos, int channel, int16* data, int nSamples);
+        /** Scales, converts to int16 and interleaves all the channels of the file at once,
+        writing directly into the memory blocks. data and scales must hold one entry per channel */
+        bool writeChannelBlock(uint64 startPos, const float* const* data, const float* scales, int nSamples);
 
     private:
         ScopedPointer<FileOutputStream> m_file;
@@ -48,13 +53,18 @@ namespace BinaryRecordingEngine
         OwnedArray<FileBlock> m_memBlocks;
         Array<int> m_currentBlock;
         size_t m_lastBlockFill;
+        HeapBlock<float> m_conversionBuffer;
+        ScopedPointer<BlockWriterThread> m_writer;
 
         void allocateBlocks(uint64 startIndex, int numSamples);
+        int getWriteBlock(uint64 startPos, int nSamples);
 
 
         //Compile-time parameters
         const int streamBufferSize{ 0 };
         const int blockArrayInitSize{ 128 };
+        const int conversionTileSize{ 64 };
+        const int maxPendingBlocks{ 16 };
 
     };
 
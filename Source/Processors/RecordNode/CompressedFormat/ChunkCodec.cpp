@@ -0,0 +1,309 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ChunkCodec.h"
+
+using namespace CompressedRecordingEngine;
+
+namespace
+{
+    //Residuals with a quotient this large are written as raw values after an escape code,
+    //which bounds the size of badly predicted samples
+    const int escapeQuotient = 24;
+    const int escapeBits = 18; //order 2 residuals need at most 18 bits after zigzag mapping
+    const int maxRiceParameter = 16;
+    const uint8 verbatimOrder = 0xFF;
+
+    inline uint32 zigzag(int32 v) { return (uint32(v) << 1) ^ uint32(v >> 31); }
+    inline int32 unzigzag(uint32 u) { return int32(u >> 1) ^ -int32(u & 1); }
+
+    inline int32 residual(const int16* data, int i, int stride, int order)
+    {
+        int32 x = data[i * stride];
+        switch (order)
+        {
+        case 0:
+            return x;
+        case 1:
+            return x - data[(i - 1) * stride];
+        default:
+            return x - 2 * int32(data[(i - 1) * stride]) + data[(i - 2) * stride];
+        }
+    }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(MemoryBlock& dest, size_t offset) : m_dest(dest), m_pos(offset), m_acc(0), m_bits(0) {}
+
+        void write(uint32 value, int nBits)
+        {
+            m_acc = (m_acc << nBits) | value;
+            m_bits += nBits;
+            while (m_bits >= 8)
+            {
+                m_bits -= 8;
+                putByte(uint8(m_acc >> m_bits));
+            }
+        }
+
+        /** Pads to a whole byte and returns the position after the last byte written */
+        size_t finish()
+        {
+            if (m_bits > 0)
+                putByte(uint8(m_acc << (8 - m_bits)));
+            m_bits = 0;
+            return m_pos;
+        }
+
+    private:
+        void putByte(uint8 b)
+        {
+            if (m_pos >= m_dest.getSize())
+                m_dest.setSize(jmax(size_t(1024), m_dest.getSize() * 2));
+            static_cast<uint8*>(m_dest.getData())[m_pos++] = b;
+        }
+
+        MemoryBlock& m_dest;
+        size_t m_pos;
+        uint64 m_acc;
+        int m_bits;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8* src, size_t size) : m_src(src), m_size(size), m_pos(0), m_acc(0), m_bits(0) {}
+
+        bool read(int nBits, uint32& value)
+        {
+            if (!fill(nBits))
+                return false;
+            m_bits -= nBits;
+            value = uint32(m_acc >> m_bits) & ((uint32(1) << nBits) - 1);
+            return true;
+        }
+
+        /** Counts consecutive one bits and consumes the terminating zero. Stops at maxOnes */
+        bool readUnary(int maxOnes, int& ones)
+        {
+            ones = 0;
+            while (true)
+            {
+                if (!fill(1))
+                    return false;
+                m_bits--;
+                if (((m_acc >> m_bits) & 1) == 0)
+                    return true;
+                if (++ones > maxOnes)
+                    return false;
+            }
+        }
+
+        /** Skips to the next whole byte and returns the number of bytes consumed */
+        size_t finish()
+        {
+            m_pos -= m_bits / 8;
+            m_bits = 0;
+            return m_pos;
+        }
+
+    private:
+        bool fill(int nBits)
+        {
+            while (m_bits < nBits)
+            {
+                if (m_pos >= m_size)
+                    return false;
+                m_acc = (m_acc << 8) | m_src[m_pos++];
+                m_bits += 8;
+            }
+            return true;
+        }
+
+        const uint8* m_src;
+        size_t m_size;
+        size_t m_pos;
+        uint64 m_acc;
+        int m_bits;
+    };
+}
+
+size_t ChunkCodec::encode(const int16* data, int nChannels, int nSamples, int channelStride, int sampleStride,
+                          MemoryBlock& dest, size_t destOffset)
+{
+    size_t pos = destOffset;
+    for (int c = 0; c < nChannels; c++)
+        pos += encodeChannel(data + c * channelStride, nSamples, sampleStride, dest, pos);
+    return pos - destOffset;
+}
+
+size_t ChunkCodec::encodeChannel(const int16* data, int nSamples, int stride, MemoryBlock& dest, size_t destOffset)
+{
+    //Pick the predictor with the smallest total residual
+    int order = 0;
+    uint64 bestSum = 0;
+    for (int o = 0; o <= 2; o++)
+    {
+        uint64 sum = 0;
+        for (int i = o; i < nSamples; i++)
+            sum += zigzag(residual(data, i, stride, o));
+        if (o == 0 || sum < bestSum)
+        {
+            bestSum = sum;
+            order = o;
+        }
+    }
+    order = jmin(order, nSamples);
+
+    //Rice parameter close to log2 of the mean residual
+    int k = 0;
+    int nResiduals = nSamples - order;
+    while (k < maxRiceParameter && (uint64(nResiduals) << (k + 1)) < bestSum)
+        k++;
+
+    const size_t verbatimSize = 2 + size_t(nSamples) * sizeof(int16);
+    if (dest.getSize() < destOffset + verbatimSize)
+        dest.setSize(jmax(destOffset + verbatimSize, dest.getSize() * 2));
+
+    BitWriter writer(dest, destOffset);
+    writer.write(order, 8);
+    writer.write(k, 8);
+    for (int i = 0; i < order; i++)
+    {
+        uint16 v = uint16(data[i * stride]);
+        writer.write(v & 0xFF, 8);
+        writer.write(v >> 8, 8);
+    }
+    for (int i = order; i < nSamples; i++)
+    {
+        uint32 u = zigzag(residual(data, i, stride, order));
+        uint32 q = u >> k;
+        if (q < escapeQuotient)
+        {
+            writer.write(((uint32(1) << q) - 1) << 1, q + 1);
+            if (k > 0)
+                writer.write(u & ((uint32(1) << k) - 1), k);
+        }
+        else
+        {
+            writer.write(((uint32(1) << escapeQuotient) - 1) << 1, escapeQuotient + 1);
+            writer.write(u, escapeBits);
+        }
+    }
+    size_t size = writer.finish() - destOffset;
+    if (size <= verbatimSize)
+        return size;
+
+    //Noise-like data that doesn't compress is stored as it is
+    uint8* out = static_cast<uint8*>(dest.getData()) + destOffset;
+    out[0] = verbatimOrder;
+    out[1] = 0;
+    for (int i = 0; i < nSamples; i++)
+    {
+        uint16 v = uint16(data[i * stride]);
+        out[2 + 2 * i] = uint8(v & 0xFF);
+        out[3 + 2 * i] = uint8(v >> 8);
+    }
+    return verbatimSize;
+}
+
+bool ChunkCodec::decode(const uint8* src, size_t srcSize, int nChannels, int nSamples,
+                        int16* dest, int channelStride, int sampleStride)
+{
+    size_t pos = 0;
+    for (int c = 0; c < nChannels; c++)
+    {
+        int16* out = dest + c * channelStride;
+        if (pos + 2 > srcSize)
+            return false;
+        int order = src[pos];
+        int k = src[pos + 1];
+
+        if (order == verbatimOrder)
+        {
+            if (pos + 2 + size_t(nSamples) * 2 > srcSize)
+                return false;
+            const uint8* in = src + pos + 2;
+            for (int i = 0; i < nSamples; i++)
+                out[i * sampleStride] = int16(uint16(in[2 * i]) | (uint16(in[2 * i + 1]) << 8));
+            pos += 2 + size_t(nSamples) * 2;
+            continue;
+        }
+        if (order > 2 || k > maxRiceParameter)
+            return false;
+
+        BitReader reader(src + pos, srcSize - pos);
+        uint32 v;
+        reader.read(8, v);
+        reader.read(8, v);
+        for (int i = 0; i < order; i++)
+        {
+            uint32 lo, hi;
+            if (!reader.read(8, lo) || !reader.read(8, hi))
+                return false;
+            out[i * sampleStride] = int16(uint16(lo | (hi << 8)));
+        }
+
+        int32 prev1 = order > 0 ? out[(order - 1) * sampleStride] : 0;
+        int32 prev2 = order > 1 ? out[(order - 2) * sampleStride] : 0;
+        for (int i = order; i < nSamples; i++)
+        {
+            int q;
+            uint32 u;
+            if (!reader.readUnary(escapeQuotient, q))
+                return false;
+            if (q == escapeQuotient)
+            {
+                if (!reader.read(escapeBits, u))
+                    return false;
+            }
+            else
+            {
+                uint32 rem = 0;
+                if (k > 0 && !reader.read(k, rem))
+                    return false;
+                u = (uint32(q) << k) | rem;
+            }
+            int32 r = unzigzag(u);
+            int32 x;
+            switch (order)
+            {
+            case 0:
+                x = r;
+                break;
+            case 1:
+                x = r + prev1;
+                break;
+            default:
+                x = r + 2 * prev1 - prev2;
+                break;
+            }
+            out[i * sampleStride] = int16(x);
+            prev2 = prev1;
+            prev1 = x;
+        }
+        pos += reader.finish();
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHUNKCODEC_H
+#define CHUNKCODEC_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+
+namespace CompressedRecordingEngine
+{
+
+    /**
+    Lossless codec for chunks of int16 continuous data.
+
+    Each channel of a chunk is coded independently: a fixed polynomial predictor (order 0, 1 or 2,
+    whichever gives the smallest residuals) is applied and the zigzag-mapped residuals are Rice coded
+    with a per-channel parameter. Channels that wouldn't get smaller are stored verbatim.
+
+    Layout of a coded channel: predictor order (uint8), Rice parameter (uint8), the first "order"
+    samples as little-endian int16, then the Rice bitstream, padded to a whole byte.
+    */
+    class ChunkCodec
+    {
+    public:
+        /** Codes nChannels x nSamples values, where sample i of channel c is
+        data[c * channelStride + i * sampleStride]. Returns the number of bytes appended to dest at destOffset */
+        static size_t encode(const int16* data, int nChannels, int nSamples, int channelStride, int sampleStride,
+                             MemoryBlock& dest, size_t destOffset);
+
+        /** Decodes a chunk coded by encode() into dest with the given strides. Returns false if the data is corrupt */
+        static bool decode(const uint8* src, size_t srcSize, int nChannels, int nSamples,
+                           int16* dest, int channelStride, int sampleStride);
+
+    private:
+        static size_t encodeChannel(const int16* data, int nSamples, int sampleStride, MemoryBlock& dest, size_t destOffset);
+    };
+
+    /** File layout of the continuous.oecz files written by CompressedRecording:
+
+    Header: FileHeader followed by jsonSize bytes of UTF-8 JSON describing the channels, with the same
+    contents as the continuous entries of a Binary structure.oebin file.
+    Chunks: ChunkHeader followed by compressedSize bytes coded by ChunkCodec.
+    Index (only present if the file was closed properly): one IndexEntry per chunk followed by a FileTrailer.
+    All values are little-endian.
+    */
+    namespace CompressedFile
+    {
+        const uint32 headerMagic = 0x5A43454F; // "OECZ"
+        const uint32 trailerMagic = 0x4943454F; // "OECI"
+        const uint32 formatVersion = 1;
+
+        struct FileHeader
+        {
+            uint32 magic;
+            uint32 version;
+            uint32 numChannels;
+            uint32 samplesPerChunk;
+            uint32 jsonSize;
+        };
+
+        struct ChunkHeader
+        {
+            uint32 compressedSize;
+            uint32 numSamples;
+            int64 firstSample;
+        };
+
+        struct IndexEntry
+        {
+            int64 fileOffset;
+            int64 firstSample;
+            int64 numSamples;
+        };
+
+        struct FileTrailer
+        {
+            int64 indexOffset;
+            uint32 numChunks;
+            uint32 magic;
+        };
+    }
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedContinuousFile.h"
+
+using namespace CompressedRecordingEngine;
+
+class CompressedContinuousFile::Chunk
+{
+public:
+    Chunk(int nChannels, int samplesPerChunk) :
+        samples(size_t(nChannels) * samplesPerChunk),
+        size(size_t(nChannels) * samplesPerChunk),
+        index(0),
+        numSamples(0),
+        compressedSize(0),
+        done(true)
+    {}
+
+    void reset(uint64 chunkIndex)
+    {
+        samples.clear(size);
+        index = chunkIndex;
+        numSamples = 0;
+        compressedSize = 0;
+        done.reset();
+    }
+
+    HeapBlock<int16> samples; //planar, samplesPerChunk values per channel
+    const size_t size;
+    uint64 index;
+    int numSamples;
+    MemoryBlock compressed;
+    size_t compressedSize;
+    WaitableEvent done;
+};
+
+class CompressedContinuousFile::CompressionJob : public ThreadPoolJob
+{
+public:
+    CompressionJob(Chunk& chunk, int nChannels, int samplesPerChunk) :
+        ThreadPoolJob("Chunk compression"),
+        m_chunk(chunk),
+        m_nChannels(nChannels),
+        m_samplesPerChunk(samplesPerChunk)
+    {}
+
+    JobStatus runJob() override
+    {
+        m_chunk.compressedSize = ChunkCodec::encode(m_chunk.samples, m_nChannels, m_chunk.numSamples,
+                                                    m_samplesPerChunk, 1, m_chunk.compressed, 0);
+        m_chunk.done.signal();
+        return jobHasFinished;
+    }
+
+private:
+    Chunk& m_chunk;
+    const int m_nChannels;
+    const int m_samplesPerChunk;
+};
+
+CompressedContinuousFile::CompressedContinuousFile(int nChannels, int samplesPerChunk, ThreadPool& pool, int maxPendingChunks) :
+m_pool(pool),
+m_nChannels(nChannels),
+m_samplesPerChunk(samplesPerChunk),
+m_maxPendingChunks(maxPendingChunks),
+m_firstChunkIndex(0),
+m_numSubmitted(0)
+{
+    m_channelPositions.insertMultiple(0, 0, nChannels);
+    m_conversionBuffer.malloc(conversionTileSize);
+}
+
+CompressedContinuousFile::~CompressedContinuousFile()
+{
+    if (m_file)
+    {
+        submitCompleteChunks(true);
+        writeCompressedChunks(true);
+        writeIndex();
+        m_file->flush();
+    }
+}
+
+bool CompressedContinuousFile::openFile(String filename, const String& header)
+{
+    File file(filename);
+    Result res = file.create();
+    if (res.failed())
+    {
+        std::cerr << "Error creating file " << filename << ":" << res.getErrorMessage() << std::endl;
+        return false;
+    }
+    m_file = file.createOutputStream();
+    if (!m_file)
+        return false;
+
+    CompressedFile::FileHeader fileHeader;
+    fileHeader.magic = CompressedFile::headerMagic;
+    fileHeader.version = CompressedFile::formatVersion;
+    fileHeader.numChannels = m_nChannels;
+    fileHeader.samplesPerChunk = m_samplesPerChunk;
+    fileHeader.jsonSize = header.getNumBytesAsUTF8();
+    m_file->write(&fileHeader, sizeof(fileHeader));
+    m_file->write(header.toRawUTF8(), fileHeader.jsonSize);
+    return true;
+}
+
+CompressedContinuousFile::Chunk* CompressedContinuousFile::getChunk(uint64 chunkIndex)
+{
+    if (chunkIndex < m_firstChunkIndex + m_numSubmitted)
+    {
+        std::cerr << "COMPRESSED WRITER: Sample written after its chunk was compressed" << std::endl;
+        return nullptr;
+    }
+
+    while (m_firstChunkIndex + m_chunks.size() <= chunkIndex)
+    {
+        Chunk* chunk = m_freeChunks.size() > 0 ? m_freeChunks.removeAndReturn(m_freeChunks.size() - 1)
+                                               : new Chunk(m_nChannels, m_samplesPerChunk);
+        chunk->reset(m_firstChunkIndex + m_chunks.size());
+        m_chunks.add(chunk);
+    }
+    return m_chunks[int(chunkIndex - m_firstChunkIndex)];
+}
+
+bool CompressedContinuousFile::writeChannel(uint64 startPos, int channel, const int16* data, int nSamples)
+{
+    if (!m_file)
+        return false;
+
+    int written = 0;
+    while (written < nSamples)
+    {
+        uint64 pos = startPos + written;
+        int offset = int(pos % m_samplesPerChunk);
+        int count = jmin(nSamples - written, m_samplesPerChunk - offset);
+        Chunk* chunk = getChunk(pos / m_samplesPerChunk);
+        if (!chunk)
+            return false;
+        memcpy(chunk->samples + channel * m_samplesPerChunk + offset, data + written, count * sizeof(int16));
+        written += count;
+    }
+    m_channelPositions.set(channel, jmax(m_channelPositions[channel], startPos + nSamples));
+
+    submitCompleteChunks(false);
+    writeCompressedChunks(false);
+    return true;
+}
+
+bool CompressedContinuousFile::writeChannelBlock(uint64 startPos, const float* const* data, const float* scales, int nSamples)
+{
+    if (!m_file)
+        return false;
+
+    int written = 0;
+    while (written < nSamples)
+    {
+        uint64 pos = startPos + written;
+        int offset = int(pos % m_samplesPerChunk);
+        int count = jmin(nSamples - written, m_samplesPerChunk - offset);
+        Chunk* chunk = getChunk(pos / m_samplesPerChunk);
+        if (!chunk)
+            return false;
+
+        for (int c = 0; c < m_nChannels; c++)
+        {
+            int16* dest = chunk->samples + c * m_samplesPerChunk + offset;
+            for (int tile = 0; tile < count; tile += conversionTileSize)
+            {
+                int tileSize = jmin(conversionTileSize, count - tile);
+                FloatVectorOperations::copyWithMultiply(m_conversionBuffer.getData(), data[c] + written + tile, scales[c], tileSize);
+                AudioDataConverters::convertFloatToInt16LE(m_conversionBuffer.getData(), dest + tile, tileSize);
+            }
+        }
+        written += count;
+    }
+    for (int c = 0; c < m_nChannels; c++)
+        m_channelPositions.set(c, jmax(m_channelPositions[c], startPos + nSamples));
+
+    submitCompleteChunks(false);
+    writeCompressedChunks(false);
+    return true;
+}
+
+void CompressedContinuousFile::submitCompleteChunks(bool flushAll)
+{
+    //A chunk can be compressed once all channels have been written past its end. When flushing, the last partial chunk is sent too
+    uint64 complete = m_channelPositions[0];
+    for (int c = 1; c < m_nChannels; c++)
+        complete = flushAll ? jmax(complete, m_channelPositions[c]) : jmin(complete, m_channelPositions[c]);
+
+    while (m_numSubmitted < m_chunks.size())
+    {
+        Chunk* chunk = m_chunks[m_numSubmitted];
+        uint64 chunkStart = chunk->index * m_samplesPerChunk;
+        if (complete >= chunkStart + m_samplesPerChunk)
+            chunk->numSamples = m_samplesPerChunk;
+        else if (flushAll && complete > chunkStart)
+            chunk->numSamples = int(complete - chunkStart);
+        else
+            break;
+
+        m_pool.addJob(new CompressionJob(*chunk, m_nChannels, m_samplesPerChunk), true);
+        m_numSubmitted++;
+    }
+}
+
+void CompressedContinuousFile::writeCompressedChunks(bool waitForAll)
+{
+    while (m_numSubmitted > 0)
+    {
+        Chunk* chunk = m_chunks[0];
+        bool mustWait = waitForAll || m_numSubmitted > m_maxPendingChunks;
+        if (!chunk->done.wait(mustWait ? -1 : 0))
+            break;
+
+        CompressedFile::ChunkHeader header;
+        header.compressedSize = uint32(chunk->compressedSize);
+        header.numSamples = chunk->numSamples;
+        header.firstSample = chunk->index * m_samplesPerChunk;
+
+        CompressedFile::IndexEntry entry;
+        entry.fileOffset = m_file->getPosition();
+        entry.firstSample = header.firstSample;
+        entry.numSamples = header.numSamples;
+        m_index.add(entry);
+
+        m_file->write(&header, sizeof(header));
+        m_file->write(chunk->compressed.getData(), chunk->compressedSize);
+
+        m_freeChunks.add(m_chunks.removeAndReturn(0));
+        m_firstChunkIndex++;
+        m_numSubmitted--;
+    }
+}
+
+void CompressedContinuousFile::writeIndex()
+{
+    CompressedFile::FileTrailer trailer;
+    trailer.indexOffset = m_file->getPosition();
+    trailer.numChunks = m_index.size();
+    trailer.magic = CompressedFile::trailerMagic;
+
+    m_file->write(m_index.getRawDataPointer(), m_index.size() * sizeof(CompressedFile::IndexEntry));
+    m_file->write(&trailer, sizeof(trailer));
+}
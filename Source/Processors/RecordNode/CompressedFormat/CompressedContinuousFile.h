@@ -0,0 +1,84 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDCONTINUOUSFILE_H
+#define COMPRESSEDCONTINUOUSFILE_H
+
+#include "ChunkCodec.h"
+
+namespace CompressedRecordingEngine
+{
+
+    /**
+    Writes continuous data as independently compressed chunks of samplesPerChunk samples.
+
+    Samples are gathered in planar int16 chunks. Once every channel has filled a chunk it is
+    compressed by a job on the shared ThreadPool, and compressed chunks are written to disk in order
+    from the record thread the next time it writes data. If the pool falls behind by more than
+    maxPendingChunks the writing thread waits for it.
+    */
+    class CompressedContinuousFile
+    {
+    public:
+        CompressedContinuousFile(int nChannels, int samplesPerChunk, ThreadPool& pool, int maxPendingChunks);
+        /** Compresses and writes any remaining data and the chunk index */
+        ~CompressedContinuousFile();
+
+        /** Creates the file and writes the header. header is a JSON description of the channels */
+        bool openFile(String filename, const String& header);
+        bool writeChannel(uint64 startPos, int channel, const int16* data, int nSamples);
+        /** Scales and converts to int16 all the channels of the file at once. data and scales must hold one entry per channel */
+        bool writeChannelBlock(uint64 startPos, const float* const* data, const float* scales, int nSamples);
+
+    private:
+        class Chunk;
+        class CompressionJob;
+
+        Chunk* getChunk(uint64 chunkIndex);
+        void submitCompleteChunks(bool flushAll);
+        void writeCompressedChunks(bool waitForAll);
+        void writeIndex();
+
+        ScopedPointer<FileOutputStream> m_file;
+        ThreadPool& m_pool;
+        const int m_nChannels;
+        const int m_samplesPerChunk;
+        const int m_maxPendingChunks;
+
+        OwnedArray<Chunk> m_chunks; //chunks not yet written, in order
+        OwnedArray<Chunk> m_freeChunks;
+        uint64 m_firstChunkIndex;
+        int m_numSubmitted;
+        Array<uint64> m_channelPositions;
+        Array<CompressedFile::IndexEntry> m_index;
+        HeapBlock<float> m_conversionBuffer;
+
+        //Compile-time parameters
+        const int conversionTileSize{ 64 };
+
+        JUCE_DECLARE_NON_COPYABLE(CompressedContinuousFile);
+    };
+
+}
+
+#endif
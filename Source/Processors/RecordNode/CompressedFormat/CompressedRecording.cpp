@@ -0,0 +1,98 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CompressedRecording.h"
+
+using namespace CompressedRecordingEngine;
+
+CompressedRecording::CompressedRecording() :
+m_numThreads(jmax(1, SystemStats::getNumCpus() / 2)),
+m_poolThreads(0)
+{
+}
+
+CompressedRecording::~CompressedRecording()
+{
+    m_compressedFiles.clear();
+}
+
+String CompressedRecording::getEngineID() const
+{
+    return "COMPRESSED";
+}
+
+void CompressedRecording::openContinuousFile(String folderPath, int numChannels, DynamicObject* jsonFile)
+{
+    if (!m_pool || m_poolThreads != m_numThreads)
+    {
+        m_compressedFiles.clear();
+        m_pool = new ThreadPool(m_numThreads);
+        m_poolThreads = m_numThreads;
+    }
+
+    jsonFile->setProperty("file_name", "continuous.oecz");
+    jsonFile->setProperty("compression", "delta-rice");
+
+    ScopedPointer<CompressedContinuousFile> cFile = new CompressedContinuousFile(numChannels, samplesPerChunk, *m_pool, maxPendingChunks);
+    if (cFile->openFile(folderPath + "continuous.oecz", JSON::toString(var(jsonFile), true)))
+        m_compressedFiles.add(cFile.release());
+    else
+        m_compressedFiles.add(nullptr);
+}
+
+void CompressedRecording::writeContinuousChannel(int fileIndex, uint64 startPos, int channel, int16* data, int nSamples)
+{
+    if (m_compressedFiles[fileIndex])
+        m_compressedFiles[fileIndex]->writeChannel(startPos, channel, data, nSamples);
+}
+
+void CompressedRecording::writeContinuousFile(int fileIndex, uint64 startPos, const float* const* data, const float* scales, int nSamples)
+{
+    if (m_compressedFiles[fileIndex])
+        m_compressedFiles[fileIndex]->writeChannelBlock(startPos, data, scales, nSamples);
+}
+
+void CompressedRecording::closeContinuousFiles()
+{
+    m_compressedFiles.clear();
+}
+
+RecordEngineManager* CompressedRecording::getEngineManager()
+{
+    RecordEngineManager* man = new RecordEngineManager("COMPRESSED", "Compressed binary",
+                                                       &(engineFactory<CompressedRecording>));
+    EngineParameter* param;
+    param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::INT, 3, "Compression threads", jmax(1, SystemStats::getNumCpus() / 2), 1, 64);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 4, "Write continuous timestamps as runs", false);
+    man->addParameter(param);
+    return man;
+}
+
+void CompressedRecording::setParameter(EngineParameter& parameter)
+{
+    BinaryRecording::setParameter(parameter);
+    intParameter(3, m_numThreads);
+}
@@ -0,0 +1,72 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2013 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMPRESSEDRECORDING_H
+#define COMPRESSEDRECORDING_H
+
+#include "../BinaryFormat/BinaryRecording.h"
+#include "CompressedContinuousFile.h"
+
+namespace CompressedRecordingEngine
+{
+
+    /**
+    Binary format with lossless compression of the continuous data.
+
+    Events, spikes, timestamps and structure.oebin are written exactly as in the Binary format, but the
+    continuous data of each processor goes to a continuous.oecz file (see ChunkCodec) instead of
+    continuous.dat. Compression runs on a pool of worker threads shared by all files.
+    */
+    class CompressedRecording : public BinaryRecordingEngine::BinaryRecording
+    {
+    public:
+        CompressedRecording();
+        ~CompressedRecording();
+
+        String getEngineID() const override;
+        void setParameter(EngineParameter& parameter) override;
+
+        static RecordEngineManager* getEngineManager();
+
+    protected:
+        void openContinuousFile(String folderPath, int numChannels, DynamicObject* jsonFile) override;
+        void writeContinuousChannel(int fileIndex, uint64 startPos, int channel, int16* data, int nSamples) override;
+        void writeContinuousFile(int fileIndex, uint64 startPos, const float* const* data, const float* scales, int nSamples) override;
+        void closeContinuousFiles() override;
+
+    private:
+        int m_numThreads;
+        int m_poolThreads;
+
+        //Declared before the files, which must be finished before the pool is destroyed
+        ScopedPointer<ThreadPool> m_pool;
+        OwnedArray<CompressedContinuousFile> m_compressedFiles;
+
+        //Compile-time constants
+        const int samplesPerChunk{ 4096 };
+        const int maxPendingChunks{ 32 };
+    };
+
+}
+
+#endif
@@ -29,7 +29,9 @@ m_numChans(0),
 m_blockSize(blockSize),
 m_readInProgress(false),
 m_numBlocks(nBlocks),
-m_maxSize(blockSize*nBlocks)
+m_maxSize(blockSize*nBlocks),
+m_droppedSamples(0),
+m_maxQueuedSamples(0)
 {}
 
 DataQueue::~DataQueue()
@@ -55,6 +57,7 @@ void DataQueue::setChannels(int nChans)
 		m_lastReadTimestamps.add(0);
 	}
 	m_buffer.setSize(nChans, m_maxSize);
+	resetStatistics();
 }
 
 void DataQueue::resize(int nBlocks)
@@ -75,6 +78,7 @@ void DataQueue::resize(int nBlocks)
 		m_lastReadTimestamps.set(i, 0);
 	}
 	m_buffer.setSize(m_numChans, size);
+	resetStatistics();
 }
 
 void DataQueue::fillTimestamps(int channel, int index, int size, int64 timestamp)
@@ -109,13 +113,14 @@ void DataQueue::fillTimestamps(int channel, int index, int size, int64 timestamp
 	}
 }
 
-void DataQueue::writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp)
+bool DataQueue::writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp)
 {
 	int index1, size1, index2, size2;
 	m_fifos[channel]->prepareToWrite(nSamples, index1, size1, index2, size2);
-	if ((size1 + size2) < nSamples)
-	{ //TODO: turn this into a proper notification. Probably returning a bool.
-		std::cerr << "Recording Data Queue Overflow" << std::endl;
+	bool overflow = (size1 + size2) < nSamples;
+	if (overflow)
+	{
+		m_droppedSamples += nSamples - (size1 + size2);
 	}
 	m_buffer.copyFrom(channel,
 		index1,
@@ -138,6 +143,13 @@ void DataQueue::writeChannel(const AudioSampleBuffer& buffer, int channel, int s
 		fillTimestamps(channel, index2, size2, timestamp + size1);
 	}
 	m_fifos[channel]->finishedWrite(size1 + size2);
+
+	//Only this thread writes the high-water mark, so there's no need for a compare-exchange loop
+	int queued = m_fifos[channel]->getNumReady();
+	if (queued > m_maxQueuedSamples.load(std::memory_order_relaxed))
+		m_maxQueuedSamples.store(queued, std::memory_order_relaxed);
+
+	return !overflow;
 }
 
 /* 
@@ -208,6 +220,27 @@ void DataQueue::stopRead()
 	m_readInProgress = false;
 }
 
+int64 DataQueue::getDroppedSamples() const
+{
+	return m_droppedSamples;
+}
+
+int DataQueue::getMaxQueuedSamples() const
+{
+	return m_maxQueuedSamples;
+}
+
+int DataQueue::getCapacity() const
+{
+	return m_maxSize;
+}
+
+void DataQueue::resetStatistics()
+{
+	m_droppedSamples = 0;
+	m_maxQueuedSamples = 0;
+}
+
 void DataQueue::getTimestampsForBlock(int idx, Array<int64>& timestamps) const
 {
 	timestamps.clear();
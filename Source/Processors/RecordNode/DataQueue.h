@@ -25,6 +25,7 @@
 #define DATAQUEUE_H_INCLUDED
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
+#include <atomic>
 
 struct CircularBufferIndexes
 {
@@ -45,11 +46,19 @@ public:
 
 	//Only the methods after this comment are considered thread-safe.
 	//Caution must be had to avoid calling more than one of the methods above simulatenously
-	void writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp);
+	/** Returns false if the queue was full and some samples had to be dropped */
+	bool writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp);
 	bool startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax);
 	const AudioSampleBuffer& getAudioBufferReference() const;
 	void stopRead();
-	
+
+	/** Number of samples dropped since the last reset because the queue was full, summed over all channels */
+	int64 getDroppedSamples() const;
+	/** Maximum number of samples waiting to be written in any channel since the last reset */
+	int getMaxQueuedSamples() const;
+	/** Maximum number of samples each channel can hold */
+	int getCapacity() const;
+	void resetStatistics();
 
 private:
 	void fillTimestamps(int channel, int index, int size, int64 timestamp);
@@ -66,6 +75,9 @@ private:
 	int m_numBlocks;
 	int m_maxSize;
 
+	std::atomic<int64> m_droppedSamples;
+	std::atomic<int> m_maxQueuedSamples;
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataQueue);
 };
 
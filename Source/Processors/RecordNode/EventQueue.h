@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../Events/Events.h"
 #include <vector>
+#include <atomic>
 
 template <class MsgContainer>
 class AsyncEventMessage :
@@ -61,7 +62,9 @@ public:
 	typedef ReferenceCountedObjectPtr<EventContainer> EventClassPtr;
 
 	EventQueue(int size) :
-		m_fifo(size)
+		m_fifo(size),
+		m_droppedEvents(0),
+		m_maxQueuedEvents(0)
 	{
 		m_data.resize(size);
 	}
@@ -79,6 +82,7 @@ public:
 		m_data.clear();
 		m_fifo.reset();
 		m_data.resize(m_fifo.getTotalSize());
+		resetStatistics();
 	}
 
 	void resize(int size)
@@ -87,19 +91,29 @@ public:
 		reset();
 	}
 
-	void addEvent(const EventClass& ev, int64 t, int extra = 0)
+	/** Returns false if the queue was full and the event had to be dropped */
+	bool addEvent(const EventClass& ev, int64 t, int extra = 0)
 	{
 		int pos1, size1, pos2, size2;
 		size1 = 0;
 		m_fifo.prepareToWrite(1, pos1, size1, pos2, size2);
 
-		/* This means there is a buffer overrun. Instead of overwritting the existing data and risking a collision of both threads
-			we just skip the incoming samples. TODO: use this to notify of the overrun and act consequently   */
-		if (size1 > 0)
+		/* If there is no space there is a buffer overrun. Instead of overwritting the existing data and risking a collision
+			of both threads we just skip the incoming event and count it, so the overrun can be reported */
+		if (size1 == 0)
 		{
-			m_data[pos1] = new EventContainer(ev, t, extra);
-			m_fifo.finishedWrite(1);
+			++m_droppedEvents;
+			return false;
 		}
+
+		m_data[pos1] = new EventContainer(ev, t, extra);
+		m_fifo.finishedWrite(1);
+
+		//Only the writing thread updates the high-water mark
+		int queued = m_fifo.getNumReady();
+		if (queued > m_maxQueuedEvents.load(std::memory_order_relaxed))
+			m_maxQueuedEvents.store(queued, std::memory_order_relaxed);
+		return true;
 	}
 
 	int getEvents(std::vector<EventClassPtr>& vec, int max)
@@ -124,17 +138,202 @@ public:
 		return numToRead;
 	}
 
+	/** Number of events dropped since the last reset because the queue was full */
+	int64 getDroppedEvents() const
+	{
+		return m_droppedEvents;
+	}
+
+	/** Maximum number of events waiting to be written since the last reset */
+	int getMaxQueuedEvents() const
+	{
+		return m_maxQueuedEvents;
+	}
+
+	int getCapacity() const
+	{
+		return m_fifo.getTotalSize();
+	}
+
+	void resetStatistics()
+	{
+		m_droppedEvents = 0;
+		m_maxQueuedEvents = 0;
+	}
+
 private:
 	std::vector<EventClassPtr> m_data;
 	AbstractFifo m_fifo;
+	std::atomic<int64> m_droppedEvents;
+	std::atomic<int> m_maxQueuedEvents;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventQueue);
 };
+
+/** A serialized event held in a SerializedEventQueue slot. The data is valid until the queue's stopRead is called */
+struct QueuedEvent
+{
+	const uint8* data;
+	size_t size;
+	int64 timestamp;
+	int extra;
+};
+
+/**
+Queue of serialized events that copies each event into a preallocated slot, instead of
+allocating a new reference counted message per event.
+
+Events that don't fit in a slot go to a per-slot overflow buffer that is kept for reuse,
+so once the queue has warmed up adding events doesn't allocate. Like the DataQueue, the
+reader gets pointers into the queue with startRead and must call stopRead when done with them.
+*/
+class SerializedEventQueue
+{
+public:
+	SerializedEventQueue(int size, int slotSize = 128) :
+		m_fifo(size),
+		m_slotSize(slotSize),
+		m_numRead(0),
+		m_droppedEvents(0),
+		m_maxQueuedEvents(0)
+	{
+		reset();
+	}
+
+	~SerializedEventQueue()
+	{}
+
+	int getRemainingEvents() const
+	{
+		return m_fifo.getNumReady();
+	}
+
+	void reset()
+	{
+		int size = m_fifo.getTotalSize();
+		m_fifo.reset();
+		m_numRead = 0;
+		m_slab.calloc(size_t(size) * m_slotSize);
+		m_slots.clear();
+		for (int i = 0; i < size; ++i)
+			m_slots.add(new Slot());
+		resetStatistics();
+	}
+
+	void resize(int size)
+	{
+		m_fifo.setTotalSize(size);
+		reset();
+	}
+
+	/** Returns false if the queue was full and the event had to be dropped */
+	bool addEvent(const MidiMessage& ev, int64 t, int extra = 0)
+	{
+		int pos1, size1, pos2, size2;
+		size1 = 0;
+		m_fifo.prepareToWrite(1, pos1, size1, pos2, size2);
+
+		if (size1 == 0)
+		{
+			++m_droppedEvents;
+			return false;
+		}
+
+		Slot& slot = *m_slots[pos1];
+		size_t size = ev.getRawDataSize();
+		uint8* dest = m_slab + size_t(pos1) * m_slotSize;
+		if (size > size_t(m_slotSize))
+		{
+			if (size > slot.overflowSize)
+			{
+				slot.overflow.malloc(size);
+				slot.overflowSize = size;
+			}
+			dest = slot.overflow;
+		}
+		memcpy(dest, ev.getRawData(), size);
+		slot.event.data = dest;
+		slot.event.size = size;
+		slot.event.timestamp = t;
+		slot.event.extra = extra;
+		m_fifo.finishedWrite(1);
+
+		//Only the writing thread updates the high-water mark
+		int queued = m_fifo.getNumReady();
+		if (queued > m_maxQueuedEvents.load(std::memory_order_relaxed))
+			m_maxQueuedEvents.store(queued, std::memory_order_relaxed);
+		return true;
+	}
+
+	/** Fills events with up to max (all if max <= 0) queued events and returns how many.
+		Their slots aren't released until stopRead is called */
+	int startRead(Array<QueuedEvent>& events, int max)
+	{
+		int pos1, size1, pos2, size2;
+		int numAvailable = m_fifo.getNumReady();
+		int numToRead = ((max < numAvailable) && (max > 0)) ? max : numAvailable;
+		m_fifo.prepareToRead(numToRead, pos1, size1, pos2, size2);
+		events.clearQuick();
+		for (int i = 0; i < size1; ++i)
+			events.add(m_slots[pos1 + i]->event);
+		for (int i = 0; i < size2; ++i)
+			events.add(m_slots[pos2 + i]->event);
+		m_numRead = numToRead;
+		return numToRead;
+	}
+
+	void stopRead()
+	{
+		m_fifo.finishedRead(m_numRead);
+		m_numRead = 0;
+	}
+
+	/** Number of events dropped since the last reset because the queue was full */
+	int64 getDroppedEvents() const
+	{
+		return m_droppedEvents;
+	}
+
+	/** Maximum number of events waiting to be written since the last reset */
+	int getMaxQueuedEvents() const
+	{
+		return m_maxQueuedEvents;
+	}
+
+	int getCapacity() const
+	{
+		return m_fifo.getTotalSize();
+	}
+
+	void resetStatistics()
+	{
+		m_droppedEvents = 0;
+		m_maxQueuedEvents = 0;
+	}
+
+private:
+	struct Slot
+	{
+		QueuedEvent event;
+		HeapBlock<uint8> overflow;
+		size_t overflowSize{ 0 };
+	};
+
+	AbstractFifo m_fifo;
+	const int m_slotSize;
+	HeapBlock<uint8> m_slab;
+	OwnedArray<Slot> m_slots;
+	int m_numRead;
+	std::atomic<int64> m_droppedEvents;
+	std::atomic<int> m_maxQueuedEvents;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SerializedEventQueue);
+};
+
 //NOTE: Events are sent as midimessages while spikes as spike objects due to the difference on how they are passed to the record node.
 //Once the probe system is implemented, this will be normalized
-typedef EventQueue<MidiMessage> EventMsgQueue;
+typedef SerializedEventQueue EventMsgQueue;
 typedef EventQueue<SpikeEvent> SpikeMsgQueue;
-typedef ReferenceCountedObjectPtr<AsyncEventMessage<MidiMessage>> EventMessagePtr;
 typedef ReferenceCountedObjectPtr<AsyncEventMessage<SpikeEvent>> SpikeMessagePtr;
 
 #endif  // EVENTQUEUE_H_INCLUDED
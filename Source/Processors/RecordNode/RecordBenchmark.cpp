@@ -0,0 +1,441 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "RecordBenchmark.h"
+#include "RecordEngine.h"
+#include "../ProcessorGraph/ProcessorGraph.h"
+#include "../../AccessClass.h"
+
+//Node ID of the synthetic source. Far above the IDs given to real processors, so they never clash
+#define BENCHMARK_NODE_ID 32000
+//Number of different data blocks cycled through, so the data doesn't repeat on every block
+#define BENCHMARK_DATA_BLOCKS 16
+
+/** Minimal processor that owns the synthetic channels, so they carry the same information as real ones */
+class RecordBenchmark::SyntheticSource : public GenericProcessor
+{
+public:
+	SyntheticSource(const RecordBenchmarkSettings& config) :
+		GenericProcessor("Benchmark Source"),
+		m_sampleRate(config.sampleRate)
+	{
+		setNodeId(BENCHMARK_NODE_ID);
+		settings.numInputs = 0;
+		settings.numOutputs = config.numChannels;
+		settings.originalSource = nullptr;
+
+		for (int ch = 0; ch < config.numChannels; ch++)
+		{
+			DataChannel* chan = new DataChannel(DataChannel::HEADSTAGE_CHANNEL, m_sampleRate, this);
+			chan->setBitVolts(0.195f);
+			chan->setRecordState(true);
+			dataChannelArray.add(chan);
+		}
+
+		eventChannelArray.add(new EventChannel(EventChannel::TTL, 8, 1, m_sampleRate, this));
+
+		for (int e = 0; e < config.numElectrodes && config.numChannels > 0; e++)
+		{
+			Array<const DataChannel*> sourceChannels;
+			sourceChannels.add(dataChannelArray[e % config.numChannels]);
+			SpikeChannel* chan = new SpikeChannel(SpikeChannel::SINGLE, this, sourceChannels);
+			chan->setNumSamples(8, 32);
+			spikeChannelArray.add(chan);
+		}
+	}
+
+	void process(AudioSampleBuffer&) override {}
+	bool isGeneratesTimestamps() const override { return true; }
+	float getSampleRate(int) const override { return m_sampleRate; }
+	float getDefaultSampleRate() const override { return m_sampleRate; }
+
+private:
+	const float m_sampleRate;
+};
+
+RecordBenchmarkSettings RecordBenchmarkSettings::fromCommandLine(const StringArray& args)
+{
+	RecordBenchmarkSettings settings;
+	settings.directory = File::getSpecialLocation(File::tempDirectory);
+
+	for (int i = 0; i < args.size(); i++)
+	{
+		String key = args[i].upToFirstOccurrenceOf("=", false, false).trim().toLowerCase();
+		String value = args[i].fromFirstOccurrenceOf("=", false, false).trim();
+
+		if (key == "engine")
+			settings.engineID = value.toUpperCase();
+		else if (key == "channels")
+			settings.numChannels = jmax(1, value.getIntValue());
+		else if (key == "rate")
+			settings.sampleRate = jmax(1.0f, value.getFloatValue());
+		else if (key == "block")
+			settings.blockSize = jlimit(1, WRITE_BLOCK_LENGTH, value.getIntValue());
+		else if (key == "seconds")
+			settings.duration = jmax(0.0f, value.getFloatValue());
+		else if (key == "speed")
+			settings.speed = jmax(0.0f, value.getFloatValue());
+		else if (key == "ttl")
+			settings.ttlRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "electrodes")
+			settings.numElectrodes = jmax(0, value.getIntValue());
+		else if (key == "spikes")
+			settings.spikeRate = jmax(0.0f, value.getFloatValue());
+		else if (key == "dir")
+			settings.directory = File::getCurrentWorkingDirectory().getChildFile(value);
+		else if (key.startsWithChar('p') && key.substring(1).containsOnly("0123456789") && key.length() > 1)
+			settings.engineParameters.set(key.substring(1), value);
+		else
+			std::cerr << "Unknown benchmark option " << args[i] << std::endl;
+	}
+	return settings;
+}
+
+String RecordBenchmarkResults::toString() const
+{
+	String text;
+	text << "Elapsed time: " << String(elapsedSeconds, 2) << " s" << newLine;
+	text << "Input rate: " << String(inputMBps, 2) << " MB/s" << newLine;
+	text << "Written: " << String(bytesWritten / 1048576.0, 1) << " MB (" << String(writtenMBps, 2) << " MB/s)" << newLine;
+	text << "Engine write time (wall clock): " << String(engineWriteTimeFraction * 100, 1) << " % of elapsed time" << newLine;
+	text << "Engine write CPU time: " << String(engineCpuTimeFraction * 100, 1) << " % of elapsed time" << newLine;
+	text << "Max write time: " << String(maxWriteTimeMs, 2) << " ms" << newLine;
+	text << "Worst queue latency: " << String(worstQueueLatencyMs, 2) << " ms" << newLine;
+	text << "Max queue usage: data " << String(queues.maxDataQueueUsage * 100, 1)
+		<< " %, events " << String(queues.maxEventQueueUsage * 100, 1)
+		<< " %, spikes " << String(queues.maxSpikeQueueUsage * 100, 1) << " %" << newLine;
+	text << "TTL events: " << ttlEvents << ", spikes: " << spikes << newLine;
+	text << "Dropped: " << queues.droppedSamples << " samples, " << queues.droppedEvents
+		<< " events, " << queues.droppedSpikes << " spikes" << newLine;
+	for (int i = 0; i < queues.engines.size(); i++)
+	{
+		const RecordEngineStatistics& eng = queues.engines.getReference(i);
+		text << "Engine " << eng.engineID << ": " << eng.numWrites << " writes, mean "
+			<< String(eng.getMeanWriteTime(), 3) << " ms, max " << String(eng.maxWriteTime, 3) << " ms, CPU "
+			<< String(eng.totalCpuTime / 1000.0, 2) << " s" << newLine;
+	}
+	return text;
+}
+
+RecordBenchmark::RecordBenchmark(const RecordBenchmarkSettings& settings) :
+	m_settings(settings),
+	m_recordNode(nullptr)
+{
+}
+
+RecordBenchmark::~RecordBenchmark()
+{
+	tearDown();
+}
+
+String RecordBenchmark::getLastError() const
+{
+	return m_lastError;
+}
+
+bool RecordBenchmark::run(RecordBenchmarkResults& results)
+{
+	if (!setUp())
+	{
+		tearDown();
+		return false;
+	}
+
+	generateData();
+	feed(results);
+	tearDown();
+	return true;
+}
+
+bool RecordBenchmark::setUp()
+{
+	m_recordNode = AccessClass::getProcessorGraph()->getRecordNode();
+	if (m_recordNode->isRecording || CoreServices::getAcquisitionStatus())
+	{
+		m_lastError = "The recording benchmark can't run while acquiring";
+		m_recordNode = nullptr;
+		return false;
+	}
+
+	for (int i = 0; i < RecordEngineManager::getNumOfBuiltInEngines() && !m_engineManager; i++)
+	{
+		ScopedPointer<RecordEngineManager> manager = RecordEngineManager::createBuiltInEngineManager(i);
+		if (manager && manager->getID() == m_settings.engineID)
+			m_engineManager = manager.release();
+	}
+	if (!m_engineManager)
+	{
+		m_lastError = "Unknown record engine " + m_settings.engineID;
+		return false;
+	}
+
+	for (int i = 0; i < m_engineManager->getNumParameters(); i++)
+	{
+		EngineParameter& param = m_engineManager->getParameter(i);
+		String key(param.id);
+		if (!m_settings.engineParameters.containsKey(key))
+			continue;
+		String value = m_settings.engineParameters[key];
+		switch (param.type)
+		{
+		case EngineParameter::INT: param.intParam.value = value.getIntValue(); break;
+		case EngineParameter::FLOAT: param.floatParam.value = value.getFloatValue(); break;
+		case EngineParameter::BOOL: param.boolParam.value = (value == "1" || value.equalsIgnoreCase("true")); break;
+		case EngineParameter::MULTI: param.multiParam.value = value.getIntValue(); break;
+		case EngineParameter::STR: param.strParam.value = value; break;
+		}
+	}
+
+	RecordEngine* engine = m_engineManager->instantiateEngine();
+	if (!engine)
+	{
+		m_lastError = "Unable to create record engine " + m_settings.engineID;
+		return false;
+	}
+	engine->registerManager(m_engineManager);
+	m_engines.add(engine);
+
+	m_rootFolder = m_settings.directory.getChildFile("record_benchmark_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S"));
+	if (!m_rootFolder.createDirectory())
+	{
+		m_lastError = "Unable to create " + m_rootFolder.getFullPathName();
+		return false;
+	}
+
+	//Register the channels the same way the processor graph and the RecordNode do when acquisition starts
+	int nChans = m_settings.numChannels;
+	m_source = new SyntheticSource(m_settings);
+	m_recordNode->resetConnections();
+	m_recordNode->registerProcessor(m_source);
+	for (int ch = 0; ch < nChans; ch++)
+		m_recordNode->addInputChannel(m_source, ch);
+	m_recordNode->addInputChannel(m_source, AudioProcessorGraph::midiChannelIndex);
+	m_recordNode->registerSpikeSource(m_source);
+	for (int e = 0; e < m_source->getTotalSpikeChannels(); e++)
+		m_recordNode->addSpikeElectrode(m_source->getSpikeChannel(e));
+	m_recordNode->updateRecordChannelIndexes();
+
+	engine->resetChannels();
+	engine->registerProcessor(m_source);
+	for (int ch = 0; ch < nChans; ch++)
+		engine->addDataChannel(ch, m_recordNode->getDataChannel(ch));
+	engine->registerSpikeSource(m_source);
+	for (int e = 0; e < m_source->getTotalSpikeChannels(); e++)
+		engine->addSpikeElectrode(e, m_source->getSpikeChannel(e));
+	engine->configureEngine();
+	engine->startAcquisition();
+	engine->directoryChanged();
+
+	Array<int> channelMap;
+	Array<int> chanProcessorMap;
+	Array<int> chanOrderInProc;
+	OwnedArray<RecordProcessorInfo> procInfo;
+	RecordProcessorInfo* info = new RecordProcessorInfo();
+	info->processorId = m_source->getNodeId();
+	for (int ch = 0; ch < nChans; ch++)
+	{
+		channelMap.add(ch);
+		chanProcessorMap.add(0);
+		chanOrderInProc.add(ch);
+		info->recordedChannels.add(ch);
+	}
+	procInfo.add(info);
+	engine->setChannelMapping(channelMap, chanProcessorMap, chanOrderInProc, procInfo);
+
+	m_dataQueue = new DataQueue(WRITE_BLOCK_LENGTH, DATA_BUFFER_NBLOCKS);
+	m_dataQueue->setChannels(nChans);
+	m_eventQueue = new EventMsgQueue(EVENT_BUFFER_NEVENTS);
+	m_spikeQueue = new SpikeMsgQueue(SPIKE_BUFFER_NSPIKES);
+
+	m_recordThread = new RecordThread(m_engines);
+	m_recordThread->setQueuePointers(m_dataQueue, m_eventQueue, m_spikeQueue);
+	m_recordThread->setChannelMap(channelMap);
+	m_recordThread->setFileComponents(m_rootFolder, 1, 0);
+	m_recordThread->setFirstBlockFlag(false);
+	return true;
+}
+
+void RecordBenchmark::tearDown()
+{
+	if (m_recordThread)
+	{
+		m_recordThread->signalThreadShouldExit();
+		m_recordThread->waitForThreadToExit(-1);
+	}
+	m_recordThread = nullptr;
+	m_engines.clear();
+	m_engineManager = nullptr;
+	if (m_recordNode)
+		m_recordNode->resetConnections();
+	m_recordNode = nullptr;
+	m_source = nullptr;
+}
+
+void RecordBenchmark::generateData()
+{
+	//Noise plus a slow oscillation, in microvolts, similar in range to headstage data
+	int nSamples = m_settings.blockSize * BENCHMARK_DATA_BLOCKS;
+	m_data.setSize(m_settings.numChannels, nSamples);
+	for (int ch = 0; ch < m_settings.numChannels; ch++)
+	{
+		float* data = m_data.getWritePointer(ch);
+		float phase = m_random.nextFloat() * float_Pi * 2;
+		float freq = 2 * float_Pi * (5.0f + ch % 10) / m_settings.sampleRate;
+		for (int i = 0; i < nSamples; i++)
+			data[i] = 100.0f * std::sin(phase + freq * i) + 40.0f * (m_random.nextFloat() - 0.5f);
+	}
+}
+
+void RecordBenchmark::feed(RecordBenchmarkResults& results)
+{
+	const int blockSize = m_settings.blockSize;
+	const int nChans = m_settings.numChannels;
+	const int64 nBlocks = int64(m_settings.duration * m_settings.sampleRate / blockSize);
+	const double blockMs = 1000.0 * blockSize / m_settings.sampleRate;
+
+	OwnedArray<AudioSampleBuffer> blocks;
+	for (int b = 0; b < BENCHMARK_DATA_BLOCKS; b++)
+		blocks.add(new AudioSampleBuffer(m_data.getArrayOfWritePointers(), nChans, b * blockSize, blockSize));
+
+	const double ttlInterval = m_settings.ttlRate > 0 ? m_settings.sampleRate / m_settings.ttlRate : 0;
+	const double spikesPerBlock = m_settings.spikeRate * blockSize / m_settings.sampleRate;
+	const int nElectrodes = m_source->getTotalSpikeChannels();
+	Array<double> spikeAccumulators;
+	spikeAccumulators.insertMultiple(0, 0, nElectrodes);
+	double nextTTL = ttlInterval;
+	int ttlChannel = 0;
+	bool ttlState = true;
+
+	results = RecordBenchmarkResults();
+	m_recordThread->startThread();
+	double startTime = Time::getMillisecondCounterHiRes();
+
+	int64 timestamp = 0;
+	for (int64 b = 0; b < nBlocks; b++)
+	{
+		if (m_settings.speed > 0)
+		{
+			double wait = startTime + b * blockMs / m_settings.speed - Time::getMillisecondCounterHiRes();
+			if (wait >= 1)
+				Thread::sleep(int(wait));
+		}
+
+		const AudioSampleBuffer& block = *blocks[int(b % BENCHMARK_DATA_BLOCKS)];
+		for (int ch = 0; ch < nChans; ch++)
+			m_dataQueue->writeChannel(block, ch, ch, blockSize, timestamp);
+
+		while (ttlInterval > 0 && nextTTL < timestamp + blockSize)
+		{
+			addTTLEvent(int64(nextTTL), ttlChannel, ttlState);
+			results.ttlEvents++;
+			if (!ttlState)
+				ttlChannel = (ttlChannel + 1) % 8;
+			ttlState = !ttlState;
+			nextTTL += ttlInterval;
+		}
+
+		for (int e = 0; e < nElectrodes; e++)
+		{
+			double acc = spikeAccumulators[e] + spikesPerBlock * 2 * m_random.nextDouble();
+			while (acc >= 1)
+			{
+				addSpike(e, timestamp + m_random.nextInt(blockSize));
+				results.spikes++;
+				acc -= 1;
+			}
+			spikeAccumulators.set(e, acc);
+		}
+
+		if (b == 0)
+			m_recordThread->setFirstBlockFlag(true);
+		timestamp += blockSize;
+	}
+
+	//Stopping includes writing whatever is left in the queues and closing the files
+	m_recordThread->signalThreadShouldExit();
+	m_recordThread->waitForThreadToExit(-1);
+	results.elapsedSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+	RecordingStatistics& stats = results.queues;
+	stats.droppedSamples = m_dataQueue->getDroppedSamples();
+	stats.droppedEvents = m_eventQueue->getDroppedEvents();
+	stats.droppedSpikes = m_spikeQueue->getDroppedEvents();
+	stats.maxDataQueueUsage = float(m_dataQueue->getMaxQueuedSamples()) / float(m_dataQueue->getCapacity());
+	stats.maxEventQueueUsage = float(m_eventQueue->getMaxQueuedEvents()) / float(m_eventQueue->getCapacity());
+	stats.maxSpikeQueueUsage = float(m_spikeQueue->getMaxQueuedEvents()) / float(m_spikeQueue->getCapacity());
+	stats.engines = m_recordThread->getEngineStatistics();
+
+	Array<File> files;
+	m_rootFolder.findChildFiles(files, File::findFiles, true);
+	for (int i = 0; i < files.size(); i++)
+		results.bytesWritten += files[i].getSize();
+
+	double seconds = jmax(results.elapsedSeconds, 1e-6);
+	results.inputMBps = double(timestamp) * nChans * sizeof(int16) / seconds / 1e6;
+	results.writtenMBps = results.bytesWritten / seconds / 1e6;
+	results.worstQueueLatencyMs = 1000.0 * m_dataQueue->getMaxQueuedSamples() / m_settings.sampleRate;
+	double writeMs = 0;
+	double cpuMs = 0;
+	for (int i = 0; i < stats.engines.size(); i++)
+	{
+		writeMs += stats.engines[i].totalWriteTime;
+		cpuMs += stats.engines[i].totalCpuTime;
+		results.maxWriteTimeMs = jmax(results.maxWriteTimeMs, stats.engines[i].maxWriteTime);
+	}
+	results.engineWriteTimeFraction = writeMs / (seconds * 1000.0);
+	results.engineCpuTimeFraction = cpuMs / (seconds * 1000.0);
+}
+
+void RecordBenchmark::addTTLEvent(int64 timestamp, int channel, bool state)
+{
+	const EventChannel* chan = m_source->getEventChannel(0);
+	uint8 word = state ? uint8(1 << channel) : 0;
+	TTLEventPtr event = TTLEvent::createTTLEvent(chan, timestamp, &word, sizeof(uint8), uint16(channel));
+	if (!event)
+		return;
+
+	size_t size = chan->getDataSize() + chan->getTotalEventMetaDataSize() + EVENT_BASE_SIZE;
+	HeapBlock<char> buffer(size);
+	event->serialize(buffer, size);
+	m_eventQueue->addEvent(MidiMessage(buffer, int(size)), timestamp, 0);
+}
+
+void RecordBenchmark::addSpike(int electrode, int64 timestamp)
+{
+	const SpikeChannel* chan = m_source->getSpikeChannel(electrode);
+	int nSamples = chan->getTotalSamples();
+	int peak = chan->getPrePeakSamples();
+	SpikeEvent::SpikeBuffer buffer(chan);
+	for (int i = 0; i < nSamples; i++)
+	{
+		//Negative peak followed by a slower positive rebound
+		float t = float(i - peak);
+		float value = t < 0 ? -20.0f * std::exp(t / 2.0f) : -80.0f * std::exp(-t / 3.0f) + 25.0f * (1 - std::exp(-t / 6.0f)) * std::exp(-t / 20.0f);
+		buffer.set(0, i, value + 5.0f * (m_random.nextFloat() - 0.5f));
+	}
+	Array<float> thresholds;
+	thresholds.add(-50.0f);
+	SpikeEventPtr spike = SpikeEvent::createSpikeEvent(chan, timestamp, thresholds, buffer, 0);
+	if (spike)
+		m_spikeQueue->addEvent(*spike, timestamp, electrode);
+}
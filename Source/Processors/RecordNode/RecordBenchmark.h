@@ -0,0 +1,131 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2014 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RECORDBENCHMARK_H_INCLUDED
+#define RECORDBENCHMARK_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "RecordNode.h"
+
+class RecordEngineManager;
+
+/** Settings for a recording benchmark run. Can be filled from key=value command line arguments:
+	engine=RAWBINARY channels=128 rate=30000 block=1024 seconds=10 speed=1 ttl=10
+	electrodes=16 spikes=50 dir=/path p<paramId>=<value>
+	speed is the rate at which data is fed relative to real time, 0 meaning as fast as the record thread takes it.
+	ttl is the total number of TTL events per second and spikes the number of spikes per second on each electrode.
+	p<paramId> overrides an engine parameter, e.g. p1=true for the Binary threaded writes */
+struct RecordBenchmarkSettings
+{
+	String engineID{ "RAWBINARY" };
+	int numChannels{ 128 };
+	float sampleRate{ 30000.0f };
+	int blockSize{ 1024 };
+	float duration{ 10.0f };
+	float speed{ 1.0f };
+	float ttlRate{ 10.0f };
+	int numElectrodes{ 16 };
+	float spikeRate{ 50.0f };
+	File directory;
+	StringPairArray engineParameters;
+
+	static RecordBenchmarkSettings fromCommandLine(const StringArray& args);
+};
+
+struct RecordBenchmarkResults
+{
+	double elapsedSeconds{ 0 };
+	int64 bytesWritten{ 0 };
+	double inputMBps{ 0 };
+	double writtenMBps{ 0 };
+	/** Wall clock time spent in engine writes, summed over the engines, as a fraction of the elapsed
+	time. This is not CPU time: it includes time blocked on the disk, and exceeds 1 when engines
+	write in parallel */
+	double engineWriteTimeFraction{ 0 };
+	/** CPU time of the threads calling the engines while writing, as a fraction of the elapsed time.
+	Work engines hand to threads of their own, such as the Binary threaded writes, isn't included */
+	double engineCpuTimeFraction{ 0 };
+	/** Longest time data waited in the queue, derived from its highest occupancy */
+	double worstQueueLatencyMs{ 0 };
+	double maxWriteTimeMs{ 0 };
+	int64 ttlEvents{ 0 };
+	int64 spikes{ 0 };
+	RecordingStatistics queues;
+
+	String toString() const;
+};
+
+/**
+Measures how much data a record engine can sustain.
+
+Feeds synthetic continuous data, TTL events and spikes to the same DataQueue, event and spike queues
+and RecordThread used by the RecordNode, paced at the configured rate, and reports the write throughput,
+the wall clock and CPU time spent writing, the queue occupancy and the worst-case queuing latency.
+
+Engines read the channel information from the RecordNode of the processor graph, so the benchmark
+registers its synthetic channels there. The application runs it with a headless MainWindow, which
+creates the graph without showing a window. It must run while acquisition is stopped, and leaves the
+RecordNode without connections, as if acquisition had never been started.
+
+@see RecordThread, RecordEngine
+*/
+class RecordBenchmark
+{
+public:
+	RecordBenchmark(const RecordBenchmarkSettings& settings);
+	~RecordBenchmark();
+
+	/** Runs the benchmark on the calling thread. Returns false if it could not be set up */
+	bool run(RecordBenchmarkResults& results);
+
+	String getLastError() const;
+
+private:
+	class SyntheticSource;
+
+	bool setUp();
+	void tearDown();
+	void generateData();
+	void feed(RecordBenchmarkResults& results);
+	void addTTLEvent(int64 timestamp, int channel, bool state);
+	void addSpike(int electrode, int64 timestamp);
+
+	const RecordBenchmarkSettings m_settings;
+	ScopedPointer<SyntheticSource> m_source;
+	ScopedPointer<RecordEngineManager> m_engineManager;
+	OwnedArray<RecordEngine> m_engines;
+	ScopedPointer<DataQueue> m_dataQueue;
+	ScopedPointer<EventMsgQueue> m_eventQueue;
+	ScopedPointer<SpikeMsgQueue> m_spikeQueue;
+	ScopedPointer<RecordThread> m_recordThread;
+	RecordNode* m_recordNode;
+	File m_rootFolder;
+
+	AudioSampleBuffer m_data;
+	Random m_random;
+	String m_lastError;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordBenchmark);
+};
+
+#endif  // RECORDBENCHMARK_H_INCLUDED
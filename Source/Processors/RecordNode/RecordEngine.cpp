@@ -29,6 +29,7 @@
 #include "EngineConfigWindow.h"
 #include "OpenEphysFormat/OriginalRecording.h"
 #include "BinaryFormat/BinaryRecording.h"
+#include "CompressedFormat/CompressedRecording.h"
 
 RecordEngine::RecordEngine()
     : manager (nullptr)
@@ -53,6 +54,39 @@ void RecordEngine::startChannelBlock (bool lastBlock) {}
 
 void RecordEngine::endChannelBlock (bool lastBlock) {}
 
+void RecordEngine::writeContinuousBlock (const AudioSampleBuffer& buffer, const Array<CircularBufferIndexes>& indexes)
+{
+    int nChans = indexes.size();
+    for (int chan = 0; chan < nChans; ++chan)
+    {
+        const CircularBufferIndexes& idx = indexes.getReference (chan);
+        if (idx.size1 > 0)
+        {
+            writeData (chan, getRealChannel (chan), buffer.getReadPointer (chan, idx.index1), idx.size1);
+            if (idx.size2 > 0)
+            {
+                timestamps.set (chan, timestamps[chan] + idx.size1);
+                writeData (chan, getRealChannel (chan), buffer.getReadPointer (chan, idx.index2), idx.size2);
+            }
+        }
+    }
+}
+
+void RecordEngine::writeEvents (const QueuedEvent* events, int nEvents)
+{
+    for (int ev = 0; ev < nEvents; ++ev)
+    {
+        MidiMessage event (events[ev].data, (int) events[ev].size);
+        writeEvent (events[ev].extra, event);
+    }
+}
+
+void RecordEngine::writeSpikes (const int* electrodeIndexes, const SpikeEvent* const* spikes, int nSpikes)
+{
+    for (int sp = 0; sp < nSpikes; ++sp)
+        writeSpike (electrodeIndexes[sp], spikes[sp]);
+}
+
 const DataChannel* RecordEngine::getDataChannel (int index) const
 {
     return AccessClass::getProcessorGraph()->getRecordNode()->getDataChannel (index);
@@ -246,7 +280,7 @@ void RecordEngineManager::addParameter (EngineParameter* param)
 
 int RecordEngineManager::getNumOfBuiltInEngines()
 {
-    return 2;
+    return 3;
 }
 
 RecordEngineManager* RecordEngineManager::createBuiltInEngineManager (int index)
@@ -257,6 +291,8 @@ RecordEngineManager* RecordEngineManager::createBuiltInEngineManager (int index)
 			return BinaryRecordingEngine::BinaryRecording::getEngineManager();
         case 1:
             return OriginalRecording::getEngineManager();
+        case 2:
+            return CompressedRecordingEngine::CompressedRecording::getEngineManager();
 
         default:
             return nullptr;
@@ -274,6 +310,8 @@ RecordEngine* RecordEngineManager::instantiateEngine()
 		return new OriginalRecording();
 	else if (id == "RAWBINARY")
 		return new BinaryRecordingEngine::BinaryRecording();
+	else if (id == "COMPRESSED")
+		return new CompressedRecordingEngine::CompressedRecording();
 
     return nullptr;
 }
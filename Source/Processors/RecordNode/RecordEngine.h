@@ -26,6 +26,8 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../GenericProcessor/GenericProcessor.h"
+#include "DataQueue.h"
+#include "EventQueue.h"
 
 #include <map>
 
@@ -73,10 +75,10 @@ public:
       During recording: (RecordThread loop)
         1-(updateTimestamps*) (can be called in a per-channel basis when the circular buffer wraps)
         2-startChannelBlock*
-        3-writeData* (per channel. Can be called more than once to account for the circular buffer wrap)
+        3-writeContinuousBlock* (by default calls writeData* per channel. Can be called more than once to account for the circular buffer wrap)
         4-endChannelBlock*
-        4-writeEvent* (if needed)
-        5-writeSpike* (if needed)
+        5-writeEvents* (if needed, by default calls writeEvent* for each event)
+        6-writeSpikes* (if needed, by default calls writeSpike* for each spike)
       When recording stops:
         closeFiles*
 
@@ -101,12 +103,26 @@ public:
         care must be taken to only read the specified number of bytes.  */
     virtual void writeData (int writeChannel, int realChannel, const float* buffer, int size) = 0;
 
+    /** Write the continuous data of all recorded channels for the current block in a single call.
+        The buffer is the internal circular buffer of the DataQueue and the indexes are the ones returned
+        by DataQueue::startRead, so both regions of each channel must be written. Engines that can
+        write several channels at once should override this. The default implementation calls
+        writeData for each channel, updating the timestamp when the circular buffer wraps.  */
+    virtual void writeContinuousBlock (const AudioSampleBuffer& buffer, const Array<CircularBufferIndexes>& indexes);
+
     /** Called by the record thread after it has written a channel block */
     virtual void endChannelBlock (bool lastBlock);
 
     /** Write a single event to disk.  */
     virtual void writeEvent (int eventChannel, const MidiMessage& event) = 0;
 
+    /** Write all the events read from the queue in one pass of the record thread.
+        Each event holds its serialized data, which is only valid during the call, and its
+        event channel in QueuedEvent::extra. Engines that can write straight from the serialized
+        data (see EventView) should override this. The default implementation builds a MidiMessage
+        for each event and calls writeEvent. */
+    virtual void writeEvents (const QueuedEvent* events, int nEvents);
+
 	/** Handle the timestamp sync text messages*/
 	virtual void writeTimestampSyncText(uint16 sourceID, uint16 sourceIdx, int64 timestamp, float sourceSampleRate, String text) = 0;
 
@@ -128,6 +144,10 @@ public:
     /** Write a spike to disk */
     virtual void writeSpike (int electrodeIndex, const SpikeEvent* spike) = 0;
 
+    /** Write all the spikes read from the queue in one pass of the record thread.
+        The default implementation calls writeSpike for each spike. */
+    virtual void writeSpikes (const int* electrodeIndexes, const SpikeEvent* const* spikes, int nSpikes);
+
     /** Called when a new acquisition starts, to clean all channel data before registering the processors */
     virtual void resetChannels();
 
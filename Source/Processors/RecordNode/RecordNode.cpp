@@ -370,6 +370,7 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 				}
 			}
 
+			writeRecordingStatistics();
 		}
 	}
 	else if (parameterIndex == 2)
@@ -462,6 +463,49 @@ float RecordNode::getFreeSpace() const
     return 1.0f - float(dataDirectory.getBytesFreeOnVolume())/float(dataDirectory.getVolumeTotalSize());
 }
 
+RecordingStatistics RecordNode::getRecordingStatistics() const
+{
+	RecordingStatistics stats;
+	stats.droppedSamples = m_dataQueue->getDroppedSamples();
+	stats.droppedEvents = m_eventQueue->getDroppedEvents();
+	stats.droppedSpikes = m_spikeQueue->getDroppedEvents();
+	stats.maxDataQueueUsage = float(m_dataQueue->getMaxQueuedSamples()) / float(m_dataQueue->getCapacity());
+	stats.maxEventQueueUsage = float(m_eventQueue->getMaxQueuedEvents()) / float(m_eventQueue->getCapacity());
+	stats.maxSpikeQueueUsage = float(m_spikeQueue->getMaxQueuedEvents()) / float(m_spikeQueue->getCapacity());
+	stats.engines = m_recordThread->getEngineStatistics();
+	return stats;
+}
+
+void RecordNode::writeRecordingStatistics()
+{
+	RecordingStatistics stats = getRecordingStatistics();
+
+	File statsFile = rootFolder.getChildFile("recording_statistics.txt");
+	FileOutputStream out(statsFile);
+	if (out.failedToOpen())
+	{
+		std::cerr << "Error writing recording statistics to " << statsFile.getFullPathName() << std::endl;
+		return;
+	}
+
+	out << "Experiment " << experimentNumber << ", recording " << (recordingNumber + 1) << newLine;
+	out << "Continuous data: " << stats.droppedSamples << " samples dropped, maximum queue usage "
+		<< String(stats.maxDataQueueUsage * 100, 1) << "%" << newLine;
+	out << "Events: " << stats.droppedEvents << " dropped, maximum queue usage "
+		<< String(stats.maxEventQueueUsage * 100, 1) << "%" << newLine;
+	out << "Spikes: " << stats.droppedSpikes << " dropped, maximum queue usage "
+		<< String(stats.maxSpikeQueueUsage * 100, 1) << "%" << newLine;
+	for (int i = 0; i < stats.engines.size(); i++)
+	{
+		const RecordEngineStatistics& eng = stats.engines.getReference(i);
+		out << "Engine " << eng.engineID << ": " << eng.numWrites << " writes, mean write time "
+			<< String(eng.getMeanWriteTime(), 3) << " ms, maximum " << String(eng.maxWriteTime, 3) << " ms" << newLine;
+	}
+	out << newLine;
+
+	if (stats.hasDroppedData())
+		CoreServices::sendStatusMessage("Recording buffers overflowed. Some data was not saved. See recording_statistics.txt");
+}
 
 void RecordNode::handleEvent(const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
 {
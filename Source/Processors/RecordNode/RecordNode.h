@@ -31,6 +31,7 @@
 
 #include "../GenericProcessor/GenericProcessor.h"
 #include "EventQueue.h"
+#include "RecordThread.h"
 
 #define WRITE_BLOCK_LENGTH 1024
 #define DATA_BUFFER_NBLOCKS 300
@@ -41,6 +42,23 @@ class RecordEngine;
 class RecordThread;
 class DataQueue;
 
+/** Snapshot of the state of the recording queues and engines.
+	Queue usage is expressed as the fraction (0-1) of the queue capacity that was
+	filled at its highest point during the recording.
+*/
+struct RecordingStatistics
+{
+	int64 droppedSamples{ 0 };
+	int64 droppedEvents{ 0 };
+	int64 droppedSpikes{ 0 };
+	float maxDataQueueUsage{ 0 };
+	float maxEventQueueUsage{ 0 };
+	float maxSpikeQueueUsage{ 0 };
+	Array<RecordEngineStatistics> engines;
+
+	bool hasDroppedData() const { return droppedSamples > 0 || droppedEvents > 0 || droppedSpikes > 0; }
+};
+
 /**
 
   Receives inputs from all processors that want to save their data.
@@ -99,6 +117,11 @@ public:
     */
     float getFreeSpace() const;
 
+    /** Called by the ControlPanel to report on queue overruns and write times
+        of the current (or last) recording.
+    */
+    RecordingStatistics getRecordingStatistics() const;
+
     /** Selects a channel relative to a particular processor with ID = id
     */
     void setChannel(const DataChannel* ch);
@@ -201,6 +224,9 @@ private:
 
 	virtual void handleTimestampSyncTexts(const MidiMessage& event);
 
+	/** Appends the statistics of the recording that just finished to a log file in the recording directory */
+	void writeRecordingStatistics();
+
     /**RecordEngines loaded**/
     OwnedArray<RecordEngine> engineArray;
 
@@ -27,9 +27,37 @@
 #include "../ProcessorGraph/ProcessorGraph.h"
 #include "RecordNode.h"
 
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 #define EVERY_ENGINE for(int eng = 0; eng < m_engineArray.size(); eng++) m_engineArray[eng]
 
 
+namespace
+{
+	/** CPU time used so far by the calling thread, in ms. Unlike the wall clock, it doesn't include the time blocked on the disk */
+	double getThreadCpuTime()
+	{
+#if JUCE_WINDOWS
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+			return 0;
+		//100 ns units
+		uint64 kernelTime = (uint64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+		uint64 userTime = (uint64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+		return (kernelTime + userTime) / 10000.0;
+#else
+		timespec time;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+			return 0;
+		return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+#endif
+	}
+}
+
 RecordThread::RecordThread(const OwnedArray<RecordEngine>& engines) :
 Thread("Record Thread"),
 m_engineArray(engines),
@@ -83,6 +111,17 @@ void RecordThread::run()
 		wait(1);
 	}
 
+	{
+		ScopedLock lock(m_statisticsLock);
+		m_engineStatistics.clearQuick();
+		for (int eng = 0; eng < m_engineArray.size(); eng++)
+		{
+			RecordEngineStatistics stats;
+			stats.engineID = m_engineArray[eng]->getEngineID();
+			m_engineStatistics.add(stats);
+		}
+	}
+
 	//2-Open Files 
 	if (!threadShouldExit())
 	{
@@ -93,6 +132,7 @@ void RecordThread::run()
 
 		EVERY_ENGINE->updateTimestamps(timestamps);
 		EVERY_ENGINE->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
+		startEngineWriters();
 	}
 	//3-Normal loop
 	while (!threadShouldExit())
@@ -104,6 +144,7 @@ void RecordThread::run()
 	if (!closeEarly)
 	{
 		writeData(dataBuffer, -1, -1, -1, true);
+		stopEngineWriters();
 
 		std::cout << "Closing files" << std::endl;
 		//5-Close files
@@ -115,58 +156,176 @@ void RecordThread::run()
 
 void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock)
 {
-	Array<int64> timestamps;
-	Array<CircularBufferIndexes> idx;
-	m_dataQueue->startRead(idx, timestamps, maxSamples);
-	EVERY_ENGINE->updateTimestamps(timestamps);
-	EVERY_ENGINE->startChannelBlock(lastBlock);
-	for (int chan = 0; chan < m_numChannels; ++chan)
+	WriteBlock& block = m_writeBlock;
+	block.buffer = &dataBuffer;
+	block.lastBlock = lastBlock;
+	m_dataQueue->startRead(block.indexes, block.timestamps, maxSamples);
+	block.nEvents = m_eventQueue->startRead(block.events, maxEvents);
+	block.nSpikes = m_spikeQueue->getEvents(block.spikes, maxSpikes);
+
+	block.processorEvents.clearQuick();
+	for (int ev = 0; ev < block.nEvents; ++ev)
+	{
+		if (!isSystemEvent(block.events.getReference(ev)))
+			block.processorEvents.add(block.events.getReference(ev));
+	}
+
+	block.spikeElectrodes.clearQuick();
+	block.spikeData.clearQuick();
+	for (int sp = 0; sp < block.nSpikes; ++sp)
+	{
+		block.spikeElectrodes.add(block.spikes[sp]->getExtra());
+		block.spikeData.add(&block.spikes[sp]->getData());
+	}
+
+	if (m_engineWriters.size() > 0)
 	{
-		if (idx[chan].size1 > 0)
+		for (int eng = 0; eng < m_engineWriters.size(); eng++)
+			m_engineWriters[eng]->startBlock(&block);
+		//The data queue can't be released until all engines are done with the block
+		for (int eng = 0; eng < m_engineWriters.size(); eng++)
+			m_engineWriters[eng]->waitForBlock();
+	}
+	else
+	{
+		for (int eng = 0; eng < m_engineArray.size(); eng++)
+			writeEngineBlock(eng, block);
+	}
+	m_dataQueue->stopRead();
+	m_eventQueue->stopRead();
+}
+
+bool RecordThread::isSystemEvent(const QueuedEvent& event)
+{
+	//TODO: remove the mask when the probe system is implemented
+	return event.size > 0 && (event.data[0] & 0x7F) == SYSTEM_EVENT;
+}
+
+void RecordThread::writeEngineBlock(int eng, const WriteBlock& block)
+{
+	RecordEngine* engine = m_engineArray[eng];
+	double startTime = Time::getMillisecondCounterHiRes();
+	double startCpuTime = getThreadCpuTime();
+
+	engine->updateTimestamps(block.timestamps);
+	engine->startChannelBlock(block.lastBlock);
+	engine->writeContinuousBlock(*block.buffer, block.indexes);
+	engine->endChannelBlock(block.lastBlock);
+
+	//Sync texts are rare, so they are written one by one
+	if (block.processorEvents.size() < block.nEvents)
+	{
+		for (int ev = 0; ev < block.nEvents; ++ev)
 		{
-			EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index1), idx[chan].size1);
-			if (idx[chan].size2 > 0)
+			const QueuedEvent& queued = block.events.getReference(ev);
+			if (isSystemEvent(queued))
 			{
-				timestamps.set(chan, timestamps[chan] + idx[chan].size1);
-				EVERY_ENGINE->updateTimestamps(timestamps, chan);
-				EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index2), idx[chan].size2);
+				MidiMessage event(queued.data, int(queued.size));
+				uint16 sourceID = SystemEvent::getSourceID(event);
+				uint16 subProcIdx = SystemEvent::getSubProcessorIdx(event);
+				int64 timestamp = SystemEvent::getTimestamp(event);
+				engine->writeTimestampSyncText(sourceID, subProcIdx, timestamp,
+					AccessClass::getProcessorGraph()->getRecordNode()->getSourceTimestamp(sourceID, subProcIdx),
+					SystemEvent::getSyncText(event));
 			}
 		}
 	}
-	m_dataQueue->stopRead();
-	EVERY_ENGINE->endChannelBlock(lastBlock);
 
-	std::vector<EventMessagePtr> events;
-	int nEvents = m_eventQueue->getEvents(events, maxEvents);
-	for (int ev = 0; ev < nEvents; ++ev)
+	if (block.processorEvents.size() > 0)
+		engine->writeEvents(block.processorEvents.begin(), block.processorEvents.size());
+
+	if (block.spikeData.size() > 0)
+		engine->writeSpikes(block.spikeElectrodes.begin(), block.spikeData.begin(), block.spikeData.size());
+
+	updateEngineStatistics(eng, Time::getMillisecondCounterHiRes() - startTime, getThreadCpuTime() - startCpuTime);
+}
+
+void RecordThread::startEngineWriters()
+{
+	m_engineWriters.clear();
+	//With a single engine there is nothing to overlap, so it is written directly from this thread
+	if (m_engineArray.size() < 2)
+		return;
+
+	for (int eng = 0; eng < m_engineArray.size(); eng++)
 	{
-		const MidiMessage& event = events[ev]->getData();
-		if (SystemEvent::getBaseType(event) == SYSTEM_EVENT)
-		{
-			uint16 sourceID = SystemEvent::getSourceID(event);
-			uint16 subProcIdx = SystemEvent::getSubProcessorIdx(event);
-			int64 timestamp = SystemEvent::getTimestamp(event);
-				EVERY_ENGINE->writeTimestampSyncText(sourceID, subProcIdx, timestamp,
-				AccessClass::getProcessorGraph()->getRecordNode()->getSourceTimestamp(sourceID, subProcIdx),
-				SystemEvent::getSyncText(event));
-		}
-		else
-			EVERY_ENGINE->writeEvent(events[ev]->getExtra(), events[ev]->getData());
+		EngineWriter* writer = new EngineWriter(*this, eng);
+		m_engineWriters.add(writer);
+		writer->startThread();
 	}
+}
+
+void RecordThread::stopEngineWriters()
+{
+	for (int eng = 0; eng < m_engineWriters.size(); eng++)
+		m_engineWriters[eng]->signalThreadShouldExit();
+	m_engineWriters.clear();
+}
+
+RecordThread::EngineWriter::EngineWriter(RecordThread& parent, int engineIndex) :
+Thread("Record Engine Writer"),
+m_parent(parent),
+m_engineIndex(engineIndex),
+m_block(nullptr)
+{
+}
+
+RecordThread::EngineWriter::~EngineWriter()
+{
+	stopThread(1000);
+}
+
+void RecordThread::EngineWriter::startBlock(const WriteBlock* block)
+{
+	m_block = block;
+	m_blockReady.signal();
+}
+
+void RecordThread::EngineWriter::waitForBlock()
+{
+	m_blockDone.wait();
+}
 
-	std::vector<SpikeMessagePtr> spikes;
-	int nSpikes = m_spikeQueue->getEvents(spikes, maxSpikes);
-	for (int sp = 0; sp < nSpikes; ++sp)
+void RecordThread::EngineWriter::run()
+{
+	while (!threadShouldExit())
 	{
-		EVERY_ENGINE->writeSpike(spikes[sp]->getExtra(), &spikes[sp]->getData());
+		if (!m_blockReady.wait(100))
+			continue;
+
+		m_parent.writeEngineBlock(m_engineIndex, *m_block);
+		m_block = nullptr;
+		m_blockDone.signal();
 	}
 }
 
+void RecordThread::updateEngineStatistics(int engine, double writeTime, double cpuTime)
+{
+	ScopedLock lock(m_statisticsLock);
+	if (engine >= m_engineStatistics.size())
+		return;
+
+	RecordEngineStatistics& stats = m_engineStatistics.getReference(engine);
+	stats.lastWriteTime = writeTime;
+	stats.maxWriteTime = jmax(stats.maxWriteTime, writeTime);
+	stats.totalWriteTime += writeTime;
+	stats.totalCpuTime += cpuTime;
+	stats.numWrites++;
+}
+
+Array<RecordEngineStatistics> RecordThread::getEngineStatistics() const
+{
+	ScopedLock lock(m_statisticsLock);
+	return m_engineStatistics;
+}
+
 void RecordThread::forceCloseFiles()
 {
 	if (isThreadRunning() || m_cleanExit)
 		return;
 
+	stopEngineWriters();
+
 	EVERY_ENGINE->closeFiles();
 	m_cleanExit = true;
 }
\ No newline at end of file
@@ -35,6 +35,18 @@
 
 class RecordEngine;
 
+/** Time spent by a record engine writing each block of data, events and spikes */
+struct RecordEngineStatistics
+{
+	String engineID;
+	double lastWriteTime{ 0 }; //ms
+	double maxWriteTime{ 0 }; //ms
+	double totalWriteTime{ 0 }; //ms
+	double totalCpuTime{ 0 }; //ms, of the thread calling the engine
+	int64 numWrites{ 0 };
+
+	double getMeanWriteTime() const { return numWrites > 0 ? totalWriteTime / numWrites : 0; }
+};
 
 class RecordThread : public Thread
 {
@@ -50,8 +62,51 @@ public:
 	void setFirstBlockFlag(bool state);
 	void forceCloseFiles();
 
+	/** Returns the write times of each engine for the current or last recording. Can be called from any thread */
+	Array<RecordEngineStatistics> getEngineStatistics() const;
+
 private:
+	/** Data read from the queues in one pass of the thread loop. Shared read-only by all engines */
+	struct WriteBlock
+	{
+		const AudioSampleBuffer* buffer;
+		Array<int64> timestamps;
+		Array<CircularBufferIndexes> indexes;
+		Array<QueuedEvent> events;
+		std::vector<SpikeMessagePtr> spikes;
+		int nEvents;
+		int nSpikes;
+		bool lastBlock;
+
+		//Regular (non-system) events and spikes, laid out as arrays for RecordEngine::writeEvents and writeSpikes
+		Array<QueuedEvent> processorEvents;
+		Array<int> spikeElectrodes;
+		Array<const SpikeEvent*> spikeData;
+	};
+
+	/** Writes a WriteBlock to a single engine in its own thread, so engines work in parallel */
+	class EngineWriter : public Thread
+	{
+	public:
+		EngineWriter(RecordThread& parent, int engineIndex);
+		~EngineWriter();
+		void startBlock(const WriteBlock* block);
+		void waitForBlock();
+		void run() override;
+	private:
+		RecordThread& m_parent;
+		const int m_engineIndex;
+		const WriteBlock* m_block;
+		WaitableEvent m_blockReady;
+		WaitableEvent m_blockDone;
+	};
+
 	void writeData(const AudioSampleBuffer& buffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock = false);
+	void writeEngineBlock(int engine, const WriteBlock& block);
+	static bool isSystemEvent(const QueuedEvent& event);
+	void updateEngineStatistics(int engine, double writeTime, double cpuTime);
+	void startEngineWriters();
+	void stopEngineWriters();
 
 	const OwnedArray<RecordEngine>& m_engineArray;
 	Array<int> m_channelArray;
@@ -67,6 +122,11 @@ private:
 	int m_experimentNumber;
 	int m_recordingNumber;
 	int m_numChannels;
+
+	Array<RecordEngineStatistics> m_engineStatistics;
+	OwnedArray<EngineWriter> m_engineWriters;
+	WriteBlock m_writeBlock; //kept between calls to reuse its storage
+	CriticalSection m_statisticsLock;
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordThread);
 };
 
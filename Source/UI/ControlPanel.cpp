@@ -371,7 +371,7 @@ void ControlPanelButton::setState(bool b)
 
 
 ControlPanel::ControlPanel(ProcessorGraph* graph_, AudioComponent* audio_)
-    : graph(graph_), audio(audio_), initialize(true), open(false), lastEngineIndex(-1)
+    : graph(graph_), audio(audio_), initialize(true), lastDroppedRecordData(0), open(false), lastEngineIndex(-1)
 {
 
     if (1)
@@ -1018,6 +1018,35 @@ void ControlPanel::refreshMeters()
     diskMeter->updateDiskSpace(graph->getRecordNode()->getFreeSpace());
     diskMeter->repaint();
 
+    if (recordButton->getToggleState())
+    {
+        RecordingStatistics stats = graph->getRecordNode()->getRecordingStatistics();
+
+        String tooltip = "Record buffer usage: data " + String(stats.maxDataQueueUsage * 100, 1)
+                         + "%, events " + String(stats.maxEventQueueUsage * 100, 1)
+                         + "%, spikes " + String(stats.maxSpikeQueueUsage * 100, 1) + "%";
+        for (int i = 0; i < stats.engines.size(); i++)
+        {
+            tooltip += "\n" + stats.engines[i].engineID + " write time: "
+                       + String(stats.engines[i].getMeanWriteTime(), 2) + " ms mean, "
+                       + String(stats.engines[i].maxWriteTime, 2) + " ms max";
+        }
+        diskMeter->setTooltip(tooltip);
+
+        int64 dropped = stats.droppedSamples + stats.droppedEvents + stats.droppedSpikes;
+        if (dropped > lastDroppedRecordData)
+        {
+            CoreServices::sendStatusMessage("Recording overrun: " + String(stats.droppedSamples) + " samples, "
+                                            + String(stats.droppedEvents) + " events and "
+                                            + String(stats.droppedSpikes) + " spikes dropped");
+        }
+        lastDroppedRecordData = dropped;
+    }
+    else
+    {
+        lastDroppedRecordData = 0;
+    }
+
     if (initialize)
     {
         stopTimer();
@@ -400,6 +400,9 @@ private:
 
     bool initialize;
 
+    /** Total samples, events and spikes dropped by the RecordNode when last checked */
+    int64 lastDroppedRecordData;
+
     void timerCallback();
 
     /** Updates the values displayed by the CPUMeter and DiskSpaceMeter.*/
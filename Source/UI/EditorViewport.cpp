@@ -1429,11 +1429,18 @@ const String EditorViewport::loadState(File fileToLoad)
 
         responseString += ".\n This file may not load properly. Continue?";
 
-        bool response = AlertWindow::showOkCancelBox(AlertWindow::NoIcon,
-                                                     "Version mismatch", responseString,
-                                                     "Yes", "No", 0, 0);
-        if (!response)
-            return "Failed To Open " + fileToLoad.getFileName();
+        if (AccessClass::getUIComponent()->isHeadless())
+        {
+            std::cout << responseString << std::endl;
+        }
+        else
+        {
+            bool response = AlertWindow::showOkCancelBox(AlertWindow::NoIcon,
+                                                         "Version mismatch", responseString,
+                                                         "Yes", "No", 0, 0);
+            if (!response)
+                return "Failed To Open " + fileToLoad.getFileName();
+        }
 
     }
 	if (!pluginAPI)
@@ -1441,7 +1448,10 @@ const String EditorViewport::loadState(File fileToLoad)
 		String responseString = "Your configuration file was saved from a non-plugin version of the GUI.\n";
 		responseString += "Save files from non-plugin versions are incompatible with the current load system.\n";
 		responseString += "The chain file will not load.";
-		AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Non-plugin save file", responseString);
+		if (AccessClass::getUIComponent()->isHeadless())
+			std::cout << responseString << std::endl;
+		else
+			AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Non-plugin save file", responseString);
 		return "Failed To Open " + fileToLoad.getFileName();
 	}
     clearSignalChain();
@@ -22,6 +22,7 @@
  */
 
 #include "GraphViewer.h"
+#include "../Processors/ProcessorGraph/ProcessorGraph.h"
 
 GraphViewer::GraphViewer()
 {
@@ -29,6 +30,8 @@ GraphViewer::GraphViewer()
     currentVersionText = "GUI version " + app->getApplicationVersion();
     
     rootNum = 0;
+
+    startTimer (1000);
 }
 
 
@@ -37,6 +40,13 @@ GraphViewer::~GraphViewer()
 }
 
 
+void GraphViewer::timerCallback()
+{
+    if (isShowing() && CoreServices::getAcquisitionStatus())
+        repaint();
+}
+
+
 void GraphViewer::addNode (GenericEditor* editor)
 {
     GraphNode* gn = new GraphNode (editor, this);
@@ -252,6 +262,18 @@ void GraphViewer::paint (Graphics& g)
     
     g.setFont (Font("Small Text", 14, Font::plain));
     g.drawFittedText (currentVersionText, 40, 40, getWidth()-50, getHeight()-45, Justification::bottomRight, 100);
+
+    // timing of the whole audio callback against its deadline
+    ProcessingProfile::Statistics callbackStats = AccessClass::getProcessorGraph()->getCallbackProfile().getStatistics();
+
+    if (callbackStats.numBlocks > 0)
+    {
+        g.drawFittedText ("Audio callback: mean " + String (callbackStats.meanMs, 2)
+                          + " ms, p99 " + String (callbackStats.p99Ms, 2)
+                          + " ms, min margin " + String (callbackStats.minMarginMs, 2)
+                          + " ms, " + String (callbackStats.overruns) + " overruns",
+                          20, 40, getWidth() - 40, getHeight() - 45, Justification::bottomLeft, 1);
+    }
     
     // Draw connections
     const int numAvailableNodes = availableNodes.size();
@@ -469,4 +491,19 @@ void GraphNode::paint (Graphics& g)
     g.fillEllipse (2, 2, 16, 16);
     
     g.drawText (getName(), 25, 0, getWidth() - 25, 20, Justification::left, true);
+
+    GenericProcessor* processor = editor->getProcessor();
+
+    if (processor != nullptr)
+    {
+        ProcessingProfile::Statistics stats = processor->getProcessingProfile().getStatistics();
+
+        if (stats.numBlocks > 0)
+        {
+            // mean and p99 process() time, in orange if the processor alone overran a block
+            g.setColour (stats.overruns > 0 ? Colours::orange : Colours::lightgrey);
+            g.setFont (11);
+            g.drawText (String (stats.meanMs, 2) + " / " + String (stats.p99Ms, 2) + " ms", 25, 16, getWidth() - 25, 12, Justification::left, true);
+        }
+    }
 }
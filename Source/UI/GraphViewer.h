@@ -85,6 +85,7 @@ private:
 
 
 class GraphViewer : public Component
+                  , public Timer
 {
 public:
     GraphViewer();
@@ -92,6 +93,9 @@ public:
     
     /** Draws the GraphViewer.*/
     void paint (Graphics& g)    override;
+
+    /** Refreshes the processing statistics during acquisition.*/
+    void timerCallback() override;
     
     void addNode    (GenericEditor* editor);
     void removeNode (GenericEditor* editor);
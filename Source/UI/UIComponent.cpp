@@ -126,6 +126,11 @@ ProcessorList* UIComponent::getProcessorList()
 	return processorList;
 }
 
+bool UIComponent::isHeadless() const
+{
+	return mainWindow->isHeadless();
+}
+
 /** Returns a pointer to the DataViewport. */
 DataViewport* UIComponent::getDataViewport()
 {
@@ -388,6 +393,7 @@ PopupMenu UIComponent::getMenuForIndex(int menuIndex, const String& menuName)
 		menu.addCommandItem(commandManager, clearSignalChain);
 		menu.addSeparator();
 		menu.addCommandItem(commandManager, openTimestampSelectionWindow);
+		menu.addCommandItem(commandManager, exportProcessingTrace);
 
 	}
 	else if (menuIndex == 2)
@@ -440,7 +446,8 @@ void UIComponent::getAllCommands(Array <CommandID>& commands)
 		toggleFileInfo,
 		showHelp,
 		resizeWindow,
-		openTimestampSelectionWindow
+		openTimestampSelectionWindow,
+		exportProcessingTrace
 	};
 
 	commands.addArray(ids, numElementsInArray(ids));
@@ -528,6 +535,10 @@ void UIComponent::getCommandInfo(CommandID commandID, ApplicationCommandInfo& re
 			result.setInfo("Timestamp Source", "Show timestamp source selection window.", "General", 0);
 			break;
 
+		case exportProcessingTrace:
+			result.setInfo("Export processing trace...", "Save the processing times of the last blocks as a Chrome trace.", "General", 0);
+			break;
+
 		case showHelp:
 			result.setInfo("Show help...", "Take me to the GUI wiki.", "General", 0);
 			result.setActive(true);
@@ -654,6 +665,23 @@ bool UIComponent::perform(const InvocationInfo& info)
 			mainWindow->centreWithSize(800, 600);
 			break;
 
+		case exportProcessingTrace:
+			{
+				FileChooser fc("Choose the file name...",
+						CoreServices::getDefaultUserSaveDirectory().getChildFile("processing_trace.json"),
+						"*.json",
+						true);
+
+				if (fc.browseForFileToSave(true))
+				{
+					if (getProcessorGraph()->exportProcessingTrace(fc.getResult()))
+						sendActionMessage("Processing trace saved to " + fc.getResult().getFileName());
+					else
+						sendActionMessage("Could not save the processing trace.");
+				}
+				break;
+			}
+
 		case openTimestampSelectionWindow:
 			if (timestampWindow == nullptr)
 			{
@@ -97,6 +97,10 @@ public:
 
 	PluginManager* getPluginManager();
 
+    /** Returns true if the GUI runs without a window, in which case nothing
+        should wait for user input. */
+    bool isHeadless() const;
+
     /** Stops the callbacks to the ProcessorGraph which drive data acquisition. */
     void disableCallbacks();
 
@@ -189,7 +193,8 @@ private:
         resizeWindow            = 0x2012,
         reloadOnStartup         = 0x2013,
         saveConfigurationAs     = 0x2014,
-		openTimestampSelectionWindow = 0x2015
+		openTimestampSelectionWindow = 0x2015,
+		exportProcessingTrace   = 0x2016
     };
 
     File currentConfigFile;